@@ -51,6 +51,145 @@ internal static class VxDb {
         }
     }
 
+    internal static int ExecNoResult(string connid, string query)
+    {
+	query = query_parser(query,
+			    VxSqlPool.access_restrictions(connid));
+
+        log.print(WvLog.L.Debug3, "ExecNoResult {0}\n", query);
+
+	try
+	{
+	    using (var dbi = VxSqlPool.create(connid))
+		return dbi.execute(query);
+	}
+	catch (DbException e)
+	{
+            throw new VxSqlException(e.Message, e);
+	}
+    }
+
+    static Type VxColumnTypeToType(VxColumnType t)
+    {
+	switch (t)
+	{
+	case VxColumnType.Int64:
+	    return typeof(Int64);
+	case VxColumnType.Int32:
+	    return typeof(Int32);
+	case VxColumnType.Int16:
+	    return typeof(Int16);
+	case VxColumnType.UInt8:
+	    return typeof(Byte);
+	case VxColumnType.Bool:
+	    return typeof(bool);
+	case VxColumnType.Double:
+	    return typeof(double);
+	case VxColumnType.Binary:
+	    return typeof(byte[]);
+	case VxColumnType.DateTime:
+	    return typeof(DateTime);
+	case VxColumnType.Decimal:
+	    return typeof(decimal);
+	default:
+	    return typeof(string);
+	}
+    }
+
+    // Rows arrive the way ExecRecordset sends them: a list of structs,
+    // one value per column, with a matching list of nullity flags.  The
+    // exception is binary values, which come as base64 strings.
+    internal static int BulkInsert(string connid, string table,
+				   VxColumnInfo[] colinfo,
+				   IEnumerable<WvAutoCast> data,
+				   IEnumerable<WvAutoCast> nullity)
+    {
+        log.print(WvLog.L.Debug3, "BulkInsert into {0}\n", table);
+
+	// A row that doesn't convert is as much the caller's problem as
+	// one the server refuses, so both come back as vx.db.sqlerror.
+	try
+	{
+	    var dt = new DataTable(table);
+	    foreach (var ci in colinfo)
+		dt.Columns.Add(ci.ColumnName,
+			       VxColumnTypeToType(ci.VxColumnType));
+
+	    var nulls = nullity.GetEnumerator();
+	    foreach (IEnumerable<WvAutoCast> r in data)
+	    {
+		var vals = r.ToArray();
+		byte[] rownull = nulls.MoveNext()
+		    ? ((IEnumerable<WvAutoCast>)nulls.Current)
+			    .Select(b => (byte)b).ToArray()
+		    : new byte[0];
+		var row = dt.NewRow();
+		for (int i = 0; i < colinfo.Length && i < vals.Length; i++)
+		{
+		    if (i < rownull.Length && rownull[i] != 0)
+		    {
+			row[i] = DBNull.Value;
+			continue;
+		    }
+
+		    switch (colinfo[i].VxColumnType)
+		    {
+		    case VxColumnType.Int64:
+			row[i] = (Int64)vals[i];
+			break;
+		    case VxColumnType.Int32:
+			row[i] = (Int32)vals[i];
+			break;
+		    case VxColumnType.Int16:
+			row[i] = (Int16)vals[i];
+			break;
+		    case VxColumnType.UInt8:
+			row[i] = (Byte)vals[i];
+			break;
+		    case VxColumnType.Bool:
+			row[i] = (bool)vals[i];
+			break;
+		    case VxColumnType.Double:
+			row[i] = (double)vals[i];
+			break;
+		    case VxColumnType.Binary:
+			row[i] = Convert.FromBase64String((string)vals[i]);
+			break;
+		    case VxColumnType.DateTime:
+		    {
+			// (xi): seconds since the epoch, plus microseconds
+			var dtv = ((IEnumerable<WvAutoCast>)vals[i]).ToArray();
+			long secs = dtv[0];
+			int usecs = dtv[1];
+			row[i] = new DateTime(1970, 1, 1)
+			    .AddTicks(secs * 10000000L + usecs * 10L);
+			break;
+		    }
+		    case VxColumnType.Decimal:
+			row[i] = Decimal.Parse((string)vals[i],
+			   System.Globalization.CultureInfo.InvariantCulture);
+			break;
+		    default:
+			row[i] = (string)vals[i];
+			break;
+		    }
+		}
+		dt.Rows.Add(row);
+	    }
+
+	    using (var dbi = VxSqlPool.create(connid))
+		return dbi.bulk_insert(table, dt);
+	}
+	catch (VxRequestException)
+	{
+	    throw;
+	}
+	catch (Exception e)
+	{
+            throw new VxSqlException(e.Message, e);
+	}
+    }
+
 
     internal static void SendChunkRecordSignal(WvDbus conn,
 					       WvDbusMsg call, string sender,
@@ -672,12 +811,16 @@ public class VxDbusRouter
 	    p = CallTest;
 	else if (msg.method == "Quit")
 	    p = CallQuit;
+	else if (msg.method == "ExecNoResult")
+	    p = CallExecNoResult;
 	else if (msg.method == "ExecScalar")
 	    p = CallExecScalar;
 	else if (msg.method == "ExecRecordset")
 	    p = CallExecRecordset;
 	else if (msg.method == "ExecChunkRecordset")
 	    p = CallExecChunkRecordset;
+	else if (msg.method == "BulkInsert")
+	    p = CallBulkInsert;
 	else if (msg.method == "GetSchemaChecksums")
 	    p = CallGetSchemaChecksums;
 	else if (msg.method == "GetSchema")
@@ -818,6 +961,32 @@ public class VxDbusRouter
 	Versaplexd.want_to_die = true;
     }
 
+    static void CallExecNoResult(WvDbus conn,
+				 WvDbusMsg call, out WvDbusMsg reply)
+    {
+        if (call.signature != "s") {
+            reply = CreateUnknownMethodReply(call, "ExecNoResult");
+            return;
+        }
+
+        string clientid = GetClientId(call);
+        if (clientid == null)
+        {
+            reply = call.err_reply("org.freedesktop.DBus.Error.Failed",
+				   "Could not identify the client");
+            return;
+        }
+
+	var it = call.iter();
+        string query = it.pop();
+
+	int rows = VxDb.ExecNoResult(clientid, query);
+
+        WvDbusWriter writer = new WvDbusWriter();
+	writer.Write(rows);
+        reply = call.reply("i").write(writer);
+    }
+
     static void CallExecScalar(WvDbus conn,
 				       WvDbusMsg call, out WvDbusMsg reply)
     {
@@ -855,6 +1024,49 @@ public class VxDbusRouter
 
         reply = call.reply("v").write(writer);
     }
+
+    static void CallBulkInsert(WvDbus conn,
+			       WvDbusMsg call, out WvDbusMsg reply)
+    {
+        if (call.signature != "sa(issnny)vaay") {
+            reply = CreateUnknownMethodReply(call, "BulkInsert");
+            return;
+        }
+
+        string clientid = GetClientId(call);
+        if (clientid == null)
+        {
+            reply = call.err_reply("org.freedesktop.DBus.Error.Failed",
+				   "Could not identify the client");
+            return;
+        }
+
+	var it = call.iter();
+        string table = it.pop();
+
+	var colinfo = new List<VxColumnInfo>();
+	foreach (IEnumerable<WvAutoCast> c in it.pop())
+	{
+	    int size;
+	    string name, type;
+	    short precision, scale;
+	    byte nullable;
+	    c.ToArray().assignto(out size, out name, out type,
+				 out precision, out scale, out nullable);
+	    colinfo.Add(new VxColumnInfo(name,
+		(VxColumnType)Enum.Parse(typeof(VxColumnType), type, true),
+		nullable != 0, size, precision, scale));
+	}
+	IEnumerable<WvAutoCast> data = it.pop();
+	IEnumerable<WvAutoCast> nullity = it.pop();
+
+	int rows = VxDb.BulkInsert(clientid, table, colinfo.ToArray(),
+				   data, nullity);
+
+        WvDbusWriter writer = new WvDbusWriter();
+	writer.Write(rows);
+        reply = call.reply("i").write(writer);
+    }
     
     static void WriteColInfo(WvDbusWriter writer, VxColumnInfo[] colinfo)
     {
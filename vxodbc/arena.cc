@@ -0,0 +1,107 @@
+/*
+ * Description:	This module contains routines for allocating a result's
+ *		memory in large blocks and freeing it all in one go (see
+ *		"arena.h").
+ */
+
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*	Keep everything handed out aligned well enough for any type */
+#define	AR_ALIGN(size)	(((size) + sizeof(double) - 1) & ~(sizeof(double) - 1))
+/*	Blocks grow by doubling, but no further than this */
+#define	AR_MAX_BLOCK	(1024 * 1024)
+
+ArenaClass *AR_Constructor(size_t block_size)
+{
+    ArenaClass *rv;
+
+    rv = (ArenaClass *) malloc(sizeof(ArenaClass));
+    if (!rv)
+	return NULL;
+    rv->blocks = NULL;
+    rv->block_size = block_size > 0 ? block_size : 4096;
+    rv->total_used = 0;
+
+    return rv;
+}
+
+
+void AR_Destructor(ArenaClass * self)
+{
+    struct ArenaBlock_ *block, *next;
+
+    if (!self)
+	return;
+    for (block = self->blocks; block; block = next)
+    {
+	next = block->next;
+	free(block);
+    }
+    free(self);
+}
+
+
+/*
+ *	Make sure the next size bytes can come out of the current block,
+ *	starting a new one if they can't.  Used to get a block big enough
+ *	for everything that's about to be added.
+ */
+BOOL AR_reserve(ArenaClass * self, size_t size)
+{
+    struct ArenaBlock_ *block = self->blocks;
+    size_t alloc;
+
+    size = AR_ALIGN(size);
+    if (block && block->size - block->used >= size)
+	return TRUE;
+
+    alloc = self->block_size;
+    while (alloc < size)
+	alloc *= 2;
+    block = (struct ArenaBlock_ *)
+	malloc(AR_ALIGN(sizeof(struct ArenaBlock_)) + alloc);
+    if (!block)
+	return FALSE;
+    block->next = self->blocks;
+    block->size = alloc;
+    block->used = 0;
+    self->blocks = block;
+    if (self->block_size < AR_MAX_BLOCK)
+	self->block_size *= 2;
+
+    return TRUE;
+}
+
+
+void *AR_alloc(ArenaClass * self, size_t size)
+{
+    struct ArenaBlock_ *block;
+    void *rv;
+
+    size = AR_ALIGN(size);
+    if (!AR_reserve(self, size))
+	return NULL;
+    block = self->blocks;
+    rv = (char *) block + AR_ALIGN(sizeof(struct ArenaBlock_)) + block->used;
+    block->used += size;
+    self->total_used += size;
+
+    return rv;
+}
+
+
+/*	Copy len bytes of str, plus a NUL, into the arena */
+char *AR_strndup(ArenaClass * self, const char *str, size_t len)
+{
+    char *rv = (char *) AR_alloc(self, len + 1);
+
+    if (!rv)
+	return NULL;
+    memcpy(rv, str, len);
+    rv[len] = '\0';
+
+    return rv;
+}
@@ -0,0 +1,42 @@
+/* File:			arena.h
+ *
+ * Description:		See "arena.cc"
+ *
+ * Comments:		See "notice.txt" for copyright and license information.
+ *
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include "psqlodbc.h"
+
+#include <stddef.h>
+
+/*
+ *	A bump allocator: memory is handed out from big blocks and can only
+ *	be freed all at once, which is what a result's cell values want.
+ */
+struct ArenaBlock_
+{
+	struct ArenaBlock_ *next;	/* the previously filled block */
+	size_t		size;		/* usable bytes after the header */
+	size_t		used;
+};
+
+struct ArenaClass_
+{
+	struct ArenaBlock_ *blocks;	/* the current block, then older ones */
+	size_t		block_size;	/* the size of the next block */
+	size_t		total_used;
+};
+
+#define AR_get_total_used(self)	(self->total_used)
+
+ArenaClass	*AR_Constructor(size_t block_size);
+void		AR_Destructor(ArenaClass *self);
+void		*AR_alloc(ArenaClass *self, size_t size);
+char		*AR_strndup(ArenaClass *self, const char *str, size_t len);
+BOOL		AR_reserve(ArenaClass *self, size_t size);
+
+#endif
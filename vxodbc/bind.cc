@@ -31,9 +31,91 @@ PGAPI_BindParameter(HSTMT hstmt,
 {
     StatementClass *stmt = (StatementClass *) hstmt;
     CSTR func = "PGAPI_BindParameter";
-    mylog("PGAPI_BindParameter not yet implemented");
-    SC_log_error(func, "PGAPI_BindParameter not yet implemented", stmt);
-    return SQL_ERROR;
+    APDFields *apdopts;
+    IPDFields *ipdopts;
+
+    mylog("%s: entering...\n", func);
+
+    if (!stmt)
+    {
+	SC_log_error(func, "", NULL);
+	return SQL_INVALID_HANDLE;
+    }
+    SC_clear_error(stmt);
+
+    if (ipar < 1)
+    {
+	SC_set_error(stmt, STMT_BAD_PARAMETER_NUMBER_ERROR,
+		     "Invalid parameter number.", func);
+	return SQL_ERROR;
+    }
+    if (SQL_PARAM_INPUT != fParamType)
+    {
+	SC_set_error(stmt, STMT_NOT_IMPLEMENTED_ERROR,
+		     "Only input parameters are supported.", func);
+	return SQL_ERROR;
+    }
+
+    apdopts = SC_get_APDF(stmt);
+    if (apdopts->allocated < ipar)
+	extend_parameter_bindings(apdopts, ipar);
+    ipdopts = SC_get_IPDF(stmt);
+    if (ipdopts->allocated < ipar)
+	extend_iparameter_bindings(ipdopts, ipar);
+    if (apdopts->allocated < ipar || ipdopts->allocated < ipar)
+    {
+	SC_set_error(stmt, STMT_NO_MEMORY_ERROR,
+		     "Could not allocate memory for bindings.", func);
+	return SQL_ERROR;
+    }
+
+    /* use zero based column numbers for the below part */
+    ipar--;
+
+    /* store the given info */
+    apdopts->parameters[ipar].buflen = cbValueMax;
+    apdopts->parameters[ipar].buffer = (char *) rgbValue;
+    apdopts->parameters[ipar].used =
+	apdopts->parameters[ipar].indicator = pcbValue;
+    apdopts->parameters[ipar].CType = fCType;
+    apdopts->parameters[ipar].precision = 0;
+    apdopts->parameters[ipar].scale = 0;
+    switch (fCType)
+    {
+    case SQL_C_NUMERIC:
+	if (cbColDef > 0)
+	    apdopts->parameters[ipar].precision = (SQLSMALLINT) cbColDef;
+	if (ibScale > 0)
+	    apdopts->parameters[ipar].scale = ibScale;
+	break;
+    case SQL_C_TYPE_TIMESTAMP:
+	if (ibScale > 0)
+	    apdopts->parameters[ipar].precision = ibScale;
+	break;
+    }
+    /* Data at exec macro only valid for C char/binary data */
+    apdopts->parameters[ipar].data_at_exec = (pcbValue &&
+	(SQL_DATA_AT_EXEC == *pcbValue ||
+	 *pcbValue <= SQL_LEN_DATA_AT_EXEC_OFFSET));
+
+    ipdopts->parameters[ipar].paramType = fParamType;
+    ipdopts->parameters[ipar].SQLType = fSqlType;
+    ipdopts->parameters[ipar].PGType = sqltype_to_pgtype(stmt, fSqlType);
+    ipdopts->parameters[ipar].column_size = cbColDef;
+    ipdopts->parameters[ipar].decimal_digits = ibScale;
+    ipdopts->parameters[ipar].precision = 0;
+    ipdopts->parameters[ipar].scale = 0;
+
+    /* Clear premature result */
+    if (stmt->status == STMT_PREMATURE)
+	SC_recycle_statement(stmt);
+
+    mylog("%s: ipar=%d, paramType=%d, fCType=%d, fSqlType=%d, "
+	  "cbColDef=%d, ibScale=%d, rgbValue=%p, pcbValue=%p\n",
+	  func, ipar, fParamType, fCType, fSqlType, (int) cbColDef,
+	  ibScale, rgbValue, pcbValue);
+
+    return SQL_SUCCESS;
 }
 
 
@@ -147,6 +229,7 @@ PGAPI_BindCol(HSTMT hstmt,
 	opts->bindings[icol].returntype = SQL_C_CHAR;
 	opts->bindings[icol].precision = 0;
 	opts->bindings[icol].scale = 0;
+	opts->bindings[icol].copy_ready = FALSE;
 	if (gdata_info->gdata[icol].ttlbuf)
 	    free(gdata_info->gdata[icol].ttlbuf);
 	gdata_info->gdata[icol].ttlbuf = NULL;
@@ -166,6 +249,7 @@ PGAPI_BindCol(HSTMT hstmt,
 	else
 	    opts->bindings[icol].precision = 0;
 	opts->bindings[icol].scale = 0;
+	opts->bindings[icol].copy_ready = FALSE;
 
 	mylog("bound buffer[%d] = %p\n", icol,
 	      opts->bindings[icol].buffer);
@@ -216,10 +300,36 @@ RETCODE SQL_API PGAPI_NumParams(HSTMT hstmt, SQLSMALLINT FAR * pcpar)
 {
     StatementClass *stmt = (StatementClass *) hstmt;
     CSTR func = "PGAPI_NumParams";
-    
-    SC_set_error(stmt, STMT_EXEC_ERROR,
-		 "PGAPI_NumParams is not yet supported", func);
-    return SQL_ERROR;
+
+    mylog("%s: entering...\n", func);
+
+    if (!stmt)
+    {
+	SC_log_error(func, "", NULL);
+	return SQL_INVALID_HANDLE;
+    }
+    if (pcpar)
+	*pcpar = 0;
+    else
+    {
+	SC_set_error(stmt, STMT_EXEC_ERROR, "parameter count address is null",
+		     func);
+	return SQL_ERROR;
+    }
+
+    if (!stmt->statement)
+    {
+	/* no statement has been allocated */
+	SC_set_error(stmt, STMT_SEQUENCE_ERROR,
+		     "PGAPI_NumParams called with no statement ready.", func);
+	return SQL_ERROR;
+    }
+    if (stmt->num_params < 0)
+	SC_scanQueryAndCountParams(stmt->statement, SC_get_conn(stmt), NULL,
+				   &stmt->num_params, NULL, NULL);
+    *pcpar = stmt->num_params;
+
+    return SQL_SUCCESS;
 }
 
 
@@ -241,6 +351,7 @@ static BindInfoClass *create_empty_bindings(int num_columns)
 	new_bindings[i].buflen = 0;
 	new_bindings[i].buffer = NULL;
 	new_bindings[i].used = new_bindings[i].indicator = NULL;
+	new_bindings[i].copy_ready = FALSE;
     }
 
     return new_bindings;
@@ -332,6 +443,62 @@ void IPD_free_params(IPDFields * ipdopts, char option)
     mylog("%s:  EXIT\n", func);
 }
 
+void extend_parameter_bindings(APDFields * self, int num_params)
+{
+    CSTR func = "extend_parameter_bindings";
+    ParameterInfoClass *new_bindings;
+
+    mylog("%s: entering ... self=%p, parameters_allocated=%d, "
+	  "num_params=%d\n", func, self, self->allocated, num_params);
+
+    if (self->allocated < num_params)
+    {
+	new_bindings = (ParameterInfoClass *)
+	    realloc(self->parameters, sizeof(ParameterInfoClass) * num_params);
+	if (!new_bindings)
+	{
+	    mylog("%s: unable to create %d new bindings from %d old "
+		  "bindings\n", func, num_params, self->allocated);
+	    return;
+	}
+	memset(&new_bindings[self->allocated], 0,
+	       sizeof(ParameterInfoClass) * (num_params - self->allocated));
+
+	self->parameters = new_bindings;
+	self->allocated = num_params;
+    }
+
+    mylog("exit %s=%p\n", func, self->parameters);
+}
+
+void extend_iparameter_bindings(IPDFields * self, int num_params)
+{
+    CSTR func = "extend_iparameter_bindings";
+    ParameterImplClass *new_bindings;
+
+    mylog("%s: entering ... self=%p, parameters_allocated=%d, "
+	  "num_params=%d\n", func, self, self->allocated, num_params);
+
+    if (self->allocated < num_params)
+    {
+	new_bindings = (ParameterImplClass *)
+	    realloc(self->parameters, sizeof(ParameterImplClass) * num_params);
+	if (!new_bindings)
+	{
+	    mylog("%s: unable to create %d new bindings from %d old "
+		  "bindings\n", func, num_params, self->allocated);
+	    return;
+	}
+	memset(&new_bindings[self->allocated], 0,
+	       sizeof(ParameterImplClass) * (num_params - self->allocated));
+
+	self->parameters = new_bindings;
+	self->allocated = num_params;
+    }
+
+    mylog("exit %s=%p\n", func, self->parameters);
+}
+
 void extend_column_bindings(ARDFields * self, int num_columns)
 {
     CSTR func = "extend_column_bindings";
@@ -417,6 +584,7 @@ void reset_a_column_binding(ARDFields * self, int icol)
 	self->bindings[icol].used =
 	    self->bindings[icol].indicator = NULL;
 	self->bindings[icol].returntype = SQL_C_CHAR;
+	self->bindings[icol].copy_ready = FALSE;
     }
 }
 
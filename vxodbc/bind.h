@@ -12,6 +12,16 @@
 #include "psqlodbc.h"
 #include "descriptor.h"
 
+struct RowsetColumn;
+
+/*
+ *	Copies n rows' worth of a column, starting at row 'first' of the
+ *	cache, into the application's buffers.  Returns TRUE if anything
+ *	had to be truncated.  See rowset.cc.
+ */
+typedef BOOL (*RowsetCopyFunc) (const struct RowsetColumn *rc,
+				SQLULEN first, SQLULEN n);
+
 /*
  * BindInfoClass -- stores information about a bound column
  */
@@ -29,6 +39,11 @@ struct BindInfoClass_
 	SQLSMALLINT	scale;		/* the scale for numeric type */
 	/* area for work variables */
 	char	dummy_data;		/* currently not used */		
+	/* the conversion worked out on the first fetch into this binding */
+	RowsetCopyFunc	copy;		/* NULL: use copy_and_convert_field */
+	OID	copy_type;		/* the field type it was chosen for */
+	SQLSMALLINT	copy_ctype;	/* ...and the returntype */
+	char	copy_ready;		/* copy is worked out */
 };
 typedef struct
 {
@@ -84,6 +99,8 @@ typedef struct
 }	GetDataInfo;
 
 void	extend_column_bindings(ARDFields *opts, int num_columns);
+void	extend_parameter_bindings(APDFields *opts, int num_params);
+void	extend_iparameter_bindings(IPDFields *opts, int num_params);
 void	reset_a_column_binding(ARDFields *opts, int icol);
 int	CountParameters(const StatementClass *stmt, Int2 *inCount, Int2 *ioCount, Int2 *outputCount);
 void	GetDataInfoInitialize(GetDataInfo *gdata);
@@ -0,0 +1,770 @@
+/*
+ * Description:	This module contains SQLBulkOperations(SQL_ADD), which sends
+ *		the rows in the application's bound column arrays to
+ *		versaplexd's BulkInsert in large, typed batches.
+ */
+
+#include "vxhelpers.h"
+#include "bind.h"
+#include "convert.h"
+#include "descriptor.h"
+#include "pgapifunc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+/*	Rows go to versaplexd in messages of roughly this many bytes */
+#define VX_BULK_BATCH_SIZE	(4 * 1024 * 1024)
+
+/*	January 1, 1900: versaplexd's SQL time values are times on this day */
+#define VX_SQL_EPOCH		(-2208988800LL)
+
+/*	How a column's values are sent; see protocol.txt's column types */
+enum BulkKind
+{
+    BK_INT64, BK_INT32, BK_INT16, BK_UINT8, BK_BOOL, BK_DOUBLE,
+    BK_STRING, BK_BINARY, BK_DATETIME
+};
+
+struct BulkColumn
+{
+    int col;			/* in the result, and so in the ARD */
+    BulkKind kind;
+    const char *vxtype;
+    const char *sig;
+};
+
+
+static BulkKind bulk_kind(OID type, const char **vxtype, const char **sig)
+{
+    switch (type)
+    {
+    case PG_TYPE_INT8:
+	*vxtype = "Int64"; *sig = "x";
+	return BK_INT64;
+    case PG_TYPE_INT4:
+	*vxtype = "Int32"; *sig = "i";
+	return BK_INT32;
+    case PG_TYPE_INT2:
+	*vxtype = "Int16"; *sig = "n";
+	return BK_INT16;
+    case PG_TYPE_CHAR:
+	*vxtype = "UInt8"; *sig = "y";
+	return BK_UINT8;
+    case PG_TYPE_BOOL:
+	*vxtype = "Bool"; *sig = "b";
+	return BK_BOOL;
+    case PG_TYPE_FLOAT8:
+	*vxtype = "Double"; *sig = "d";
+	return BK_DOUBLE;
+    case PG_TYPE_BYTEA:
+	*vxtype = "Binary"; *sig = "s";
+	return BK_BINARY;
+    case VX_TYPE_DATETIME:
+	*vxtype = "DateTime"; *sig = "(xi)";
+	return BK_DATETIME;
+    case PG_TYPE_NUMERIC:
+	*vxtype = "Decimal"; *sig = "s";
+	return BK_STRING;
+    default:
+	*vxtype = "String"; *sig = "s";
+	return BK_STRING;
+    }
+}
+
+
+static bool is_word(const char *p, const char *word, const char *start)
+{
+    size_t len = strlen(word);
+
+    return (p == start || !(isalnum((UCHAR) p[-1]) || '_' == p[-1]))
+	&& 0 == strnicmp(p, word, len)
+	&& !(isalnum((UCHAR) p[len]) || '_' == p[len]);
+}
+
+
+/*
+ *	The table a single-table SELECT reads from, which is where SQL_ADD
+ *	puts its rows.  Joins, subqueries and lists of tables don't have
+ *	one.
+ */
+static bool bulk_target_table(const char *statement, std::string &table)
+{
+    const char *p, *end, *name;
+
+    for (p = statement; *p && !is_word(p, "from", statement);)
+    {
+	if (end = skip_sql_quoted(p), end != p)
+	    p = end;
+	else
+	    p++;
+    }
+    if (!*p)
+	return false;
+    for (p += 4; isspace((UCHAR) * p); p++)
+	;
+    for (name = p; *p;)
+    {
+	if ('[' == *p || '"' == *p)
+	    p = skip_sql_quoted(p);
+	else if (isalnum((UCHAR) * p) || '_' == *p || '.' == *p
+		 || '#' == *p)
+	    p++;
+	else
+	    break;
+    }
+    if (p == name)
+	return false;
+    table.assign(name, p - name);
+
+    while (*p && !is_word(p, "where", statement)
+	   && !is_word(p, "group", statement)
+	   && !is_word(p, "order", statement))
+    {
+	if (',' == *p || is_word(p, "join", statement))
+	    return false;
+	if (end = skip_sql_quoted(p), end != p)
+	    p = end;
+	else
+	    p++;
+    }
+    return true;
+}
+
+
+/*
+ *	Days since 1970-01-01 of a date in the proleptic Gregorian calendar,
+ *	without going through time_t.
+ */
+static SQLBIGINT days_from_civil(int y, int m, int d)
+{
+    y -= (m <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned) (y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return (SQLBIGINT) era * 146097 + (SQLBIGINT) doe - 719468;
+}
+
+
+/*
+ *	Where row 'row' of a bound column is, for row-wise or column-wise
+ *	binding.  Returns false if the value is NULL (or to be ignored).
+ */
+static bool bulk_value(const ARDFields * opts, const BindInfoClass * b,
+		       SQLSMALLINT ctype, SQLULEN row,
+		       const char **buffer, SQLLEN * len)
+{
+    SQLULEN offset = opts->row_offset_ptr ? *opts->row_offset_ptr : 0;
+    const SQLLEN *used;
+
+    if (opts->bind_size > 0)
+    {
+	offset += row * opts->bind_size;
+	*buffer = b->buffer ? b->buffer + offset : NULL;
+	used = LENADDR_SHIFT(b->used, offset);
+    }
+    else
+    {
+	SQLLEN width = ctype_length(ctype);
+
+	if (width <= 0)
+	    width = b->buflen;
+	*buffer = b->buffer ? b->buffer + offset + row * width : NULL;
+	used = b->used ? LENADDR_SHIFT(b->used, offset) + row : NULL;
+    }
+    if (!*buffer || (used && (SQL_NULL_DATA == *used
+			      || SQL_COLUMN_IGNORE == *used)))
+	return false;
+
+    if (used && SQL_NTS != *used)
+	*len = *used;
+    else if (SQL_C_CHAR == ctype)
+	*len = strlen(*buffer);
+#ifdef	UNICODE_SUPPORT
+    else if (SQL_C_WCHAR == ctype)
+    {
+	const SQLWCHAR *w = (const SQLWCHAR *) *buffer;
+	SQLLEN n;
+
+	for (n = 0; w[n]; n++)
+	    ;
+	*len = n * WCLEN;
+    }
+#endif				/* UNICODE_SUPPORT */
+    else
+	*len = b->buflen;
+    return true;
+}
+
+
+static bool bulk_get_int(SQLSMALLINT ctype, const char *buf, SQLLEN len,
+			 SQLBIGINT * out)
+{
+    char tmp[64];
+
+    switch (ctype)
+    {
+    case SQL_C_BIT:
+    case SQL_C_UTINYINT:
+	*out = *(const UCHAR *) buf;
+	break;
+    case SQL_C_STINYINT:
+    case SQL_C_TINYINT:
+	*out = *(const SCHAR *) buf;
+	break;
+    case SQL_C_SSHORT:
+    case SQL_C_SHORT:
+	*out = *(const SWORD *) buf;
+	break;
+    case SQL_C_USHORT:
+	*out = *(const UWORD *) buf;
+	break;
+    case SQL_C_SLONG:
+    case SQL_C_LONG:
+	*out = *(const SDWORD *) buf;
+	break;
+    case SQL_C_ULONG:
+	*out = *(const UDWORD *) buf;
+	break;
+    case SQL_C_SBIGINT:
+    case SQL_C_UBIGINT:
+	*out = *(const SQLBIGINT *) buf;
+	break;
+    case SQL_C_FLOAT:
+	*out = (SQLBIGINT) * (const SFLOAT *) buf;
+	break;
+    case SQL_C_DOUBLE:
+	*out = (SQLBIGINT) * (const SDOUBLE *) buf;
+	break;
+    case SQL_C_CHAR:
+	if (len >= (SQLLEN) sizeof(tmp))
+	    return false;
+	memcpy(tmp, buf, len);
+	tmp[len] = '\0';
+	*out = strtoll(tmp, NULL, 10);
+	break;
+    default:
+	return false;
+    }
+    return true;
+}
+
+
+static bool bulk_get_double(SQLSMALLINT ctype, const char *buf, SQLLEN len,
+			    double *out)
+{
+    SQLBIGINT ival;
+    char tmp[64];
+
+    switch (ctype)
+    {
+    case SQL_C_FLOAT:
+	*out = *(const SFLOAT *) buf;
+	return true;
+    case SQL_C_DOUBLE:
+	*out = *(const SDOUBLE *) buf;
+	return true;
+    case SQL_C_CHAR:
+	if (len >= (SQLLEN) sizeof(tmp))
+	    return false;
+	memcpy(tmp, buf, len);
+	tmp[len] = '\0';
+	*out = vx_strtod(tmp, NULL);
+	return true;
+    case SQL_C_NUMERIC:
+	if (!ResolveNumericParam((const SQL_NUMERIC_STRUCT *) buf, tmp))
+	    return false;
+	*out = vx_strtod(tmp, NULL);
+	return true;
+    default:
+	if (!bulk_get_int(ctype, buf, len, &ival))
+	    return false;
+	*out = (double) ival;
+	return true;
+    }
+}
+
+
+static bool bulk_get_text(SQLSMALLINT ctype, const char *buf, SQLLEN len,
+			  std::string &out)
+{
+    char tmp[128];
+    SQLBIGINT ival;
+
+    switch (ctype)
+    {
+    case SQL_C_CHAR:
+    case SQL_C_BINARY:
+	out.assign(buf, len);
+	return true;
+#ifdef	UNICODE_SUPPORT
+    case SQL_C_WCHAR:
+	{
+	    SQLLEN olen;
+	    char *utf8 = ucs2_to_utf8((const SQLWCHAR *) buf, len / WCLEN,
+				      &olen, FALSE);
+
+	    if (!utf8)
+		return false;
+	    out.assign(utf8, olen);
+	    free(utf8);
+	    return true;
+	}
+#endif				/* UNICODE_SUPPORT */
+    case SQL_C_FLOAT:
+	vx_format_double(*(const SFLOAT *) buf, TRUE, tmp);
+	break;
+    case SQL_C_DOUBLE:
+	vx_format_double(*(const SDOUBLE *) buf, FALSE, tmp);
+	break;
+    case SQL_C_NUMERIC:
+	if (!ResolveNumericParam((const SQL_NUMERIC_STRUCT *) buf, tmp))
+	    return false;
+	break;
+    case SQL_C_UBIGINT:
+	snprintf(tmp, sizeof(tmp), "%llu",
+		 (unsigned long long) *(const SQLUBIGINT *) buf);
+	break;
+    case SQL_C_DATE:
+    case SQL_C_TYPE_DATE:
+	{
+	    const DATE_STRUCT *ds = (const DATE_STRUCT *) buf;
+
+	    snprintf(tmp, sizeof(tmp), "%04d-%02d-%02d",
+		     ds->year, ds->month, ds->day);
+	}
+	break;
+    case SQL_C_TIME:
+    case SQL_C_TYPE_TIME:
+	{
+	    const TIME_STRUCT *ts = (const TIME_STRUCT *) buf;
+
+	    snprintf(tmp, sizeof(tmp), "%02d:%02d:%02d",
+		     ts->hour, ts->minute, ts->second);
+	}
+	break;
+    case SQL_C_TIMESTAMP:
+    case SQL_C_TYPE_TIMESTAMP:
+	{
+	    const TIMESTAMP_STRUCT *ts = (const TIMESTAMP_STRUCT *) buf;
+
+	    snprintf(tmp, sizeof(tmp), "%04d-%02d-%02d %02d:%02d:%02d.%06d",
+		     ts->year, ts->month, ts->day, ts->hour, ts->minute,
+		     ts->second, (int) (ts->fraction / 1000));
+	}
+	break;
+    default:
+	if (!bulk_get_int(ctype, buf, len, &ival))
+	    return false;
+	snprintf(tmp, sizeof(tmp), "%lld", (long long) ival);
+	break;
+    }
+    out = tmp;
+    return true;
+}
+
+
+static bool bulk_get_datetime(SQLSMALLINT ctype, const char *buf,
+			      SQLLEN len, SQLBIGINT * secs, int *usecs)
+{
+    int y = 1970, mo = 1, d = 1, h = 0, mi = 0, s = 0;
+    long frac = 0;
+
+    *usecs = 0;
+    switch (ctype)
+    {
+    case SQL_C_DATE:
+    case SQL_C_TYPE_DATE:
+	{
+	    const DATE_STRUCT *ds = (const DATE_STRUCT *) buf;
+
+	    *secs = days_from_civil(ds->year, ds->month, ds->day) * 86400;
+	    return true;
+	}
+    case SQL_C_TIME:
+    case SQL_C_TYPE_TIME:
+	{
+	    const TIME_STRUCT *ts = (const TIME_STRUCT *) buf;
+
+	    *secs = VX_SQL_EPOCH + ts->hour * 3600 + ts->minute * 60
+		+ ts->second;
+	    return true;
+	}
+    case SQL_C_TIMESTAMP:
+    case SQL_C_TYPE_TIMESTAMP:
+	{
+	    const TIMESTAMP_STRUCT *ts = (const TIMESTAMP_STRUCT *) buf;
+
+	    *secs = days_from_civil(ts->year, ts->month, ts->day) * 86400
+		+ ts->hour * 3600 + ts->minute * 60 + ts->second;
+	    *usecs = (int) (ts->fraction / 1000);
+	    return true;
+	}
+    case SQL_C_CHAR:
+	{
+	    char tmp[64], *p;
+	    int n;
+
+	    if (len >= (SQLLEN) sizeof(tmp))
+		return false;
+	    memcpy(tmp, buf, len);
+	    tmp[len] = '\0';
+	    n = sscanf(tmp, "%d-%d-%d %d:%d:%d", &y, &mo, &d, &h, &mi, &s);
+	    if (n == 3 || n == 6)
+		*secs = days_from_civil(y, mo, d) * 86400
+		    + h * 3600 + mi * 60 + s;
+	    else if (3 == sscanf(tmp, "%d:%d:%d", &h, &mi, &s))
+		*secs = VX_SQL_EPOCH + h * 3600 + mi * 60 + s;
+	    else
+		return false;
+	    /* a fraction of a second, to the microsecond */
+	    if (p = strchr(tmp, '.'), p)
+	    {
+		for (n = 0, p++; n < 6; n++)
+		{
+		    frac *= 10;
+		    if (isdigit((UCHAR) * p))
+			frac += *p++ - '0';
+		}
+		*usecs = (int) frac;
+	    }
+	    return true;
+	}
+    default:
+	return false;
+    }
+}
+
+
+/*
+ *	A binary value goes as one base64 string, rather than as an array
+ *	that would take a WvDBusMsg::append() per byte.
+ */
+static void bulk_base64(const char *buf, SQLLEN len, std::string &out)
+{
+    static const char digits[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    SQLLEN i;
+    UInt4 v;
+
+    out.reserve((len + 2) / 3 * 4);
+    for (i = 0; i + 2 < len; i += 3)
+    {
+	v = ((UInt4) (UCHAR) buf[i] << 16) | ((UInt4) (UCHAR) buf[i + 1] << 8)
+	    | (UCHAR) buf[i + 2];
+	out += digits[v >> 18];
+	out += digits[(v >> 12) & 63];
+	out += digits[(v >> 6) & 63];
+	out += digits[v & 63];
+    }
+    if (i < len)
+    {
+	v = (UInt4) (UCHAR) buf[i] << 16;
+	if (i + 1 < len)
+	    v |= (UInt4) (UCHAR) buf[i + 1] << 8;
+	out += digits[v >> 18];
+	out += digits[(v >> 12) & 63];
+	out += i + 1 < len ? digits[(v >> 6) & 63] : '=';
+	out += '=';
+    }
+}
+
+
+/*
+ *	Append one row's value of a column to msg.  A NULL still needs a
+ *	placeholder of the right type; the nullity array says it's NULL.
+ *	Returns roughly how many bytes that took, or -1 if the bound C type
+ *	can't be turned into the column's type.
+ */
+static SQLLEN bulk_append(WvDBusMsg & msg, const BulkColumn & bc,
+			  SQLSMALLINT ctype, const char *buf, SQLLEN len,
+			  bool isnull)
+{
+    SQLBIGINT ival = 0;
+    double dval = 0;
+    std::string text;
+    int usecs = 0;
+
+    switch (bc.kind)
+    {
+    case BK_DOUBLE:
+	if (!isnull && !bulk_get_double(ctype, buf, len, &dval))
+	    return -1;
+	msg.append(dval);
+	return 8;
+    case BK_STRING:
+	if (!isnull && !bulk_get_text(ctype, buf, len, text))
+	    return -1;
+	msg.append(text.c_str());
+	return text.size() + 5;
+    case BK_BINARY:
+	if (!isnull && SQL_C_BINARY != ctype && SQL_C_CHAR != ctype)
+	    return -1;
+	if (!isnull)
+	    bulk_base64(buf, len, text);
+	msg.append(text.c_str());
+	return text.size() + 5;
+    case BK_DATETIME:
+	if (!isnull && !bulk_get_datetime(ctype, buf, len, &ival, &usecs))
+	    return -1;
+	msg.struct_start("xi");
+	msg.append((long long) ival);
+	msg.append(usecs);
+	msg.struct_end();
+	return 16;
+    default:
+	break;
+    }
+
+    if (!isnull && !bulk_get_int(ctype, buf, len, &ival))
+    {
+	/* eg. an integer column bound as SQL_C_NUMERIC */
+	if (!bulk_get_double(ctype, buf, len, &dval))
+	    return -1;
+	ival = (SQLBIGINT) dval;
+    }
+    switch (bc.kind)
+    {
+    case BK_INT64:
+	msg.append((long long) ival);
+	return 8;
+    case BK_INT32:
+	msg.append((int) ival);
+	return 4;
+    case BK_INT16:
+	msg.append((short) ival);
+	return 2;
+    case BK_UINT8:
+	msg.append((unsigned char) ival);
+	return 1;
+    default:
+	msg.append(0 != ival);
+	return 4;
+    }
+}
+
+
+/*
+ *	The table's own name for a result column, from the IRD once the
+ *	statement has been parsed, since the result's name may be an alias.
+ */
+static const char *bulk_column_name(StatementClass * stmt,
+				    QResultClass * res, int col)
+{
+    IRDFields *irdflds = SC_get_IRDF(stmt);
+    FIELD_INFO *fi;
+
+    if (irdflds->fi && col < (int) irdflds->nfields
+	&& (fi = irdflds->fi[col]) != NULL && !fi->expr
+	&& NAME_IS_VALID(fi->column_name))
+	return GET_NAME(fi->column_name);
+    return QR_get_fieldname(res, col);
+}
+
+
+/*
+ *	VxStatement leaves its statement before the first row when it goes
+ *	away, as a new query should, but SQL_ADD doesn't move the cursor.
+ *	Declared ahead of the VxStatement, this puts it back afterwards.
+ */
+class BulkKeepPosition
+{
+    StatementClass *stmt;
+    QResultClass *res;
+    SQLLEN currTuple, rowset_start, base, key_base;
+    bool valid_base;
+public:
+    BulkKeepPosition(StatementClass *_stmt, QResultClass *_res)
+    {
+	stmt = _stmt;
+	res = _res;
+	currTuple = stmt->currTuple;
+	rowset_start = SC_get_rowset_start(stmt);
+	base = res->base;
+	key_base = res->key_base;
+	valid_base = QR_has_valid_base(res);
+    }
+
+    ~BulkKeepPosition()
+    {
+	stmt->currTuple = currTuple;
+	stmt->rowset_start = rowset_start;
+	res->base = base;
+	res->key_base = key_base;
+	if (valid_base)
+	    QR_set_has_valid_base(res);
+    }
+};
+
+
+/*
+ *	SQLBulkOperations(SQL_ADD): insert the rowset in the bound column
+ *	arrays into the table the statement's result came from.
+ *
+ *	Instead of an INSERT per row, the rows are packed into BulkInsert
+ *	calls of about VX_BULK_BATCH_SIZE bytes, in the same row-major,
+ *	typed form versaplexd sends recordsets in (but with binary values
+ *	in base64), and versaplexd hands them to SQL Server's bulk copy.
+ *	Every bound column is sent for every row; SQL_COLUMN_IGNORE in a
+ *	row sends NULL.
+ */
+RETCODE SC_bulk_add(StatementClass * stmt)
+{
+    CSTR func = "SC_bulk_add";
+    QResultClass *res = SC_get_Curres(stmt);
+    ARDFields *opts = SC_get_ARDF(stmt);
+    IRDFields *irdflds = SC_get_IRDF(stmt);
+    SQLULEN num_rows, row, first;
+    std::vector<BulkColumn> cols;
+    std::vector<unsigned char> nulls;
+    std::vector<SQLULEN> sent;
+    std::string table;
+    WvString rowsig;
+    SQLLEN total = 0;
+    int i;
+
+    if (!res || !stmt->statement)
+    {
+	SC_set_error(stmt, STMT_INVALID_CURSOR_STATE_ERROR,
+		     "Null statement result in SC_bulk_add.", func);
+	return SQL_ERROR;
+    }
+    if (!bulk_target_table(stmt->statement, table))
+    {
+	SC_set_error(stmt, STMT_INVALID_OPTION_IDENTIFIER,
+		     "SQL_ADD needs a result from a single table", func);
+	return SQL_ERROR;
+    }
+
+    for (i = 0; i < QR_NumResultCols(res) && i < opts->allocated; i++)
+    {
+	BulkColumn bc;
+
+	if (!opts->bindings[i].buffer && !opts->bindings[i].used)
+	    continue;
+	bc.col = i;
+	bc.kind = bulk_kind(QR_get_field_type(res, i), &bc.vxtype, &bc.sig);
+	cols.push_back(bc);
+	rowsig.append(bc.sig);
+    }
+    if (cols.empty())
+    {
+	SC_set_error(stmt, STMT_INVALID_CURSOR_STATE_ERROR,
+		     "insert list null", func);
+	return SQL_ERROR;
+    }
+    mylog("%s: adding to '%s', row signature '%s'\n", func, table.c_str(),
+	  rowsig.cstr());
+    if (SC_parsed_status(stmt) == STMT_PARSE_NONE)
+	parse_statement(stmt, FALSE);
+
+    num_rows = opts->size_of_rowset > 0 ? opts->size_of_rowset : 1;
+    BulkKeepPosition keep(stmt, res);
+    VxStatement st(stmt);
+    for (row = 0; row < num_rows && st.isok();)
+    {
+	WvDBusMsg msg("vx.versaplexd", "/db", "vx.db", "BulkInsert");
+	SQLLEN batch_bytes = 0, n;
+	std::vector<BulkColumn>::const_iterator it;
+
+	msg.append(table.c_str());
+	msg.array_start("(issnny)");
+	for (it = cols.begin(); it != cols.end(); ++it)
+	{
+	    msg.struct_start("issnny");
+	    msg.append(0);
+	    msg.append(bulk_column_name(stmt, res, it->col));
+	    msg.append(it->vxtype);
+	    msg.append((short) 0);
+	    msg.append((short) 0);
+	    msg.append((unsigned char) 1);
+	    msg.struct_end();
+	}
+	msg.array_end();
+
+	nulls.clear();
+	sent.clear();
+	msg.varray_start(WvString("(%s)", rowsig));
+	for (first = row; row < num_rows && batch_bytes < VX_BULK_BATCH_SIZE;
+	     row++)
+	{
+	    if (opts->row_operation_ptr &&
+		SQL_ROW_IGNORE == opts->row_operation_ptr[row])
+		continue;
+	    msg.struct_start(rowsig);
+	    for (it = cols.begin(); it != cols.end(); ++it)
+	    {
+		const BindInfoClass *b = &opts->bindings[it->col];
+		SQLSMALLINT ctype = b->returntype;
+		const char *buf = NULL;
+		SQLLEN len = 0;
+		bool isnull;
+
+		if (SQL_C_DEFAULT == ctype)
+		    ctype = pgtype_to_ctype(stmt, QR_get_field_type(res,
+							       it->col));
+		isnull = !bulk_value(opts, b, ctype, row, &buf, &len);
+		if (n = bulk_append(msg, *it, ctype, buf, len, isnull), n < 0)
+		{
+		    SC_set_error(stmt, STMT_RESTRICTED_DATA_TYPE_ERROR,
+				 "Can't convert a bound column for SQL_ADD",
+				 func);
+		    st.seterr();
+		    break;
+		}
+		batch_bytes += n;
+		nulls.push_back(isnull ? 1 : 0);
+	    }
+	    if (!st.isok())
+		break;
+	    msg.struct_end();
+	    sent.push_back(row);
+	}
+	if (!st.isok())
+	{
+	    sent.push_back(row);
+	    break;
+	}
+	msg.varray_end();
+
+	msg.array_start("ay");
+	for (SQLULEN r = 0; r < sent.size(); r++)
+	{
+	    msg.array_start("y");
+	    for (unsigned c = 0; c < cols.size(); c++)
+		msg.append(nulls[r * cols.size() + c]);
+	    msg.array_end();
+	}
+	msg.array_end();
+
+	if (sent.empty())
+	    continue;
+	mylog("%s: sending rows %d to %d, about %d bytes\n", func,
+	      (int) first, (int) row, (int) batch_bytes);
+	VxResultSet rs;
+	st.runscalar(rs, msg);
+	if (!!rs.error)
+	{
+	    SC_set_error(stmt, STMT_EXEC_ERROR, rs.error.cstr(), func);
+	    st.seterr();
+	    break;
+	}
+	total += rs.scalar;
+	for (unsigned r = 0; irdflds->rowStatusArray && r < sent.size(); r++)
+	    irdflds->rowStatusArray[sent[r]] = SQL_ROW_ADDED;
+    }
+    if (!st.isok())
+    {
+	for (unsigned r = 0; irdflds->rowStatusArray && r < sent.size(); r++)
+	    irdflds->rowStatusArray[sent[r]] = SQL_ROW_ERROR;
+    }
+    res->recent_processed_row_count = total;
+
+    return st.retcode();
+}
@@ -0,0 +1,446 @@
+/*
+ * Description:	This module contains routines for keeping the results of
+ *		catalog queries in a per-connection LRU cache, so that
+ *		SQLTables, SQLColumns and SQLPrimaryKeys don't have to ask
+ *		versaplexd the same thing over and over (see "catcache.h").
+ */
+
+#include "catcache.h"
+#include "connection.h"
+#include "qresult.h"
+#include "misc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ *	Copy the given rows of res (all of them, if rows is NULL), which must
+ *	have all its rows in and keep them as strings (the way catalog
+ *	results do), into a new entry for query.  The names and values all go
+ *	in one block, since they live and die together.
+ */
+CatalogEntry *CE_Constructor_rows(const char *query, QResultClass * res,
+				  const SQLLEN * rows, SQLLEN num_rows)
+{
+    CatalogEntry *rv;
+    Int2 num_fields = QR_NumResultCols(res);
+    SQLLEN i, row;
+    size_t len = strlen(query), total = len + 1;
+    const char *str;
+    char *p;
+    int col;
+
+    if (!rows)
+	num_rows = QR_get_num_cached_tuples(res);
+    if (res->coldata || num_fields <= 0
+	|| (num_rows > 0 && !res->backend_tuples))
+	return NULL;
+
+    for (col = 0; col < num_fields; col++)
+    {
+	str = QR_get_fieldname(res, col);
+	total += (str ? strlen(str) : 0) + 1;
+    }
+    for (i = 0; i < num_rows; i++)
+    {
+	row = rows ? rows[i] : i;
+	for (col = 0; col < num_fields; col++)
+	    if (str = (const char *) QR_get_value_backend_row(res, row, col),
+		str)
+		total += strlen(str) + 1;
+    }
+
+    rv = (CatalogEntry *) calloc(sizeof(CatalogEntry), 1);
+    if (!rv)
+	return NULL;
+    rv->fields = (CatalogField *) malloc(sizeof(CatalogField) * num_fields);
+    rv->values = num_rows > 0 ?
+	(char **) malloc(sizeof(char *) * num_rows * num_fields) : NULL;
+    rv->strings = (char *) malloc(total);
+    if (!rv->fields || !rv->strings || (num_rows > 0 && !rv->values))
+    {
+	free(rv->fields);
+	free(rv->values);
+	free(rv->strings);
+	free(rv);
+	return NULL;
+    }
+
+    rv->num_fields = num_fields;
+    rv->num_rows = num_rows;
+    p = rv->strings;
+    memcpy(p, query, len + 1);
+    rv->query = p;
+    p += len + 1;
+    for (col = 0; col < num_fields; col++)
+    {
+	str = QR_get_fieldname(res, col);
+	len = str ? strlen(str) : 0;
+	memcpy(p, str ? str : "", len + 1);
+	rv->fields[col].name = p;
+	rv->fields[col].type = QR_get_field_type(res, col);
+	rv->fields[col].size = QR_get_fieldsize(res, col);
+	p += len + 1;
+    }
+    for (i = 0; i < num_rows; i++)
+    {
+	row = rows ? rows[i] : i;
+	for (col = 0; col < num_fields; col++)
+	{
+	    str = (const char *) QR_get_value_backend_row(res, row, col);
+	    if (!str)
+	    {
+		CE_get_value(rv, i, col) = NULL;
+		continue;
+	    }
+	    len = strlen(str);
+	    memcpy(p, str, len + 1);
+	    CE_get_value(rv, i, col) = p;
+	    p += len + 1;
+	}
+    }
+
+    rv->len = strlen(query);
+    rv->fetched = time(NULL);
+    rv->refcount = 1;
+
+    return rv;
+}
+
+
+CatalogEntry *CE_Constructor(const char *query, QResultClass * res)
+{
+    return CE_Constructor_rows(query, res, NULL, 0);
+}
+
+
+void CE_release(CatalogEntry * self)
+{
+    if (!self || --self->refcount > 0)
+	return;
+    free(self->values);
+    free(self->fields);
+    free(self->strings);
+    free(self);
+}
+
+
+CatalogCacheClass *CAT_Constructor(int max_count)
+{
+    CatalogCacheClass *rv;
+
+    rv = (CatalogCacheClass *) calloc(sizeof(CatalogCacheClass), 1);
+    if (!rv)
+	return NULL;
+    if (!LRU_init(&rv->lru))
+    {
+	free(rv);
+	return NULL;
+    }
+    if (!LRU_init(&rv->prefetched))
+    {
+	LRU_free(&rv->lru);
+	free(rv);
+	return NULL;
+    }
+    rv->max_count = max_count > 0 ? max_count : CAT_DEFAULT_SIZE;
+
+    return rv;
+}
+
+
+/*	Take ce out of table, and drop the cache's reference to it */
+static void CAT_remove(LRUCache * table, CatalogEntry * ce)
+{
+    LRU_remove(table, &ce->lru);
+    CE_release(ce);
+}
+
+
+static void CAT_empty(LRUCache * table)
+{
+    while (table->tail)
+	CAT_remove(table, (CatalogEntry *) table->tail);
+}
+
+
+/*	Forget everything, but keep the counts for the log */
+void CAT_clear(CatalogCacheClass * self)
+{
+    if (!self)
+	return;
+    CAT_empty(&self->lru);
+    CAT_empty(&self->prefetched);
+    self->prefetch = CAT_PREFETCH_NONE;
+}
+
+
+void CAT_Destructor(CatalogCacheClass * self)
+{
+    if (!self)
+	return;
+    mylog("CAT_Destructor: %d entries, %d prefetched, %u hits, %u misses, "
+	  "%u expired\n", self->lru.count, self->prefetched.count,
+	  self->hits, self->misses, self->expired);
+    CAT_clear(self);
+    LRU_free(&self->lru);
+    LRU_free(&self->prefetched);
+    free(self);
+}
+
+
+static CatalogEntry *CAT_find(LRUCache * table, const char *query,
+			      size_t len, UInt4 hash)
+{
+    LRUEntry *entry;
+    CatalogEntry *ce;
+
+    for (entry = LRU_bucket(table, hash); entry; entry = entry->hnext)
+    {
+	ce = (CatalogEntry *) entry;
+	if (entry->hash == hash && ce->len == len
+	    && 0 == memcmp(ce->query, query, len))
+	    return ce;
+    }
+    return NULL;
+}
+
+
+/*
+ *	Everything a prefetch got was fetched at once, so when one of those
+ *	entries is too old they all are.  Drop them all, so that the next
+ *	SQLColumns prefetches again.
+ */
+static void CAT_expire_prefetch(CatalogCacheClass * self)
+{
+    mylog("Prefetched catalog results are too old\n");
+    self->expired++;
+    CAT_empty(&self->prefetched);
+    if (self->prefetch == CAT_PREFETCH_DONE)
+	self->prefetch = CAT_PREFETCH_NONE;
+}
+
+
+/*
+ *	Find query's entry, if it's there and less than ttl seconds old, and
+ *	take a reference to it for the caller, who must CE_release() it.
+ */
+CatalogEntry *CAT_get(CatalogCacheClass * self, const char *query, int ttl)
+{
+    size_t len = strlen(query);
+    UInt4 hash = LRU_hash(query, len);
+    LRUCache *table = &self->lru;
+    CatalogEntry *ce = CAT_find(table, query, len, hash);
+
+    if (!ce)
+    {
+	table = &self->prefetched;
+	ce = CAT_find(table, query, len, hash);
+    }
+    if (ce && time(NULL) - ce->fetched >= ttl)
+    {
+	if (table == &self->prefetched)
+	    CAT_expire_prefetch(self);
+	else
+	{
+	    mylog("Catalog result for '%s' is too old\n", query);
+	    self->expired++;
+	    CAT_remove(table, ce);
+	}
+	ce = NULL;
+    }
+    if (!ce)
+    {
+	self->misses++;
+	return NULL;
+    }
+    self->hits++;
+    LRU_touch(table, &ce->lru);
+    ce->refcount++;
+    return ce;
+}
+
+
+/*
+ *	Add ce, taking over the caller's reference.  It replaces any entry
+ *	for the same query (which another statement might have fetched at
+ *	the same time); when the cache is full the least recently used entry
+ *	is dropped.
+ */
+void CAT_put(CatalogCacheClass * self, CatalogEntry * ce)
+{
+    UInt4 hash = LRU_hash(ce->query, ce->len);
+    CatalogEntry *old;
+
+    if (old = CAT_find(&self->lru, ce->query, ce->len, hash), old)
+	CAT_remove(&self->lru, old);
+    if (old = CAT_find(&self->prefetched, ce->query, ce->len, hash), old)
+	CAT_remove(&self->prefetched, old);
+    if (self->lru.count >= self->max_count)
+	CAT_remove(&self->lru, (CatalogEntry *) self->lru.tail);
+    LRU_add(&self->lru, &ce->lru, hash);
+}
+
+
+/*	How many seconds a catalog result stays good for; 0 means never */
+int CC_catalog_ttl(const ConnectionClass * conn)
+{
+    return atoi(conn->connInfo.catalog_cache_ttl);
+}
+
+
+/*
+ *	Size the cache from the CatalogCacheSize option, once the
+ *	connection knows its options (it starts out at CAT_DEFAULT_SIZE).
+ */
+void CC_size_catalog(ConnectionClass * conn)
+{
+    int max_count = atoi(conn->connInfo.catalog_cache_size);
+
+    if (!conn->catalog || max_count <= 0)
+	return;
+    CONNLOCK_ACQUIRE(conn);
+    conn->catalog->max_count = max_count;
+    while (conn->catalog->lru.count > max_count)
+	CAT_remove(&conn->catalog->lru,
+		   (CatalogEntry *) conn->catalog->lru.tail);
+    CONNLOCK_RELEASE(conn);
+}
+
+
+/*	As CAT_get(), under the connection's lock, with the TTL option */
+CatalogEntry *CC_get_catalog(ConnectionClass * conn, const char *query)
+{
+    CatalogEntry *ce = NULL;
+    int ttl = CC_catalog_ttl(conn);
+
+    if (ttl <= 0 || !conn->catalog)
+	return NULL;
+    CONNLOCK_ACQUIRE(conn);
+    ce = CAT_get(conn->catalog, query, ttl);
+    CONNLOCK_RELEASE(conn);
+
+    return ce;
+}
+
+
+void CC_put_catalog(ConnectionClass * conn, CatalogEntry * ce)
+{
+    if (!conn->catalog)
+    {
+	CE_release(ce);
+	return;
+    }
+    CONNLOCK_ACQUIRE(conn);
+    CAT_put(conn->catalog, ce);
+    CONNLOCK_RELEASE(conn);
+}
+
+
+/*
+ *	Whether it's time for SQLColumns to fetch every table's columns in
+ *	one go: the PrefetchColumns option is on, and it hasn't been done
+ *	since the schema last changed, or what it got has expired.  Notes
+ *	that it's being done, so that only one statement does it.
+ */
+BOOL CC_start_prefetch(ConnectionClass * conn)
+{
+    CatalogEntry *oldest;
+    int ttl = CC_catalog_ttl(conn);
+    BOOL rv = FALSE;
+
+    if (ttl <= 0 || conn->connInfo.prefetch_columns <= 0 || !conn->catalog)
+	return FALSE;
+    CONNLOCK_ACQUIRE(conn);
+    oldest = (CatalogEntry *) conn->catalog->prefetched.tail;
+    if (oldest && time(NULL) - oldest->fetched >= ttl)
+	CAT_expire_prefetch(conn->catalog);
+    if (conn->catalog->prefetch == CAT_PREFETCH_NONE)
+    {
+	conn->catalog->prefetch = CAT_PREFETCH_RUNNING;
+	rv = TRUE;
+    }
+    CONNLOCK_RELEASE(conn);
+
+    return rv;
+}
+
+
+/*
+ *	File what a prefetch got (taking over the references in ces), and
+ *	only then count it as done.  With nothing to file the next
+ *	SQLColumns tries again, unless the answer was of a kind that can
+ *	never be filed.  Every table is kept, however many there are: they
+ *	go in a table of their own that CatalogCacheSize doesn't apply to,
+ *	until they expire together (see CAT_get()).  If the schema changed
+ *	while the prefetch was running, what it got may be stale, so it's
+ *	dropped.
+ */
+void CC_end_prefetch(ConnectionClass * conn, CatalogEntry ** ces,
+		     int count, BOOL usable)
+{
+    CatalogCacheClass *self = conn->catalog;
+    CatalogEntry *ce, *old;
+    UInt4 hash;
+    int i, num_filed = 0;
+
+    if (!self)
+    {
+	for (i = 0; i < count; i++)
+	    CE_release(ces[i]);
+	return;
+    }
+    CONNLOCK_ACQUIRE(conn);
+    if (self->prefetch == CAT_PREFETCH_RUNNING)
+    {
+	CAT_empty(&self->prefetched);
+	for (num_filed = 0; num_filed < count; num_filed++)
+	{
+	    ce = ces[num_filed];
+	    hash = LRU_hash(ce->query, ce->len);
+	    /* an older answer for the table would be found first */
+	    if (old = CAT_find(&self->lru, ce->query, ce->len, hash), old)
+		CAT_remove(&self->lru, old);
+	    LRU_add(&self->prefetched, &ce->lru, hash);
+	}
+	if (num_filed > 0)
+	    self->prefetch = CAT_PREFETCH_DONE;
+	else
+	    self->prefetch = usable ? CAT_PREFETCH_NONE : CAT_PREFETCH_UNUSABLE;
+    }
+    else
+	mylog("The schema changed during the prefetch; dropping it\n");
+    for (i = num_filed; i < count; i++)
+	CE_release(ces[i]);
+    CONNLOCK_RELEASE(conn);
+}
+
+
+void CC_release_catalog(ConnectionClass * conn, CatalogEntry * ce)
+{
+    if (!ce)
+	return;
+    CONNLOCK_ACQUIRE(conn);
+    CE_release(ce);
+    CONNLOCK_RELEASE(conn);
+}
+
+
+/*
+ *	Called whenever the schema might have changed under us, e.g. after
+ *	a CREATE or DROP, so the next catalog call goes to the server.
+ */
+void CC_forget_catalog(ConnectionClass * conn)
+{
+    if (!conn->catalog)
+	return;
+    CONNLOCK_ACQUIRE(conn);
+    if (conn->catalog->lru.count > 0 || conn->catalog->prefetched.count > 0
+	|| conn->catalog->prefetch != CAT_PREFETCH_NONE)
+    {
+	mylog("Forgetting %d catalog results\n",
+	      conn->catalog->lru.count + conn->catalog->prefetched.count);
+	CAT_clear(conn->catalog);
+    }
+    CONNLOCK_RELEASE(conn);
+}
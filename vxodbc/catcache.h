@@ -0,0 +1,98 @@
+/* File:			catcache.h
+ *
+ * Description:		See "catcache.cc"
+ *
+ * Comments:		See "notice.txt" for copyright and license information.
+ *
+ */
+
+#ifndef __CATCACHE_H__
+#define __CATCACHE_H__
+
+#include "psqlodbc.h"
+#include "lrucache.h"
+
+#include <stddef.h>
+#include <time.h>
+
+/*	The description of one column of a cached catalog result */
+typedef struct
+{
+	char		*name;
+	OID		type;
+	Int4		size;
+} CatalogField;
+
+/*
+ *	A copy of the rows versaplexd sent back for a catalog query
+ *	("LIST TABLES", "LIST COLUMNS [t]" and so on), so that asking again
+ *	doesn't need another round trip.  Never changed once it's in the
+ *	cache, so it can be read without the lock by anyone holding a
+ *	reference; all changes to refcount happen under the connection's
+ *	CONNLOCK.
+ */
+struct CatalogEntry_
+{
+	LRUEntry	lru;		/* must come first */
+	char		*query;		/* what was sent, which is also the key */
+	size_t		len;
+	time_t		fetched;	/* when it came from the server */
+	Int2		num_fields;
+	CatalogField	*fields;
+	SQLLEN		num_rows;
+	char		**values;	/* num_rows * num_fields; NULL for a NULL */
+	char		*strings;	/* where the names and values live */
+	int		refcount;
+};
+
+/*	A connection's most recently used catalog results */
+struct CatalogCacheClass_
+{
+	LRUCache	lru;		/* by hash of the query */
+	int		max_count;
+	LRUCache	prefetched;	/* what the last prefetch got, which
+					 * max_count doesn't apply to */
+	char		prefetch;	/* CAT_PREFETCH_* */
+	UInt4		hits;
+	UInt4		misses;
+	UInt4		expired;
+};
+
+#define	CAT_DEFAULT_SIZE	128
+
+/*	How far SQLColumns has got with fetching every table's columns */
+enum
+{
+	CAT_PREFETCH_NONE = 0,	/* not yet, or the schema changed since */
+	CAT_PREFETCH_RUNNING,	/* a statement is doing it now */
+	CAT_PREFETCH_DONE,	/* every table's columns were filed, and
+				 * haven't expired yet */
+	CAT_PREFETCH_UNUSABLE	/* the answer can't be filed; don't ask again */
+};
+
+#define CE_get_num_fields(self)	(self->num_fields)
+#define CE_get_num_rows(self)	(self->num_rows)
+#define CE_get_value(self, row, col)	(self->values[(row) * (self)->num_fields + (col)])
+
+CatalogEntry	*CE_Constructor(const char *query, QResultClass *res);
+CatalogEntry	*CE_Constructor_rows(const char *query, QResultClass *res,
+				     const SQLLEN *rows, SQLLEN num_rows);
+void		CE_release(CatalogEntry *self);
+
+CatalogCacheClass *CAT_Constructor(int max_count);
+void		CAT_Destructor(CatalogCacheClass *self);
+void		CAT_clear(CatalogCacheClass *self);
+CatalogEntry	*CAT_get(CatalogCacheClass *self, const char *query, int ttl);
+void		CAT_put(CatalogCacheClass *self, CatalogEntry *ce);
+
+int		CC_catalog_ttl(const ConnectionClass *conn);
+void		CC_size_catalog(ConnectionClass *conn);
+CatalogEntry	*CC_get_catalog(ConnectionClass *conn, const char *query);
+void		CC_put_catalog(ConnectionClass *conn, CatalogEntry *ce);
+BOOL		CC_start_prefetch(ConnectionClass *conn);
+void		CC_end_prefetch(ConnectionClass *conn, CatalogEntry **ces,
+				int count, BOOL usable);
+void		CC_release_catalog(ConnectionClass *conn, CatalogEntry *ce);
+void		CC_forget_catalog(ConnectionClass *conn);
+
+#endif
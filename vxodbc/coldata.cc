@@ -0,0 +1,621 @@
+/*
+ * Description:	This module contains routines for keeping the rows of a
+ *		versaplexd result in column-major, typed arrays (see
+ *		"coldata.h").
+ */
+
+#include "coldata.h"
+#include "columninfo.h"
+#include "pgtypes.h"
+#include "convert.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Int2 kind_width(ColumnDataKind kind)
+{
+    switch (kind)
+    {
+    case CD_INT8:
+	return sizeof(SQLBIGINT);
+    case CD_INT4:
+	return sizeof(Int4);
+    case CD_INT2:
+	return sizeof(Int2);
+    case CD_UINT1:
+    case CD_BOOL:
+	return sizeof(UCHAR);
+    case CD_DOUBLE:
+	return sizeof(double);
+    case CD_DATETIME:
+	return sizeof(CD_DateTime);
+    case CD_DECIMAL:
+	return sizeof(CD_Decimal);
+    case CD_TEXT:
+    case CD_BINARY:
+    default:
+	return sizeof(SQLULEN);
+    }
+}
+
+
+ColumnDataKind CD_kind_from_type(OID type)
+{
+    switch (type)
+    {
+    case PG_TYPE_INT8:
+	return CD_INT8;
+    case PG_TYPE_INT4:
+	return CD_INT4;
+    case PG_TYPE_INT2:
+	return CD_INT2;
+    case PG_TYPE_CHAR:		/* versaplex's UInt8 */
+	return CD_UINT1;
+    case PG_TYPE_BOOL:
+	return CD_BOOL;
+    case PG_TYPE_FLOAT8:
+	return CD_DOUBLE;
+    case VX_TYPE_DATETIME:
+	return CD_DATETIME;
+    case PG_TYPE_NUMERIC:
+	return CD_DECIMAL;
+    case PG_TYPE_BYTEA:
+	return CD_BINARY;
+    default:
+	return CD_TEXT;
+    }
+}
+
+
+ColumnDataClass *CD_Constructor(const ColumnInfoClass * fields)
+{
+    ColumnDataClass *rv;
+    int i, num_fields = CI_get_num_fields(fields);
+
+    rv = (ColumnDataClass *) malloc(sizeof(ColumnDataClass));
+    if (!rv)
+	return NULL;
+    rv->num_fields = num_fields;
+    rv->num_rows = 0;
+    rv->rows_allocated = 0;
+    rv->cols = (struct ColumnData_ *)
+	calloc(num_fields > 0 ? num_fields : 1, sizeof(struct ColumnData_));
+    if (!rv->cols)
+    {
+	free(rv);
+	return NULL;
+    }
+    for (i = 0; i < num_fields; i++)
+    {
+	rv->cols[i].kind = CD_kind_from_type(CI_get_oid(fields, i));
+	rv->cols[i].width = kind_width(rv->cols[i].kind);
+    }
+
+    return rv;
+}
+
+
+void CD_Destructor(ColumnDataClass * self)
+{
+    int i;
+
+    if (!self)
+	return;
+    for (i = 0; i < self->num_fields; i++)
+    {
+	if (self->cols[i].values)
+	    free(self->cols[i].values);
+	if (self->cols[i].valid)
+	    free(self->cols[i].valid);
+	if (self->cols[i].blob)
+	    free(self->cols[i].blob);
+    }
+    free(self->cols);
+    free(self);
+}
+
+
+/*
+ *	Make sure num_rows more rows can be added without growing any
+ *	column's arrays, so a chunk's worth of rows costs at most one
+ *	realloc per array.
+ */
+BOOL CD_reserve_rows(ColumnDataClass * self, SQLULEN num_rows)
+{
+    SQLULEN need = self->num_rows + num_rows, alloc;
+    int i;
+
+    if (need <= self->rows_allocated)
+	return TRUE;
+    alloc = self->rows_allocated ? self->rows_allocated * 2 : TUPLE_MALLOC_INC;
+    while (alloc < need)
+	alloc *= 2;
+    for (i = 0; i < self->num_fields; i++)
+    {
+	struct ColumnData_ *cd = &self->cols[i];
+	char *values = (char *) realloc(cd->values, alloc * cd->width);
+
+	if (!values)
+	    return FALSE;
+	cd->values = values;
+	if (cd->valid)
+	{
+	    UCHAR *valid = (UCHAR *) realloc(cd->valid, (alloc + 7) / 8);
+
+	    if (!valid)
+		return FALSE;
+	    cd->valid = valid;
+	}
+    }
+    self->rows_allocated = alloc;
+
+    return TRUE;
+}
+
+
+/*
+ *	Add an empty (zero, or zero length) row to the end, growing every
+ *	column's array if necessary.
+ */
+BOOL CD_add_row(ColumnDataClass * self)
+{
+    SQLULEN row = self->num_rows;
+    int i;
+
+    if (!CD_reserve_rows(self, 1))
+	return FALSE;
+
+    for (i = 0; i < self->num_fields; i++)
+    {
+	struct ColumnData_ *cd = &self->cols[i];
+
+	if (CD_TEXT == cd->kind || CD_BINARY == cd->kind)
+	    *(SQLULEN *) (cd->values + row * cd->width) = cd->blob_used;
+	else
+	    memset(cd->values + row * cd->width, 0, cd->width);
+	if (cd->valid)
+	    cd->valid[row >> 3] |= (1 << (row & 7));
+    }
+    self->num_rows++;
+
+    return TRUE;
+}
+
+
+void CD_set_integer(ColumnDataClass * self, int col, SQLBIGINT value)
+{
+    SQLULEN row = self->num_rows - 1;
+
+    switch (CD_get_kind(self, col))
+    {
+    case CD_INT8:
+	CD_get_int8(self, col, row) = value;
+	break;
+    case CD_INT4:
+	CD_get_int4(self, col, row) = (Int4) value;
+	break;
+    case CD_INT2:
+	CD_get_int2(self, col, row) = (Int2) value;
+	break;
+    case CD_UINT1:
+	CD_get_uint1(self, col, row) = (UCHAR) value;
+	break;
+    case CD_BOOL:
+	CD_get_uint1(self, col, row) = (0 != value);
+	break;
+    case CD_DOUBLE:
+	CD_get_double(self, col, row) = (double) value;
+	break;
+    default:
+	break;
+    }
+}
+
+
+void CD_set_double(ColumnDataClass * self, int col, double value)
+{
+    if (CD_DOUBLE == CD_get_kind(self, col))
+	CD_get_double(self, col, self->num_rows - 1) = value;
+    else
+	CD_set_integer(self, col, (SQLBIGINT) value);
+}
+
+
+void CD_set_datetime(ColumnDataClass * self, int col, SQLBIGINT secs,
+		     Int4 usecs)
+{
+    CD_DateTime *dt;
+
+    if (CD_DATETIME != CD_get_kind(self, col))
+	return;
+    dt = (CD_DateTime *) CD_value_ptr(self, col, self->num_rows - 1);
+    dt->secs = secs;
+    dt->usecs = usecs;
+}
+
+
+/*
+ *	Append len bytes and a NUL to a TEXT or BINARY column's blob area,
+ *	returning FALSE if there's no room for them.
+ */
+static BOOL CD_append_blob(struct ColumnData_ *cd, const void *data,
+			   size_t len)
+{
+    SQLULEN need = cd->blob_used + len + 1;
+
+    if (need > cd->blob_allocated)
+    {
+	SQLULEN alloc = cd->blob_allocated ? cd->blob_allocated : 4096;
+	char *blob;
+
+	while (alloc < need)
+	    alloc *= 2;
+	if (blob = (char *) realloc(cd->blob, alloc), !blob)
+	    return FALSE;
+	cd->blob = blob;
+	cd->blob_allocated = alloc;
+    }
+    if (len > 0)
+	memcpy(cd->blob + cd->blob_used, data, len);
+    cd->blob[cd->blob_used + len] = '\0';
+    cd->blob_used += len + 1;
+
+    return TRUE;
+}
+
+
+/*
+ *	Turn a DECIMAL column into a TEXT one, writing out the rows so far
+ *	as text.  The last row is left empty, for the caller to set.
+ */
+static BOOL CD_decimals_to_text(ColumnDataClass * self, int col)
+{
+    struct ColumnData_ *cd = &self->cols[col];
+    char *decimals = cd->values, buf[48];
+    SQLULEN row, *ends;
+
+    ends = (SQLULEN *) malloc((self->rows_allocated > 0 ?
+			       self->rows_allocated : 1) * sizeof(SQLULEN));
+    if (!ends)
+	return FALSE;
+    for (row = 0; row + 1 < self->num_rows; row++)
+    {
+	const CD_Decimal *dec = (const CD_Decimal *)
+	    (decimals + row * sizeof(CD_Decimal));
+
+	if (!CD_is_null(self, col, row)
+	    && !CD_append_blob(cd, buf, CD_decimal_to_text(dec, buf)))
+	{
+	    free(ends);
+	    return FALSE;
+	}
+	ends[row] = cd->blob_used;
+    }
+    ends[row] = cd->blob_used;
+    cd->kind = CD_TEXT;
+    cd->width = sizeof(SQLULEN);
+    cd->values = (char *) ends;
+    free(decimals);
+
+    return TRUE;
+}
+
+
+/*
+ *	Parses versaplexd's string form of a Decimal into the last row.  One
+ *	that doesn't fit turns the whole column into TEXT, so that it and
+ *	everything after it is kept just as it was sent.  Returns FALSE if
+ *	there isn't the memory for that.
+ */
+BOOL CD_set_decimal(ColumnDataClass * self, int col, const char *str)
+{
+    CD_Decimal *dec;
+
+    if (CD_DECIMAL != CD_get_kind(self, col))
+	return FALSE;
+    dec = (CD_Decimal *) CD_value_ptr(self, col, self->num_rows - 1);
+    if (CD_parse_decimal(str, dec))
+	return TRUE;
+    memset(dec, 0, sizeof(*dec));
+    mylog("Decimal '%s' doesn't fit; keeping column %d as text\n", str, col);
+    if (!CD_decimals_to_text(self, col))
+	return FALSE;
+    return CD_set_blob(self, col, str, strlen(str));
+}
+
+
+/*
+ *	Append a TEXT or BINARY value.  Every value gets a NUL after it, so
+ *	that TEXT can be handed out without copying.
+ */
+BOOL CD_set_blob(ColumnDataClass * self, int col, const void *data,
+		 size_t len)
+{
+    struct ColumnData_ *cd = &self->cols[col];
+
+    if (CD_TEXT != cd->kind && CD_BINARY != cd->kind)
+	return FALSE;
+    if (!CD_append_blob(cd, data, len))
+	return FALSE;
+    *(SQLULEN *) CD_value_ptr(self, col, self->num_rows - 1) =
+	cd->blob_used;
+
+    return TRUE;
+}
+
+
+/*
+ *	Mark the last row's value NULL.  Columns only get a validity bitmap
+ *	once they have a NULL in them, so NULL-free columns pay nothing.
+ */
+BOOL CD_set_null(ColumnDataClass * self, int col)
+{
+    struct ColumnData_ *cd = &self->cols[col];
+    SQLULEN row = self->num_rows - 1;
+
+    if (!cd->valid)
+    {
+	if (cd->valid = (UCHAR *) malloc((self->rows_allocated + 7) / 8),
+	    !cd->valid)
+	    return FALSE;
+	memset(cd->valid, 0xff, (self->rows_allocated + 7) / 8);
+    }
+    cd->valid[row >> 3] &= ~(1 << (row & 7));
+
+    return TRUE;
+}
+
+
+BOOL CD_is_integer(const ColumnDataClass * self, int col)
+{
+    switch (CD_get_kind(self, col))
+    {
+    case CD_INT8:
+    case CD_INT4:
+    case CD_INT2:
+    case CD_UINT1:
+    case CD_BOOL:
+	return TRUE;
+    default:
+	return FALSE;
+    }
+}
+
+
+SQLBIGINT CD_get_integer(const ColumnDataClass * self, int col, SQLULEN row)
+{
+    switch (CD_get_kind(self, col))
+    {
+    case CD_INT8:
+	return CD_get_int8(self, col, row);
+    case CD_INT4:
+	return CD_get_int4(self, col, row);
+    case CD_INT2:
+	return CD_get_int2(self, col, row);
+    case CD_UINT1:
+    case CD_BOOL:
+	return CD_get_uint1(self, col, row);
+    case CD_DOUBLE:
+	return (SQLBIGINT) CD_get_double(self, col, row);
+    case CD_DECIMAL:
+	return CD_decimal_to_integer(CD_get_decimal(self, col, row));
+    default:
+	return 0;
+    }
+}
+
+
+/*
+ *	Returns the TEXT/BINARY value of a cell (NUL terminated either way),
+ *	and its length not counting the NUL.
+ */
+const char *CD_get_blob(const ColumnDataClass * self, int col, SQLULEN row,
+			SQLLEN * len)
+{
+    const struct ColumnData_ *cd = &self->cols[col];
+    SQLULEN end, start;
+
+    end = *(const SQLULEN *) (cd->values + row * cd->width);
+    start = row > 0 ?
+	*(const SQLULEN *) (cd->values + (row - 1) * cd->width) : 0;
+    if (end == start)
+    {
+	/* never set; treat it as empty */
+	if (len)
+	    *len = 0;
+	return "";
+    }
+    if (len)
+	*len = end - start - 1;
+    return cd->blob + start;
+}
+
+
+/*
+ *	128-bit arithmetic on a Decimal's magnitude, a 32-bit word at a time
+ *	so as not to need a compiler with a 128-bit type.
+ */
+
+/* mag = mag * mul + add; returns what overflowed the top word */
+static UInt4 dec_muladd(UInt4 *mag, UInt4 mul, UInt4 add)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+	SQLUBIGINT t = (SQLUBIGINT) mag[i] * mul + add;
+
+	mag[i] = (UInt4) t;
+	add = (UInt4) (t >> 32);
+    }
+    return add;
+}
+
+/* mag /= div; returns the remainder */
+static UInt4 dec_divmod(UInt4 *mag, UInt4 div)
+{
+    SQLUBIGINT rem = 0;
+    int i;
+
+    for (i = 3; i >= 0; i--)
+    {
+	SQLUBIGINT t = (rem << 32) | mag[i];
+
+	mag[i] = (UInt4) (t / div);
+	rem = t % div;
+    }
+    return (UInt4) rem;
+}
+
+static const UInt4 dec_pow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+};
+
+
+/*
+ *	Parses the protocol's decimal form, [+-]?[0-9]*(\.[0-9]*)?, with ""
+ *	meaning zero.  Fraction digits past CD_DECIMAL_DIGITS are dropped;
+ *	an integer part longer than that doesn't fit, and returns FALSE.
+ */
+BOOL CD_parse_decimal(const char *str, CD_Decimal * dec)
+{
+    const char *s = str;
+    UInt4 chunk = 0;
+    int chunk_digits = 0;
+    BOOL dot = FALSE;
+
+    memset(dec, 0, sizeof(*dec));
+    while (isspace((UCHAR) *s))
+	s++;
+    if (*s == '-')
+    {
+	dec->negative = 1;
+	s++;
+    } else if (*s == '+')
+	s++;
+    while (*s == '0')
+	s++;
+    for (;; s++)
+    {
+	if (*s == '.' && !dot)
+	{
+	    dot = TRUE;
+	    continue;
+	}
+	if (!isdigit((UCHAR) *s))
+	    break;
+	if (dec->precision >= CD_DECIMAL_DIGITS)
+	{
+	    if (dot)
+		continue;
+	    return FALSE;
+	}
+	chunk = chunk * 10 + (*s - '0');
+	dec->precision++;
+	if (dot)
+	    dec->scale++;
+	/* nine digits at a time fit in a word */
+	if (++chunk_digits == 9)
+	{
+	    dec_muladd(dec->mag, dec_pow10[9], chunk);
+	    chunk = 0;
+	    chunk_digits = 0;
+	}
+    }
+    if (chunk_digits > 0)
+	dec_muladd(dec->mag, dec_pow10[chunk_digits], chunk);
+    if (!dec->mag[0] && !dec->mag[1] && !dec->mag[2] && !dec->mag[3])
+	dec->negative = 0;	/* "-0" is just zero */
+    return TRUE;
+}
+
+
+/*
+ *	The integer part, truncated toward zero, and like strtoll() clamped
+ *	to what a SQLBIGINT holds.
+ */
+SQLBIGINT CD_decimal_to_integer(const CD_Decimal * dec)
+{
+    UInt4 mag[4];
+    int scale = dec->scale;
+    SQLUBIGINT v;
+
+    memcpy(mag, dec->mag, sizeof(mag));
+    for (; scale > 9; scale -= 9)
+	dec_divmod(mag, dec_pow10[9]);
+    if (scale > 0)
+	dec_divmod(mag, dec_pow10[scale]);
+    v = ((SQLUBIGINT) mag[1] << 32) | mag[0];
+    if (mag[2] || mag[3] || v > ((SQLUBIGINT) 1 << 63) - 1 + dec->negative)
+	v = ((SQLUBIGINT) 1 << 63) - 1 + dec->negative;
+    return dec->negative ? (SQLBIGINT) (0 - v) : (SQLBIGINT) v;
+}
+
+
+/*
+ *	The nearest double.  Magnitudes a double holds exactly, with up to
+ *	22 decimals, take one correctly rounded division; anything else goes
+ *	through the text form.
+ */
+double CD_decimal_to_double(const CD_Decimal * dec)
+{
+    static const double pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    char buf[48];
+    double v;
+
+    if (!dec->mag[3] && !dec->mag[2] && dec->mag[1] < (1U << 21)
+	&& dec->scale <= 22)
+    {
+	v = (double) (((SQLUBIGINT) dec->mag[1] << 32) | dec->mag[0])
+	    / pow10[dec->scale];
+	return dec->negative ? -v : v;
+    }
+    CD_decimal_to_text(dec, buf);
+    return vx_strtod(buf, NULL);
+}
+
+
+/*
+ *	Writes the value with exactly dec->scale decimals and at least one
+ *	digit before the point.  buf needs room for 48 chars; the length is
+ *	returned.
+ */
+int CD_decimal_to_text(const CD_Decimal * dec, char *buf)
+{
+    char digits[48], *p = digits + sizeof(digits), *out = buf;
+    UInt4 mag[4];
+    int n = 0, i;
+
+    memcpy(mag, dec->mag, sizeof(mag));
+    do
+    {
+	UInt4 rem = dec_divmod(mag, dec_pow10[9]);
+
+	for (i = 0; i < 9; i++, rem /= 10)
+	    *--p = '0' + rem % 10;
+	n += 9;
+    } while (mag[0] || mag[1] || mag[2] || mag[3] || n <= dec->scale);
+    while (n > dec->scale + 1 && *p == '0')
+    {
+	p++;
+	n--;
+    }
+
+    if (dec->negative)
+	*out++ = '-';
+    memcpy(out, p, n - dec->scale);
+    out += n - dec->scale;
+    if (dec->scale > 0)
+    {
+	*out++ = '.';
+	memcpy(out, p + n - dec->scale, dec->scale);
+	out += dec->scale;
+    }
+    *out = '\0';
+    return (int) (out - buf);
+}
@@ -0,0 +1,111 @@
+/* File:			coldata.h
+ *
+ * Description:		See "coldata.cc"
+ *
+ * Comments:		See "notice.txt" for copyright and license information.
+ *
+ */
+
+#ifndef __COLDATA_H__
+#define __COLDATA_H__
+
+#include "psqlodbc.h"
+
+/*	How the values of one column are kept */
+typedef enum
+{
+	CD_TEXT = 0,		/* NUL terminated, in the blob area */
+	CD_BINARY,		/* raw bytes, in the blob area */
+	CD_INT8,
+	CD_INT4,
+	CD_INT2,
+	CD_UINT1,
+	CD_BOOL,
+	CD_DOUBLE,
+	CD_DATETIME,
+	CD_DECIMAL
+} ColumnDataKind;
+
+/*	versaplexd's DateTime: seconds since the unix epoch, plus usecs */
+typedef struct
+{
+	SQLBIGINT	secs;
+	Int4		usecs;
+} CD_DateTime;
+
+/*
+ *	versaplexd's Decimal, parsed once from its string form: a 128-bit
+ *	magnitude to be divided by 10^scale.  That holds any 38 digits,
+ *	which is as many as SQL Server has.
+ */
+#define CD_DECIMAL_DIGITS	38
+typedef struct
+{
+	UInt4		mag[4];		/* least significant word first */
+	UCHAR		scale;		/* digits after the decimal point */
+	UCHAR		precision;	/* digits in all */
+	UCHAR		negative;
+} CD_Decimal;
+
+struct ColumnData_
+{
+	ColumnDataKind	kind;
+	Int2		width;		/* bytes per entry in values */
+	char		*values;	/* fixed width values, or for TEXT/BINARY
+					 * the end offset of each row's blob */
+	UCHAR		*valid;		/* bit set for each non-NULL row; NULL
+					 * until the column's first NULL */
+	char		*blob;		/* packed TEXT/BINARY data */
+	SQLULEN		blob_used;
+	SQLULEN		blob_allocated;
+};
+
+/*
+ *	A column-major cache of a result's rows, holding each value in its
+ *	native form so that SQLFetch/SQLGetData needn't parse them back out
+ *	of strings.
+ */
+struct ColumnDataClass_
+{
+	Int2		num_fields;
+	SQLULEN		num_rows;
+	SQLULEN		rows_allocated;
+	struct ColumnData_ *cols;
+};
+
+#define CD_get_num_rows(self)		(self->num_rows)
+#define CD_get_kind(self, col)		(self->cols[col].kind)
+#define CD_value_ptr(self, col, row)	(self->cols[col].values + (row) * self->cols[col].width)
+#define CD_get_int8(self, col, row)	(*(SQLBIGINT *) CD_value_ptr(self, col, row))
+#define CD_get_int4(self, col, row)	(*(Int4 *) CD_value_ptr(self, col, row))
+#define CD_get_int2(self, col, row)	(*(Int2 *) CD_value_ptr(self, col, row))
+#define CD_get_uint1(self, col, row)	(*(UCHAR *) CD_value_ptr(self, col, row))
+#define CD_get_double(self, col, row)	(*(double *) CD_value_ptr(self, col, row))
+#define CD_get_datetime(self, col, row)	((const CD_DateTime *) CD_value_ptr(self, col, row))
+#define CD_get_decimal(self, col, row)	((const CD_Decimal *) CD_value_ptr(self, col, row))
+#define CD_is_null(self, col, row)	(NULL != self->cols[col].valid && 0 == (self->cols[col].valid[(row) >> 3] & (1 << ((row) & 7))))
+
+ColumnDataClass *CD_Constructor(const ColumnInfoClass *fields);
+void		CD_Destructor(ColumnDataClass *self);
+ColumnDataKind	CD_kind_from_type(OID type);
+BOOL		CD_reserve_rows(ColumnDataClass *self, SQLULEN num_rows);
+BOOL		CD_add_row(ColumnDataClass *self);
+
+/*	Values must be set on the last row added */
+void		CD_set_integer(ColumnDataClass *self, int col, SQLBIGINT value);
+void		CD_set_double(ColumnDataClass *self, int col, double value);
+void		CD_set_datetime(ColumnDataClass *self, int col, SQLBIGINT secs, Int4 usecs);
+BOOL		CD_set_decimal(ColumnDataClass *self, int col, const char *str);
+BOOL		CD_set_blob(ColumnDataClass *self, int col, const void *data, size_t len);
+BOOL		CD_set_null(ColumnDataClass *self, int col);
+
+BOOL		CD_is_integer(const ColumnDataClass *self, int col);
+SQLBIGINT	CD_get_integer(const ColumnDataClass *self, int col, SQLULEN row);
+const char	*CD_get_blob(const ColumnDataClass *self, int col, SQLULEN row, SQLLEN *len);
+
+BOOL		CD_parse_decimal(const char *str, CD_Decimal *dec);
+SQLBIGINT	CD_decimal_to_integer(const CD_Decimal *dec);
+double		CD_decimal_to_double(const CD_Decimal *dec);
+int		CD_decimal_to_text(const CD_Decimal *dec, char *buf);
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * Description:	This module contains routines for keeping the SQLColumns
+ *		results that parse_statement() looks up in a hashed,
+ *		bounded per-connection LRU cache (see "colicache.h").
+ */
+
+#include "colicache.h"
+#include "connection.h"
+#include "descriptor.h"
+#include "qresult.h"
+#include "misc.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void COLI_release(COL_INFO * coli)
+{
+    if (!coli || --coli->refcount > 0)
+	return;
+    if (coli->result)
+	QR_Destructor(coli->result);
+    NULL_THE_NAME(coli->schema_name);
+    NULL_THE_NAME(coli->table_name);
+    free(coli);
+}
+
+
+ColInfoCacheClass *CIC_Constructor(int max_count)
+{
+    ColInfoCacheClass *rv;
+
+    rv = (ColInfoCacheClass *) calloc(sizeof(ColInfoCacheClass), 1);
+    if (!rv)
+	return NULL;
+    if (!LRU_init(&rv->lru))
+    {
+	free(rv);
+	return NULL;
+    }
+    rv->max_count = max_count > 0 ? max_count : COLI_DEFAULT_SIZE;
+
+    return rv;
+}
+
+
+static void CIC_remove(ColInfoCacheClass * self, COL_INFO * coli)
+{
+    LRU_remove(&self->lru, &coli->lru);
+    COLI_release(coli);
+}
+
+
+/*	Drop the cache's references to everything, keeping the counts */
+void CIC_clear(ColInfoCacheClass * self)
+{
+    if (!self)
+	return;
+    while (self->lru.tail)
+	CIC_remove(self, (COL_INFO *) self->lru.tail);
+}
+
+
+void CIC_Destructor(ColInfoCacheClass * self)
+{
+    if (!self)
+	return;
+    mylog("CIC_Destructor: %d tables, %u hits, %u misses, %u evicted\n",
+	  self->lru.count, self->hits, self->misses, self->evicted);
+    CIC_clear(self);
+    LRU_free(&self->lru);
+    free(self);
+}
+
+
+/*	Count a hit on coli, and take a reference to it for the caller */
+static COL_INFO *CIC_hit(ColInfoCacheClass * self, COL_INFO * coli)
+{
+    self->hits++;
+    LRU_touch(&self->lru, &coli->lru);
+    coli->refcount++;
+    return coli;
+}
+
+
+/*
+ *	Find table's entry, in schema (where "" means no schema), or in any
+ *	schema at all if schema is NULL.  The caller gets a reference, which
+ *	it must COLI_release() (or hand to a TABLE_INFO, which does).  A
+ *	caller may look in several schemas for one table, so it's up to it
+ *	to count a miss once it has given up.
+ */
+COL_INFO *CIC_find(ColInfoCacheClass * self, const char *schema,
+		   const char *table)
+{
+    UInt4 hash = LRU_hash_nocase(table);
+    LRUEntry *entry;
+    COL_INFO *coli;
+
+    for (entry = LRU_bucket(&self->lru, hash); entry; entry = entry->hnext)
+    {
+	coli = (COL_INFO *) entry;
+	if (entry->hash == hash
+	    && !stricmp(SAFE_NAME(coli->table_name), table)
+	    && (!schema || !stricmp(SAFE_NAME(coli->schema_name), schema)))
+	    return CIC_hit(self, coli);
+    }
+    return NULL;
+}
+
+
+/*
+ *	Only PostgreSQL-style callers know a table by its oid, and never
+ *	for many tables at once, so a walk of the LRU list is good enough.
+ */
+COL_INFO *CIC_find_oid(ColInfoCacheClass * self, OID table_oid)
+{
+    LRUEntry *entry;
+
+    for (entry = self->lru.head; entry; entry = entry->next)
+    {
+	if (((COL_INFO *) entry)->table_oid == table_oid)
+	    return CIC_hit(self, (COL_INFO *) entry);
+    }
+    return NULL;
+}
+
+
+/*
+ *	Add coli (whose table_name must be set), with a reference of the
+ *	cache's own.  When the cache is full the least recently used table
+ *	is dropped.
+ */
+void CIC_add(ColInfoCacheClass * self, COL_INFO * coli)
+{
+    COL_INFO *oldest;
+
+    while (self->lru.count >= self->max_count && self->lru.tail)
+    {
+	oldest = (COL_INFO *) self->lru.tail;
+	mylog("Dropping col_info table='%s'\n",
+	      PRINT_NAME(oldest->table_name));
+	self->evicted++;
+	CIC_remove(self, oldest);
+    }
+    LRU_add(&self->lru, &coli->lru,
+	    LRU_hash_nocase(SAFE_NAME(coli->table_name)));
+    coli->refcount++;
+}
+
+
+/*
+ *	The rest are for parse_statement() and friends, which don't hold
+ *	the connection's lock.
+ */
+COL_INFO *CC_find_col_info(ConnectionClass * conn, const char *schema,
+			   const char *table)
+{
+    COL_INFO *coli;
+
+    CONNLOCK_ACQUIRE(conn);
+    coli = CIC_find(conn->col_info_cache, schema, table);
+    CONNLOCK_RELEASE(conn);
+
+    return coli;
+}
+
+
+COL_INFO *CC_find_col_info_oid(ConnectionClass * conn, OID table_oid)
+{
+    COL_INFO *coli;
+
+    CONNLOCK_ACQUIRE(conn);
+    coli = CIC_find_oid(conn->col_info_cache, table_oid);
+    CONNLOCK_RELEASE(conn);
+
+    return coli;
+}
+
+
+void CC_add_col_info(ConnectionClass * conn, COL_INFO * coli)
+{
+    CONNLOCK_ACQUIRE(conn);
+    CIC_add(conn->col_info_cache, coli);
+    CONNLOCK_RELEASE(conn);
+}
+
+
+void CC_release_col_info(ConnectionClass * conn, COL_INFO * coli)
+{
+    if (!coli)
+	return;
+    CONNLOCK_ACQUIRE(conn);
+    COLI_release(coli);
+    CONNLOCK_RELEASE(conn);
+}
+
+
+void CC_col_info_missed(ConnectionClass * conn)
+{
+    CONNLOCK_ACQUIRE(conn);
+    conn->col_info_cache->misses++;
+    CONNLOCK_RELEASE(conn);
+}
+
+
+void CC_get_col_info_stats(ConnectionClass * conn, int *count,
+			   UInt4 * hits, UInt4 * misses, UInt4 * evicted)
+{
+    ColInfoCacheClass *self = conn->col_info_cache;
+
+    CONNLOCK_ACQUIRE(conn);
+    if (count)
+	*count = self->lru.count;
+    if (hits)
+	*hits = self->hits;
+    if (misses)
+	*misses = self->misses;
+    if (evicted)
+	*evicted = self->evicted;
+    CONNLOCK_RELEASE(conn);
+}
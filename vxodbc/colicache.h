@@ -0,0 +1,53 @@
+/* File:			colicache.h
+ *
+ * Description:		See "colicache.cc"
+ *
+ * Comments:		See "notice.txt" for copyright and license information.
+ *
+ */
+
+#ifndef __COLICACHE_H__
+#define __COLICACHE_H__
+
+#include "psqlodbc.h"
+#include "lrucache.h"
+
+/*
+ *	A connection's SQLColumns results for the tables its statements have
+ *	been parsed against (see struct col_info in "connection.h"), hashed by
+ *	table name and kept in LRU order so there's a limit on how many
+ *	there are.  Statements' TABLE_INFOs hold references to the entries
+ *	they use, so an entry dropped from the cache lives on until they let
+ *	go.  All changes happen under the connection's CONNLOCK.
+ */
+struct ColInfoCacheClass_
+{
+	LRUCache	lru;		/* by hash of the lowercased table name */
+	int		max_count;
+	UInt4		hits;
+	UInt4		misses;
+	UInt4		evicted;
+};
+
+#define	COLI_DEFAULT_SIZE	256
+
+ColInfoCacheClass *CIC_Constructor(int max_count);
+void		CIC_Destructor(ColInfoCacheClass *self);
+void		CIC_clear(ColInfoCacheClass *self);
+COL_INFO	*CIC_find(ColInfoCacheClass *self, const char *schema,
+			  const char *table);
+COL_INFO	*CIC_find_oid(ColInfoCacheClass *self, OID table_oid);
+void		CIC_add(ColInfoCacheClass *self, COL_INFO *coli);
+void		COLI_release(COL_INFO *coli);
+
+COL_INFO	*CC_find_col_info(ConnectionClass *conn, const char *schema,
+				  const char *table);
+COL_INFO	*CC_find_col_info_oid(ConnectionClass *conn, OID table_oid);
+void		CC_add_col_info(ConnectionClass *conn, COL_INFO *coli);
+void		CC_release_col_info(ConnectionClass *conn, COL_INFO *coli);
+void		CC_col_info_missed(ConnectionClass *conn);
+void		CC_get_col_info_stats(ConnectionClass *conn, int *count,
+				      UInt4 *hits, UInt4 *misses,
+				      UInt4 *evicted);
+
+#endif
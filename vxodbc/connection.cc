@@ -16,6 +16,10 @@
 #include "environ.h"
 #include "statement.h"
 #include "qresult.h"
+#include "prepcache.h"
+#include "catcache.h"
+#include "colicache.h"
+#include "vxhelpers.h"
 #include "dlg_specific.h"
 
 #include "multibyte.h"
@@ -126,6 +130,7 @@ PGAPI_Connect(HDBC hdbc,
 
     /* fill in any defaults */
     getDSNdefaults(ci);
+    CC_size_catalog(conn);
 
     qlog("conn = %p, %s(DSN='%s', UID='%s', PWD='%s')\n", conn, func,
 	 ci->dsn, ci->username, ci->password ? "xxxxx" : "");
@@ -160,7 +165,8 @@ RETCODE SQL_API PGAPI_Disconnect(HDBC hdbc)
 {
     ConnectionClass *conn = (ConnectionClass *) hdbc;
     CSTR func = "PGAPI_Disconnect";
-
+    int num_tables;
+    UInt4 hits, misses, evicted;
 
     mylog("%s: entering...\n", func);
 
@@ -179,6 +185,10 @@ RETCODE SQL_API PGAPI_Disconnect(HDBC hdbc)
 	return SQL_ERROR;
     }
 
+    CC_get_col_info_stats(conn, &num_tables, &hits, &misses, &evicted);
+    qlog("conn=%p, column info cache: %d tables, %u hits, %u misses,"
+	 " %u evicted\n", conn, num_tables, hits, misses, evicted);
+
     logs_on_off(-1, true, true);
     mylog("%s: about to CC_cleanup\n", func);
 
@@ -228,6 +238,7 @@ void CC_conninfo_init(ConnInfo * conninfo)
     conninfo->disallow_premature = -1;
     conninfo->allow_keyset = -1;
     conninfo->lf_conversion = -1;
+    conninfo->prefetch_columns = -1;
     conninfo->true_is_minus1 = -1;
     conninfo->int8_as = -101;
     conninfo->bytea_as_longvarbinary = -1;
@@ -299,9 +310,17 @@ ConnectionClass *CC_Constructor()
 
 	rv->num_descs = STMT_INCREMENT;
 
+	rv->prepared = PC_Constructor(PC_DEFAULT_SIZE);
+	if (!rv->prepared)
+	    goto cleanup;
+	rv->catalog = CAT_Constructor(CAT_DEFAULT_SIZE);
+	if (!rv->catalog)
+	    goto cleanup;
+	rv->col_info_cache = CIC_Constructor(COLI_DEFAULT_SIZE);
+	if (!rv->col_info_cache)
+	    goto cleanup;
+
 	// rv->ncursors = 0;
-	// rv->ntables = 0;
-	// rv->col_info = NULL;
 
 	// rv->translation_option = 0;
 	// rv->translation_handle = NULL;
@@ -379,6 +398,13 @@ char CC_Destructor(ConnectionClass * self)
     }
     mylog("after free statement holders\n");
 
+    PC_Destructor(self->prepared);
+    self->prepared = NULL;
+    CAT_Destructor(self->catalog);
+    self->catalog = NULL;
+    CIC_Destructor(self->col_info_cache);
+    self->col_info_cache = NULL;
+
     NULL_THE_NAME(self->schemaIns);
     NULL_THE_NAME(self->tableIns);
     if (self->__error_message)
@@ -536,23 +562,11 @@ char CC_cleanup(ConnectionClass * self)
 	self->server_encoding = NULL;
     }
     reset_current_schema(self);
-    /* Free cached table info */
-    if (self->col_info)
-    {
-	for (i = 0; i < self->ntables; i++)
-	{
-	    if (self->col_info[i]->result)	/* Free the SQLColumns result structure */
-		QR_Destructor(self->col_info[i]->result);
-
-	    NULL_THE_NAME(self->col_info[i]->schema_name);
-	    NULL_THE_NAME(self->col_info[i]->table_name);
-	    free(self->col_info[i]);
-	}
-	free(self->col_info);
-	self->col_info = NULL;
-    }
-    self->ntables = 0;
-    self->coli_allocated = 0;
+    /*
+     * Free cached table info; the statements that were using any of it
+     * are gone already.
+     */
+    CIC_clear(self->col_info_cache);
     if (self->num_discardp > 0 && self->discardp)
     {
 	for (i = 0; i < self->num_discardp; i++)
@@ -564,6 +578,13 @@ char CC_cleanup(ConnectionClass * self)
 	free(self->discardp);
 	self->discardp = NULL;
     }
+    if (self->queries)
+    {
+	delete self->queries;
+	self->queries = NULL;
+    }
+    /* the next connection might not even be to the same database */
+    CAT_clear(self->catalog);
     if (self->dbus)
         WVRELEASE(self->dbus);
 
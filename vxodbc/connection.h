@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "descriptor.h"
+#include "lrucache.h"
 
 #if defined (POSIX_MULTITHREAD_SUPPORT)
 #include <pthread.h>
@@ -265,6 +266,8 @@ typedef struct
 	char 		dbus_moniker[MEDIUM_REGISTRY_LEN];
 	char		sslmode[SMALL_REGISTRY_LEN];
 	char		onlyread[SMALL_REGISTRY_LEN];
+	char		catalog_cache_ttl[SMALL_REGISTRY_LEN];
+	char		catalog_cache_size[SMALL_REGISTRY_LEN];
 	char		fake_oid_index[SMALL_REGISTRY_LEN];
 	char		show_oid_column[SMALL_REGISTRY_LEN];
 	char		row_versioning[SMALL_REGISTRY_LEN];
@@ -286,6 +289,7 @@ typedef struct
 	signed char	bde_environment;
 	signed char	fake_mss;
 	signed char	cvt_null_date_string;
+	signed char	prefetch_columns;
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	signed char	xa_opt;
 #endif /* _HANDLE_ENLIST_IN_DTC_ */
@@ -344,11 +348,13 @@ typedef struct
 /*	This is used to store cached table information in the connection */
 struct col_info
 {
+	LRUEntry	lru;		/* the cache's; must come first */
 	Int2		num_reserved_cols;
 	QResultClass	*result;
 	pgNAME		schema_name;
 	pgNAME		table_name;
 	OID		table_oid;
+	int		refcount;	/* the cache's and TABLE_INFOs' */
 };
 #define col_info_initialize(coli) (memset(coli, 0, sizeof(COL_INFO)))
 
@@ -369,6 +375,7 @@ typedef BOOL (FAR WINAPI * DriverToDataSourceProc) (UDWORD, SWORD, PTR,
 		SWORD FAR *);
     
 class WvDBusConn;
+class VxQueryTable;
 
 /*******	The Connection handle	************/
 struct ConnectionClass_
@@ -376,6 +383,10 @@ struct ConnectionClass_
 	EnvironmentClass *henv;		/* environment this connection was
 					 * created on */
         WvDBusConn      *dbus;
+	VxQueryTable	*queries;	/* queries still getting rows over dbus */
+	PreparedCacheClass *prepared;	/* recently parsed statements */
+	CatalogCacheClass *catalog;	/* recent SQLTables etc. results */
+	ColInfoCacheClass *col_info_cache; /* parsed tables' SQLColumns */
 	SQLUINTEGER	login_timeout;
 	StatementOptions stmtOptions;
 	ARDFields	ardOptions;
@@ -388,9 +399,6 @@ struct ConnectionClass_
 	StatementClass	**stmts;
 	Int2		num_stmts;
 	Int2		ncursors;
-	Int2		coli_allocated;
-	Int2		ntables;
-	COL_INFO	**col_info;
 	long		translation_option;
 	HINSTANCE	translation_handle;
 	DataSourceToDriverProc DataSourceToDriver;
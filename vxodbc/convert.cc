@@ -9,9 +9,7 @@
 /* Multibyte support  Eiji Tokuya	2001-03-15	*/
 
 #include "convert.h"
-#ifdef	WIN32
 #include <float.h>
-#endif				/* WIN32 */
 
 #include <stdio.h>
 #include <string.h>
@@ -20,13 +18,13 @@
 #include "multibyte.h"
 
 #include <time.h>
-#ifdef HAVE_LOCALE_H
 #include <locale.h>
-#endif
 #include <math.h>
 #include <stdlib.h>
 #include "statement.h"
 #include "qresult.h"
+#include "prepcache.h"
+#include "colicache.h"
 #include "bind.h"
 #include "pgtypes.h"
 #include "connection.h"
@@ -50,6 +48,7 @@ CSTR MINFINITY_STRING = "-Infinity";
 
 static int conv_from_octal(const UCHAR * s);
 static SQLLEN pg_bin2hex(UCHAR * src, UCHAR * dst, SQLLEN length);
+static const char *hextbl = "0123456789ABCDEF";
 
 /*---------
  *			A Guide for date/time/timestamp conversions
@@ -207,6 +206,346 @@ copy_and_convert_field_bindinfo(StatementClass * stmt, OID field_type,
 						offset));
 }
 
+/*
+ *	The "C" locale, for number conversions that mustn't depend on the
+ *	application's.  Nothing here ever calls setlocale(): that's process
+ *	wide, and two threads fetching at once would trip over each other.
+ */
+#ifdef	WIN32
+static _locale_t vx_c_locale(void)
+{
+    static _locale_t loc = _create_locale(LC_ALL, "C");
+
+    return loc;
+}
+#else
+static locale_t vx_c_locale(void)
+{
+    static locale_t loc = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+
+    return loc;
+}
+#endif				/* WIN32 */
+
+/*
+ *	strtod(), always with '.' as the decimal point.
+ */
+double vx_strtod(const char *str, char **endptr)
+{
+#ifdef	WIN32
+    return _strtod_l(str, endptr, vx_c_locale());
+#else
+    return strtod_l(str, endptr, vx_c_locale());
+#endif				/* WIN32 */
+}
+
+/*
+ *	vx_format_double() finds the digits with Loitsch's Grisu2, which
+ *	works in 64-bit fixed point and never needs to check its answer:
+ *	the digits always read back as the same number, and are the shortest
+ *	that do in all but a tiny fraction of cases (which get one more).
+ *	A DiyFp is f * 2^e.
+ */
+struct DiyFp
+{
+    SQLUBIGINT f;
+    int e;
+};
+
+static DiyFp diy_make(SQLUBIGINT f, int e)
+{
+    DiyFp r;
+
+    r.f = f;
+    r.e = e;
+    return r;
+}
+
+/* the top 64 bits of the product, rounded */
+static DiyFp diy_mul(DiyFp x, DiyFp y)
+{
+    const SQLUBIGINT M32 = 0xFFFFFFFFU;
+    SQLUBIGINT a = x.f >> 32, b = x.f & M32, c = y.f >> 32, d = y.f & M32;
+    SQLUBIGINT ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    SQLUBIGINT tmp = (bd >> 32) + (ad & M32) + (bc & M32) + (1U << 31);
+
+    return diy_make(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32),
+		    x.e + y.e + 64);
+}
+
+static DiyFp diy_normalize(DiyFp x)
+{
+    while (!(x.f & ((SQLUBIGINT) 1 << 63)))
+    {
+	x.f <<= 1;
+	x.e--;
+    }
+    return x;
+}
+
+/*
+ *	10^k for k = -348, -340, ... 340, each as a 64-bit significand
+ *	(rounded, top bit set) and binary exponent.
+ */
+static const SQLUBIGINT grisu_pow10_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+static const short grisu_pow10_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066
+};
+
+static const UInt4 grisu_pow10_32[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+};
+
+/*
+ *	Nudge the last digit down while that brings the digits closer to
+ *	the exact value and they stay inside the rounding interval.
+ */
+static void grisu_round(char *buf, int len, SQLUBIGINT delta,
+			SQLUBIGINT rest, SQLUBIGINT ten_kappa,
+			SQLUBIGINT wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa
+	   && (rest + ten_kappa < wp_w
+	       || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+	buf[len - 1]--;
+	rest += ten_kappa;
+    }
+}
+
+/*
+ *	The digits of the value w, anywhere in (mp - delta, mp), go in buf;
+ *	the result is digits * 10^*K.
+ */
+static int grisu_digits(DiyFp w, DiyFp mp, SQLUBIGINT delta, char *buf,
+			int *K)
+{
+    DiyFp one = diy_make((SQLUBIGINT) 1 << -mp.e, mp.e);
+    SQLUBIGINT wp_w = mp.f - w.f;
+    UInt4 p1 = (UInt4) (mp.f >> -one.e);
+    SQLUBIGINT p2 = mp.f & (one.f - 1);
+    int kappa, len = 0;
+
+    for (kappa = 10; kappa > 1 && p1 < grisu_pow10_32[kappa - 1]; kappa--)
+	;
+    while (kappa > 0)
+    {
+	UInt4 d = p1 / grisu_pow10_32[kappa - 1];
+	SQLUBIGINT rest;
+
+	p1 %= grisu_pow10_32[kappa - 1];
+	if (d || len)
+	    buf[len++] = '0' + d;
+	kappa--;
+	rest = ((SQLUBIGINT) p1 << -one.e) + p2;
+	if (rest <= delta)
+	{
+	    *K += kappa;
+	    grisu_round(buf, len, delta, rest,
+			(SQLUBIGINT) grisu_pow10_32[kappa] << -one.e, wp_w);
+	    return len;
+	}
+    }
+    for (;;)
+    {
+	char d;
+
+	p2 *= 10;
+	delta *= 10;
+	d = (char) (p2 >> -one.e);
+	if (d || len)
+	    buf[len++] = '0' + d;
+	p2 &= one.f - 1;
+	kappa--;
+	if (p2 < delta)
+	{
+	    *K += kappa;
+	    grisu_round(buf, len, delta, p2, one.f,
+			-kappa < 9 ? wp_w * grisu_pow10_32[-kappa] : 0);
+	    return len;
+	}
+    }
+}
+
+/*
+ *	The shortest digits for f * 2^e, a number whose significand has
+ *	'bits' bits (53 for a double, 24 for a float): anything strictly
+ *	between it and its neighbours reads back as it.
+ */
+static int grisu2(SQLUBIGINT f, int e, int bits, char *buf, int *K)
+{
+    SQLUBIGINT hidden = (SQLUBIGINT) 1 << (bits - 1);
+    DiyFp v = diy_make(f, e), plus, minus, c, w, wp, wm;
+    double dk;
+    int k, index;
+
+    plus = diy_normalize(diy_make((f << 1) + 1, e - 1));
+    minus = f == hidden ? diy_make((f << 2) - 1, e - 2)
+	: diy_make((f << 1) - 1, e - 1);
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    /* a power of ten that brings plus's exponent into [-60, -32] */
+    dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+    k = (int) dk;
+    if (dk - k > 0.0)
+	k++;
+    index = (k >> 3) + 1;
+    *K = -(-348 + index * 8);
+    c = diy_make(grisu_pow10_f[index], grisu_pow10_e[index]);
+
+    w = diy_mul(diy_normalize(v), c);
+    wp = diy_mul(plus, c);
+    wm = diy_mul(minus, c);
+    wm.f++;
+    wp.f--;
+    return grisu_digits(w, wp, wp.f - wm.f, buf, K);
+}
+
+/*
+ *	Writes the shortest decimal form of value (as a float, if is_float)
+ *	that reads back as the same number, laid out the way "%.*g" would
+ *	with at least FLT_DIG or DBL_DIG of precision, and with '.' as the
+ *	decimal point whatever the locale.  buf needs room for 32 chars; the
+ *	length is returned.
+ */
+int vx_format_double(double value, BOOL is_float, char *buf)
+{
+    char digits[20];
+    char *p = buf;
+    SQLUBIGINT f;
+    int e, n, K, exp10, i;
+
+    if (value != value)
+    {
+	strcpy(buf, "nan");
+	return 3;
+    }
+    if (value < 0 || (0 == value && 1 / value < 0))
+    {
+	*p++ = '-';
+	value = -value;
+    }
+    if (value > DBL_MAX || (is_float && (float) value > FLT_MAX))
+    {
+	strcpy(p, "inf");
+	return (int) (p - buf) + 3;
+    }
+    if (0 == value)
+    {
+	strcpy(p, "0");
+	return (int) (p - buf) + 1;
+    }
+
+    if (is_float)
+    {
+	float fv = (float) value;
+	UInt4 u;
+
+	memcpy(&u, &fv, sizeof(u));
+	f = u & 0x7FFFFF;
+	e = (int) (u >> 23) & 0xFF;
+	if (e)
+	    f |= 0x800000;
+	e = (e ? e : 1) - 127 - 23;
+	n = grisu2(f, e, 24, digits, &K);
+    }
+    else
+    {
+	memcpy(&f, &value, sizeof(f));
+	e = (int) (f >> 52) & 0x7FF;
+	f &= ((SQLUBIGINT) 1 << 52) - 1;
+	if (e)
+	    f |= (SQLUBIGINT) 1 << 52;
+	e = (e ? e : 1) - 1023 - 52;
+	n = grisu2(f, e, 53, digits, &K);
+    }
+
+    /* value is d.ddd * 10^exp10; %g only uses that form for big exponents */
+    exp10 = n + K - 1;
+    if (exp10 < -4 || exp10 >= (n > (is_float ? FLT_DIG : DBL_DIG) ? n
+				: (is_float ? FLT_DIG : DBL_DIG)))
+    {
+	*p++ = digits[0];
+	if (n > 1)
+	{
+	    *p++ = '.';
+	    memcpy(p, digits + 1, n - 1);
+	    p += n - 1;
+	}
+	*p++ = 'e';
+	*p++ = exp10 < 0 ? '-' : '+';
+	if (exp10 < 0)
+	    exp10 = -exp10;
+	if (exp10 >= 100)
+	    *p++ = '0' + exp10 / 100;
+	*p++ = '0' + exp10 / 10 % 10;
+	*p++ = '0' + exp10 % 10;
+    }
+    else if (exp10 < 0)
+    {
+	*p++ = '0';
+	*p++ = '.';
+	for (i = exp10 + 1; i < 0; i++)
+	    *p++ = '0';
+	memcpy(p, digits, n);
+	p += n;
+    }
+    else
+    {
+	for (i = 0; i <= exp10; i++)
+	    *p++ = i < n ? digits[i] : '0';
+	if (n > exp10 + 1)
+	{
+	    *p++ = '.';
+	    memcpy(p, digits + exp10 + 1, n - exp10 - 1);
+	    p += n - exp10 - 1;
+	}
+    }
+    *p = '\0';
+    return (int) (p - buf);
+}
+
 static double get_double_value(const char *str)
 {
     if (stricmp(str, NAN_STRING) == 0)
@@ -215,7 +554,113 @@ static double get_double_value(const char *str)
 	return INFINITY;
     else if (stricmp(str, MINFINITY_STRING) == 0)
 	return -INFINITY;
-    return atof(str);
+    return vx_strtod(str, NULL);
+}
+
+/*
+ *	The date in the proleptic Gregorian calendar 'days' days after
+ *	1970-01-01, without going through time_t or the C library.
+ */
+static void vx_civil_from_days(long long days, int *y, int *m, int *d)
+{
+    days += 719468;
+    long long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = (unsigned) (days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+
+    *d = (int) (doy - (153 * mp + 2) / 5 + 1);
+    *m = (int) (mp < 10 ? mp + 3 : mp - 9);
+    *y = (int) (yoe + era * 400 + (*m <= 2));
+}
+
+/*
+ *	Break versaplexd's DateTime (seconds since the unix epoch, plus
+ *	microseconds) down into a SIMPLE_TIME.
+ */
+void vx_datetime_to_simple_time(long long secs, int usecs,
+				SIMPLE_TIME * std_time)
+{
+    // January 1, 1900, 00:00:00.
+    const long long sql_epoch = -2208988800LL;
+    const int seconds_per_day = 60*60*24;
+    long long days;
+    int tod;
+
+    if (secs >= sql_epoch && secs < sql_epoch + seconds_per_day)
+    {
+	// The value is a time of day for the SQL Epoch, aka a SQL time
+	// value.  These have always come out on the Unix Epoch; if it was
+	// a DateTime, it was going to be wrong anyway.
+	secs += -sql_epoch;
+    }
+
+    days = secs / seconds_per_day;
+    tod = (int) (secs % seconds_per_day);
+    if (tod < 0)
+    {
+	tod += seconds_per_day;
+	days--;
+    }
+    vx_civil_from_days(days, &std_time->y, &std_time->m, &std_time->d);
+    std_time->hh = tod / 3600;
+    std_time->mm = tod / 60 % 60;
+    std_time->ss = tod % 60;
+    // The server provides us with millionths of a second, but ODBC
+    // uses billionths
+    std_time->fr = usecs * 1000;
+}
+
+/*
+ *	Writes a DateTime the way SQL_C_CHAR gets it: "YYYY-MM-DD", plus
+ *	" HH:MM:SS" unless it's midnight.  buf needs room for 20 chars, and
+ *	the length (not counting the '\0') is returned.
+ */
+static int vx_format_datetime(const SIMPLE_TIME * st, char *buf)
+{
+    char *p = buf;
+    int y = st->y;
+
+    if (y < 0 || y > 9999)
+	return sprintf(buf, "%.4d-%.2d-%.2d %.2d:%.2d:%.2d", st->y, st->m,
+		       st->d, st->hh, st->mm, st->ss);
+#define PUT2(v)	(*p++ = '0' + (v) / 10, *p++ = '0' + (v) % 10)
+    PUT2(y / 100);
+    PUT2(y % 100);
+    *p++ = '-';
+    PUT2(st->m);
+    *p++ = '-';
+    PUT2(st->d);
+    if (st->hh || st->mm || st->ss)
+    {
+	*p++ = ' ';
+	PUT2(st->hh);
+	*p++ = ':';
+	PUT2(st->mm);
+	*p++ = ':';
+	PUT2(st->ss);
+    }
+#undef	PUT2
+    *p = '\0';
+    return (int) (p - buf);
+}
+
+/*
+ *	Reads back the "[secs,usecs]" form a DateTime takes as text.
+ */
+static void vx_parse_datetime(const char *value, long long *secs,
+			      int *usecs)
+{
+    char *end;
+
+    *secs = 0;
+    *usecs = 0;
+    if (*value == '[')
+	value++;
+    *secs = strtoll(value, &end, 10);
+    if (*end == ',')
+	*usecs = (int) strtol(end + 1, NULL, 10);
 }
 
 /*	This is called by SQLGetData() */
@@ -232,7 +677,6 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
     SQLLEN len = 0, copy_len = 0, needbuflen = 0;
     SIMPLE_TIME std_time;
     time_t stmt_t = SC_get_time(stmt);
-    struct tm *tim;
     SQLLEN pcbValueOffset, rgbValueOffset;
     char *rgbValueBindRow = NULL;
     SQLLEN *pcbValueBindRow = NULL, *pIndicatorBindRow = NULL;
@@ -241,7 +685,7 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
     int bind_size = opts->bind_size;
     int result = COPY_OK;
     ConnectionClass *conn = SC_get_conn(stmt);
-    BOOL changed, true_is_minus1 = FALSE;
+    BOOL changed, true_is_minus1 = FALSE, wdirect = FALSE;
     BOOL text_handling, localize_needed;
     const char *neut_str = value;
     char midtemp[2][32];
@@ -254,9 +698,6 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
     SQLWCHAR *allocbuf = NULL;
     ssize_t wstrlen;
 #endif				/* WIN_UNICODE_SUPPORT */
-#ifdef HAVE_LOCALE_H
-    char *saved_locale;
-#endif				/* HAVE_LOCALE_H */
 
     if (stmt->current_col >= 0)
     {
@@ -312,15 +753,8 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
     memset(&std_time, 0, sizeof(SIMPLE_TIME));
 
     /* Initialize current date */
-#ifdef	HAVE_GMTIME_R
-    struct tm tm;
-    tim = gmtime_r(&stmt_t, &tm);
-#else
-    tim = gmtime(&stmt_t);
-#endif				/* HAVE_GMTIME_R */
-    std_time.m = tim->tm_mon + 1;
-    std_time.d = tim->tm_mday;
-    std_time.y = tim->tm_year + 1900;
+    vx_civil_from_days(stmt_t / (60 * 60 * 24), &std_time.y, &std_time.m,
+		       &std_time.d);
 
     mylog
 	("copy_and_convert: field_type = %d, fctype = %d, value = '%s', cbValueMax=%d\n",
@@ -413,41 +847,8 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
     {
 	long long secs;
 	int usecs;
-	sscanf(value, "[%lld,%d]", &secs, &usecs);
-
-        // January 1, 1900, 00:00:00. Note: outside the range of 32-bit time_t.
-        long long sql_epoch = -2208988800LL; 
-        int seconds_per_day = 60*60*24;
-        if (secs >= sql_epoch && secs < sql_epoch + seconds_per_day)
-        {
-            // The value is a time of day for the SQL Epoch, aka a SQL time
-            // value.  Fudge it to the Unix Epoch, so gmtime() can deal
-            // with it on 32-bit systems.  If it was a DateTime, it was going
-            // to be wrong anyway.
-            secs += -sql_epoch;
-        }
-
-	// FIXME: This loses precision on 32-bit systems.
-	time_t secs_time_t = (time_t)secs;
-
-	struct tm *ptm;
-#ifdef	HAVE_GMTIME_R
-	struct tm tm;
-	if ((ptm = gmtime_r(&secs_time_t, &tm)) != NULL)
-#else
-	if ((ptm = gmtime(&secs_time_t)) != NULL)
-#endif				/* HAVE_GMTIME_R */
-	{
-	    std_time.y = ptm->tm_year + 1900;
-	    std_time.m = ptm->tm_mon + 1;
-	    std_time.d = ptm->tm_mday;
-	    std_time.hh = ptm->tm_hour;
-	    std_time.mm = ptm->tm_min;
-	    std_time.ss = ptm->tm_sec;
-            // The server provides us with millionths of a second, but ODBC
-            // uses billionths
-            std_time.fr = usecs * 1000;
-	}
+	vx_parse_datetime(value, &secs, &usecs);
+	vx_datetime_to_simple_time(secs, usecs, &std_time);
 	break;
     }
     case PG_TYPE_DATE:
@@ -622,18 +1023,7 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 	case VX_TYPE_DATETIME:
 	    len = 19;
 	    if (cbValueMax > len)
-	    {
-	        if (!std_time.hh && !std_time.mm &&!std_time.ss)
-  		    sprintf(rgbValueBindRow,
-			"%.4d-%.2d-%.2d", std_time.y,
-			std_time.m, std_time.d);
-                else
-		    sprintf(rgbValueBindRow,
-			"%.4d-%.2d-%.2d %.2d:%.2d:%.2d", std_time.y,
-			std_time.m, std_time.d, std_time.hh,
-			std_time.mm, std_time.ss);
-		len = strlen(rgbValueBindRow);
-            }
+		len = vx_format_datetime(&std_time, rgbValueBindRow);
 	    break;
 
 	case PG_TYPE_BOOL:
@@ -679,9 +1069,19 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 #ifdef	UNICODE_SUPPORT
 		if (fCType == SQL_C_WCHAR)
 		{
+		    SQLULEN bufcount =
+			cbValueMax > 0 ? cbValueMax / WCLEN : 0;
+
+		    /*
+		     * Straight into the caller's buffer; only if it
+		     * doesn't all fit (terminator included) is it done
+		     * again into ttlbuf, to be handed out in pieces.
+		     */
 		    len =
 			utf8_to_ucs2_lf(neut_str, SQL_NTS, lf_conv,
-					NULL, 0);
+					(SQLWCHAR *) rgbValueBindRow,
+					bufcount);
+		    wdirect = (SQLULEN) len < bufcount;
 		    len *= WCLEN;
 		    changed = TRUE;
 		} else
@@ -740,7 +1140,15 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 		default:
 		    needbuflen++;
 		}
-		if (changed || needbuflen > cbValueMax)
+		if (wdirect)
+		{
+		    if (pgdc->ttlbuf)
+		    {
+			free(pgdc->ttlbuf);
+			pgdc->ttlbuf = NULL;
+		    }
+		    ptr = rgbValueBindRow;
+		} else if (changed || needbuflen > cbValueMax)
 		{
 		    if (needbuflen > (SQLLEN) pgdc->ttlbuflen)
 		    {
@@ -815,8 +1223,6 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 
 	    if (cbValueMax > 0)
 	    {
-		BOOL already_copied = FALSE;
-
 		if (fCType == SQL_C_BINARY)
 		    copy_len = (len > cbValueMax) ? cbValueMax : len;
 		else
@@ -829,53 +1235,19 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 		    copy_len *= WCLEN;
 		}
 #endif				/* UNICODE_SUPPORT */
-#ifdef HAVE_LOCALE_H
-		switch (field_type)
-		{
-		case PG_TYPE_FLOAT4:
-		case PG_TYPE_FLOAT8:
-		case PG_TYPE_NUMERIC:
-		    {
-			struct lconv *lc;
-			char *new_string;
-			int i, j;
-
-			new_string = (char *)malloc(cbValueMax);
-			lc = localeconv();
-			for (i = 0, j = 0; ptr[i]; i++)
-			    if (ptr[i] == '.')
-			    {
-				strncpy(&new_string[j],
-					lc->decimal_point,
-					strlen(lc->decimal_point));
-				j += strlen(lc->decimal_point);
-			    } else
-				new_string[j++] = ptr[i];
-			new_string[j] = '\0';
-			strncpy_null(rgbValueBindRow, new_string,
-				     copy_len + 1);
-			free(new_string);
-			already_copied = TRUE;
-			break;
-		    }
-		}
-#endif				/* HAVE_LOCALE_H */
-		if (!already_copied)
-		{
-		    /* Copy the data */
+		/* Copy the data, unless it was converted in place */
+		if (ptr != rgbValueBindRow)
 		    memcpy(rgbValueBindRow, ptr, copy_len);
-		    /* Add null terminator */
+		/* Add null terminator */
 #ifdef	UNICODE_SUPPORT
-		    if (fCType == SQL_C_WCHAR)
-		    {
-			if (copy_len + WCLEN <= cbValueMax)
-			    memset(rgbValueBindRow + copy_len, 0,
-				   WCLEN);
-		    } else
+		if (fCType == SQL_C_WCHAR)
+		{
+		    if (copy_len + WCLEN <= cbValueMax)
+			memset(rgbValueBindRow + copy_len, 0, WCLEN);
+		} else
 #endif				/* UNICODE_SUPPORT */
-		    if (copy_len < cbValueMax)
-			rgbValueBindRow[copy_len] = '\0';
-		}
+		if (copy_len < cbValueMax)
+		    rgbValueBindRow[copy_len] = '\0';
 		/* Adjust data_left for next time */
 		if (stmt->current_col >= 0)
 		    pgdc->data_left -= copy_len;
@@ -1032,10 +1404,6 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 	    break;
 
 	case SQL_C_FLOAT:
-#ifdef HAVE_LOCALE_H
-	    saved_locale = strdup(setlocale(LC_ALL, NULL));
-	    setlocale(LC_ALL, "C");
-#endif				/* HAVE_LOCALE_H */
 	    len = 4;
 	    if (bind_size > 0)
 		*((SFLOAT *) rgbValueBindRow) =
@@ -1043,17 +1411,9 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 	    else
 		*((SFLOAT *) rgbValue + bind_row) =
 		    (float) get_double_value(neut_str);
-#ifdef HAVE_LOCALE_H
-	    setlocale(LC_ALL, saved_locale);
-	    free(saved_locale);
-#endif				/* HAVE_LOCALE_H */
 	    break;
 
 	case SQL_C_DOUBLE:
-#ifdef HAVE_LOCALE_H
-	    saved_locale = strdup(setlocale(LC_ALL, NULL));
-	    setlocale(LC_ALL, "C");
-#endif				/* HAVE_LOCALE_H */
 	    len = 8;
 	    if (bind_size > 0)
 		*((SDOUBLE *) rgbValueBindRow) =
@@ -1061,17 +1421,9 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 	    else
 		*((SDOUBLE *) rgbValue + bind_row) =
 		    get_double_value(neut_str);
-#ifdef HAVE_LOCALE_H
-	    setlocale(LC_ALL, saved_locale);
-	    free(saved_locale);
-#endif				/* HAVE_LOCALE_H */
 	    break;
 
 	case SQL_C_NUMERIC:
-#ifdef HAVE_LOCALE_H
-	    /* strcpy(saved_locale, setlocale(LC_ALL, NULL));
-	       setlocale(LC_ALL, "C"); not needed currently */
-#endif				/* HAVE_LOCALE_H */
 	    {
 		SQL_NUMERIC_STRUCT *ns;
 		int i, nlen, bit, hval, tv, dig, sta, olen;
@@ -1143,9 +1495,6 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 		if (hval && olen < SQL_MAX_NUMERIC_LEN - 1)
 		    ns->val[olen++] = hval;
 	    }
-#ifdef HAVE_LOCALE_H
-	    /* setlocale(LC_ALL, saved_locale); */
-#endif				/* HAVE_LOCALE_H */
 	    break;
 
 	case SQL_C_SSHORT:
@@ -1346,6 +1695,465 @@ copy_and_convert_field(StatementClass * stmt, OID field_type,
 }
 
 
+/*	This is called by SQLFetch() for results kept in a ColumnDataClass */
+int
+copy_and_convert_coldata_bindinfo(StatementClass * stmt, OID field_type,
+				  const ColumnDataClass * cd, SQLULEN row,
+				  int col)
+{
+    ARDFields *opts = SC_get_ARDF(stmt);
+    BindInfoClass *bic = &(opts->bindings[col]);
+    SQLULEN offset = opts->row_offset_ptr ? *opts->row_offset_ptr : 0;
+
+    SC_set_current_col(stmt, -1);
+    return copy_and_convert_coldata(stmt, field_type, cd, row, col,
+				    bic->returntype,
+				    (PTR) (bic->buffer + offset),
+				    bic->buflen, LENADDR_SHIFT(bic->used,
+							       offset),
+				    LENADDR_SHIFT(bic->indicator,
+						  offset));
+}
+
+/*
+ *	Binary data goes out as is for SQL_C_BINARY, or as hex digits for
+ *	SQL_C_CHAR, a piece at a time if SQLGetData is called repeatedly.
+ */
+static int
+copy_coldata_binary(GetDataClass * pgdc, const char *data, SQLLEN datalen,
+		    SQLSMALLINT fCType, char *rgbValueBindRow,
+		    SQLLEN cbValueMax, SQLLEN * pcbValueBindRow)
+{
+    BOOL hex;
+    SQLLEN len, done = 0, left, copy_len = 0, i;
+
+    switch (fCType)
+    {
+    case SQL_C_BINARY:
+	hex = FALSE;
+	break;
+    case SQL_C_CHAR:
+	hex = TRUE;
+	break;
+    default:
+	mylog("couldn't convert binary data to the type %d\n", fCType);
+	return COPY_UNSUPPORTED_CONVERSION;
+    }
+    len = hex ? datalen * 2 : datalen;
+    if (pgdc)
+    {
+	if (pgdc->data_left > 0)
+	    done = len - pgdc->data_left;
+	else
+	    pgdc->data_left = len;
+    }
+    left = len - done;
+    if (pcbValueBindRow)
+	*pcbValueBindRow = left;
+
+    if (rgbValueBindRow && cbValueMax > 0)
+    {
+	if (hex)
+	{
+	    copy_len = (left >= cbValueMax) ? (cbValueMax - 1) : left;
+	    for (i = 0; i < copy_len; i++)
+	    {
+		UCHAR chr = data[(done + i) / 2];
+
+		rgbValueBindRow[i] =
+		    hextbl[((done + i) % 2) ? (chr % 16) : (chr >> 4)];
+	    }
+	    rgbValueBindRow[copy_len] = '\0';
+	} else
+	{
+	    copy_len = (left > cbValueMax) ? cbValueMax : left;
+	    memcpy(rgbValueBindRow, data + done, copy_len);
+	}
+	if (pgdc)
+	    pgdc->data_left -= copy_len;
+    }
+
+    if (left > copy_len)
+	return COPY_RESULT_TRUNCATED;
+    if (pgdc)
+	pgdc->data_left = 0;
+    return COPY_OK;
+}
+
+/*
+ *	SQL_C_CHAR or SQL_C_BINARY of a cached TEXT value that needs no
+ *	converting.  Like copy_coldata_binary(), each SQLGetData call copies
+ *	the next slice straight out of the cache, with data_left as the
+ *	cursor, so even a huge value is never copied anywhere but into the
+ *	application's buffer.  Returns -1 if the value does need converting
+ *	(line feeds, a translation DLL...), for copy_and_convert_field().
+ */
+static int
+copy_coldata_text(StatementClass * stmt, GetDataClass * pgdc,
+		  OID field_type, const char *data, SQLLEN datalen,
+		  SQLSMALLINT fCType, char *rgbValueBindRow,
+		  SQLLEN cbValueMax, SQLLEN * pcbValueBindRow)
+{
+    ConnectionClass *conn = SC_get_conn(stmt);
+    SQLLEN done = 0, left, copy_len = 0;
+
+#ifdef	WIN_UNICODE_SUPPORT
+    /* SQL_C_CHAR means the ANSI code page here */
+    return -1;
+#endif				/* WIN_UNICODE_SUPPORT */
+    if (SQL_C_CHAR != fCType && SQL_C_BINARY != fCType)
+	return -1;
+    switch (field_type)
+    {
+    case PG_TYPE_UNKNOWN:
+    case PG_TYPE_BPCHAR:
+    case PG_TYPE_VARCHAR:
+    case PG_TYPE_TEXT:
+	break;
+    default:
+	return -1;
+    }
+    if (NULL != conn->DataSourceToDriver)
+	return -1;
+    if (pgdc && pgdc->data_left > 0)
+    {
+	/* it started out in copy_and_convert_field()'s ttlbuf */
+	if (pgdc->ttlbuf)
+	    return -1;
+	done = datalen - pgdc->data_left;
+    } else
+    {
+	if (conn->connInfo.lf_conversion && memchr(data, '\n', datalen))
+	    return -1;
+	if (pgdc)
+	{
+	    if (pgdc->ttlbuf)
+	    {
+		free(pgdc->ttlbuf);
+		pgdc->ttlbuf = NULL;
+		pgdc->ttlbuflen = 0;
+	    }
+	    pgdc->data_left = datalen;
+	}
+    }
+    left = datalen - done;
+    if (pcbValueBindRow)
+	*pcbValueBindRow = left;
+
+    if (rgbValueBindRow && cbValueMax > 0)
+    {
+	if (SQL_C_BINARY == fCType)
+	    copy_len = (left > cbValueMax) ? cbValueMax : left;
+	else
+	    copy_len = (left >= cbValueMax) ? (cbValueMax - 1) : left;
+	memcpy(rgbValueBindRow, data + done, copy_len);
+	if (SQL_C_CHAR == fCType)
+	    rgbValueBindRow[copy_len] = '\0';
+	if (pgdc)
+	    pgdc->data_left -= copy_len;
+    }
+
+    if (left > copy_len)
+	return COPY_RESULT_TRUNCATED;
+    if (pgdc)
+	pgdc->data_left = 0;
+    return COPY_OK;
+}
+
+/*
+ *	A cached Decimal as an SQL_NUMERIC_STRUCT.  Both keep a 128-bit
+ *	little-endian magnitude, so this is just a matter of byte order.
+ */
+void decimal_to_numeric(const CD_Decimal * dec, SQL_NUMERIC_STRUCT * ns)
+{
+    int i;
+
+    ns->precision = dec->precision;
+    ns->scale = dec->scale;
+    ns->sign = dec->negative ? 0 : 1;
+    for (i = 0; i < SQL_MAX_NUMERIC_LEN; i++)
+	ns->val[i] = (SQLCHAR) (dec->mag[i / 4] >> (8 * (i % 4)));
+}
+
+/*
+ *	Like copy_and_convert_field(), but for a value kept in its native
+ *	form in a ColumnDataClass.  Numbers and date/times headed for the
+ *	matching C types are stored straight into the application's buffer,
+ *	and TEXT/BINARY values are copied out a slice at a time.  Anything
+ *	else is handed to copy_and_convert_field() as text.
+ */
+int
+copy_and_convert_coldata(StatementClass * stmt, OID field_type,
+			 const ColumnDataClass * cd, SQLULEN row, int col,
+			 SQLSMALLINT fCType, PTR rgbValue,
+			 SQLLEN cbValueMax, SQLLEN * pcbValue,
+			 SQLLEN * pIndicator)
+{
+    ARDFields *opts = SC_get_ARDF(stmt);
+    GetDataInfo *gdata = SC_get_GDTI(stmt);
+    GetDataClass *pgdc = NULL;
+    ColumnDataKind kind = CD_get_kind(cd, col);
+    SQLSETPOSIROW bind_row = stmt->bind_row;
+    int bind_size = opts->bind_size;
+    SQLLEN pcbValueOffset, rgbValueOffset, len = -1;
+    char *rgbValueBindRow = NULL;
+    SQLLEN *pcbValueBindRow = NULL;
+    SQLSMALLINT ctype;
+    char buf[64];
+    const char *text;
+
+    /* NULLs take no converting; the generic code sets the indicator */
+    if (CD_is_null(cd, col, row))
+	return copy_and_convert_field(stmt, field_type, NULL, fCType,
+				      rgbValue, cbValueMax, pcbValue,
+				      pIndicator);
+
+    if (stmt->current_col >= 0)
+    {
+	if (stmt->current_col >= opts->allocated)
+	    return SQL_ERROR;
+	if (gdata->allocated != opts->allocated)
+	    extend_getdata_info(gdata, opts->allocated, TRUE);
+	pgdc = &gdata->gdata[stmt->current_col];
+	if (pgdc->data_left == -2)
+	    pgdc->data_left = (cbValueMax > 0) ? 0 : -1;
+	if (pgdc->data_left == 0)
+	{
+	    if (pgdc->ttlbuf != NULL)
+	    {
+		free(pgdc->ttlbuf);
+		pgdc->ttlbuf = NULL;
+		pgdc->ttlbuflen = 0;
+	    }
+	    pgdc->data_left = -2;
+	    return COPY_NO_DATA_FOUND;
+	}
+    }
+
+    if (bind_size > 0)
+	pcbValueOffset = rgbValueOffset = (bind_size * bind_row);
+    else
+    {
+	pcbValueOffset = bind_row * sizeof(SQLLEN);
+	rgbValueOffset = bind_row * cbValueMax;
+    }
+    if (rgbValue)
+	rgbValueBindRow = (char *) rgbValue + rgbValueOffset;
+    if (pcbValue)
+	pcbValueBindRow = LENADDR_SHIFT(pcbValue, pcbValueOffset);
+    if (pIndicator)
+	*LENADDR_SHIFT(pIndicator, pcbValueOffset) = 0;
+
+    ctype = fCType;
+    if (SQL_C_DEFAULT == ctype)
+	ctype = pgtype_to_ctype(stmt, field_type);
+
+    if (CD_BINARY == kind)
+    {
+	SQLLEN datalen;
+	const char *data = CD_get_blob(cd, col, row, &datalen);
+
+	return copy_coldata_binary(pgdc, data, datalen, ctype,
+				   rgbValueBindRow, cbValueMax,
+				   pcbValueBindRow);
+    }
+    if (CD_TEXT == kind)
+    {
+	SQLLEN datalen;
+	const char *data = CD_get_blob(cd, col, row, &datalen);
+	int rv = copy_coldata_text(stmt, pgdc, field_type, data, datalen,
+				   ctype, rgbValueBindRow, cbValueMax,
+				   pcbValueBindRow);
+
+	if (rv >= 0)
+	    return rv;
+    }
+
+    /* a partly read value is the text path's to finish */
+    if (!rgbValue || (pgdc && pgdc->data_left > 0))
+	goto as_text;
+
+#define	BIND_ROW_PTR(type) \
+	(bind_size > 0 ? (type *) rgbValueBindRow : (type *) rgbValue + bind_row)
+    if (CD_DOUBLE == kind || CD_DECIMAL == kind || CD_is_integer(cd, col))
+    {
+	SQLBIGINT ival = 0;
+	double dval = 0;
+
+	if (SQL_C_FLOAT == ctype || SQL_C_DOUBLE == ctype)
+	{
+	    if (CD_DOUBLE == kind)
+		dval = CD_get_double(cd, col, row);
+	    else if (CD_DECIMAL == kind)
+		dval = CD_decimal_to_double(CD_get_decimal(cd, col, row));
+	    else
+		dval = (double) CD_get_integer(cd, col, row);
+	} else if (SQL_C_NUMERIC != ctype)
+	    ival = CD_get_integer(cd, col, row);
+
+	switch (ctype)
+	{
+	case SQL_C_BIT:
+	case SQL_C_UTINYINT:
+	    len = 1;
+	    *BIND_ROW_PTR(UCHAR) = (UCHAR) ival;
+	    break;
+	case SQL_C_STINYINT:
+	case SQL_C_TINYINT:
+	    len = 1;
+	    *BIND_ROW_PTR(SCHAR) = (SCHAR) ival;
+	    break;
+	case SQL_C_SSHORT:
+	case SQL_C_SHORT:
+	    len = 2;
+	    *BIND_ROW_PTR(SQLSMALLINT) = (SQLSMALLINT) ival;
+	    break;
+	case SQL_C_USHORT:
+	    len = 2;
+	    *BIND_ROW_PTR(SQLUSMALLINT) = (SQLUSMALLINT) ival;
+	    break;
+	case SQL_C_SLONG:
+	case SQL_C_LONG:
+	    len = 4;
+	    *BIND_ROW_PTR(SQLINTEGER) = (SQLINTEGER) ival;
+	    break;
+	case SQL_C_ULONG:
+	    len = 4;
+	    *BIND_ROW_PTR(SQLUINTEGER) = (SQLUINTEGER) ival;
+	    break;
+	case SQL_C_SBIGINT:
+	    len = 8;
+	    *BIND_ROW_PTR(SQLBIGINT) = ival;
+	    break;
+	case SQL_C_UBIGINT:
+	    len = 8;
+	    *BIND_ROW_PTR(SQLUBIGINT) = (SQLUBIGINT) ival;
+	    break;
+	case SQL_C_FLOAT:
+	    len = 4;
+	    *BIND_ROW_PTR(SFLOAT) = (SFLOAT) dval;
+	    break;
+	case SQL_C_DOUBLE:
+	    len = 8;
+	    *BIND_ROW_PTR(SDOUBLE) = dval;
+	    break;
+	case SQL_C_NUMERIC:
+	    if (CD_DECIMAL == kind)
+	    {
+		len = sizeof(SQL_NUMERIC_STRUCT);
+		decimal_to_numeric(CD_get_decimal(cd, col, row),
+				   BIND_ROW_PTR(SQL_NUMERIC_STRUCT));
+	    }
+	    break;
+	}
+    } else if (CD_DATETIME == kind)
+    {
+	const CD_DateTime *dt = CD_get_datetime(cd, col, row);
+	SIMPLE_TIME st;
+
+	memset(&st, 0, sizeof(st));
+	switch (ctype)
+	{
+	case SQL_C_DATE:
+	case SQL_C_TYPE_DATE:
+	    {
+		DATE_STRUCT *ds = BIND_ROW_PTR(DATE_STRUCT);
+
+		vx_datetime_to_simple_time(dt->secs, dt->usecs, &st);
+		len = 6;
+		ds->year = st.y;
+		ds->month = st.m;
+		ds->day = st.d;
+	    }
+	    break;
+	case SQL_C_TIME:
+	case SQL_C_TYPE_TIME:
+	    {
+		TIME_STRUCT *ts = BIND_ROW_PTR(TIME_STRUCT);
+
+		vx_datetime_to_simple_time(dt->secs, dt->usecs, &st);
+		len = 6;
+		ts->hour = st.hh;
+		ts->minute = st.mm;
+		ts->second = st.ss;
+	    }
+	    break;
+	case SQL_C_TIMESTAMP:
+	case SQL_C_TYPE_TIMESTAMP:
+	    {
+		TIMESTAMP_STRUCT *ts = BIND_ROW_PTR(TIMESTAMP_STRUCT);
+
+		vx_datetime_to_simple_time(dt->secs, dt->usecs, &st);
+		len = 16;
+		ts->year = st.y;
+		ts->month = st.m;
+		ts->day = st.d;
+		ts->hour = st.hh;
+		ts->minute = st.mm;
+		ts->second = st.ss;
+		ts->fraction = st.fr;
+	    }
+	    break;
+	}
+    }
+#undef	BIND_ROW_PTR
+
+    if (len >= 0)
+    {
+	if (pcbValueBindRow)
+	    *pcbValueBindRow = len;
+	if (pgdc)
+	    pgdc->data_left = 0;
+	return COPY_OK;
+    }
+
+  as_text:
+    switch (kind)
+    {
+    case CD_TEXT:
+	text = CD_get_blob(cd, col, row, NULL);
+	break;
+    case CD_DOUBLE:
+	vx_format_double(CD_get_double(cd, col, row), FALSE, buf);
+	text = buf;
+	break;
+    case CD_DATETIME:
+	if (SQL_C_CHAR == ctype || SQL_C_WCHAR == ctype)
+	{
+	    /*
+	     * Format it here rather than have copy_and_convert_field()
+	     * parse it back out of "[secs,usecs]"; from then on it's just
+	     * text.
+	     */
+	    const CD_DateTime *dt = CD_get_datetime(cd, col, row);
+	    SIMPLE_TIME st;
+
+	    memset(&st, 0, sizeof(st));
+	    vx_datetime_to_simple_time(dt->secs, dt->usecs, &st);
+	    vx_format_datetime(&st, buf);
+	    field_type = PG_TYPE_VARCHAR;
+	} else
+	    snprintf(buf, sizeof(buf), "[%lld,%d]",
+		     (long long) CD_get_datetime(cd, col, row)->secs,
+		     (int) CD_get_datetime(cd, col, row)->usecs);
+	text = buf;
+	break;
+    case CD_DECIMAL:
+	CD_decimal_to_text(CD_get_decimal(cd, col, row), buf);
+	text = buf;
+	break;
+    default:
+	snprintf(buf, sizeof(buf), "%lld",
+		 (long long) CD_get_integer(cd, col, row));
+	text = buf;
+	break;
+    }
+    return copy_and_convert_field(stmt, field_type, (void *) text, fCType,
+				  rgbValue, cbValueMax, pcbValue,
+				  pIndicator);
+}
+
+
 /*--------------------------------------------------------------------
  *	Functions/Macros to get rid of query size limit.
  *
@@ -2114,6 +2922,7 @@ static int inner_process_tokens(QueryParse * qp, QueryBuild * qb)
 			break;
 		    }
 		}
+		CC_release_col_info(conn, coli);
 	    }
 	}
 	if (!converted)
@@ -2265,7 +3074,7 @@ static int inner_process_tokens(QueryParse * qp, QueryBuild * qb)
     return SQL_ERROR;
 }
 
-static BOOL
+BOOL
 ResolveNumericParam(const SQL_NUMERIC_STRUCT * ns, char *chrform)
 {
     static const int prec[] =
@@ -2401,6 +3210,346 @@ ResolveNumericParam(const SQL_NUMERIC_STRUCT * ns, char *chrform)
 }
 
 
+/*
+ *	If p starts a quoted string, a [quoted identifier] or a comment,
+ *	returns a pointer to just past its end; otherwise returns p.
+ */
+const char *skip_sql_quoted(const char *p)
+{
+    char close;
+
+    switch (*p)
+    {
+    case '\'':
+    case '"':
+	close = *p;
+	break;
+    case '[':
+	close = ']';
+	break;
+    case '-':
+	if ('-' != p[1])
+	    return p;
+	while (*p && '\n' != *p)
+	    p++;
+	return p;
+    case '/':
+	if ('*' != p[1])
+	    return p;
+	for (p += 2; *p && !('*' == p[0] && '/' == p[1]); p++)
+	    ;
+	return *p ? p + 2 : p;
+    default:
+	return p;
+    }
+    /* a doubled close quote just starts another quoted piece */
+    for (p++; *p && close != *p; p++)
+	;
+    return *p ? p + 1 : p;
+}
+
+
+/*
+ *	Where row 'row' of a parameter's value and length live, for either
+ *	row-wise or column-wise binding.
+ */
+static void
+param_row_ptrs(const APDFields * apdopts, const ParameterInfoClass * param,
+	       SQLSMALLINT ctype, SQLULEN row, char **buffer, SQLLEN ** used)
+{
+    SQLULEN offset =
+	apdopts->param_offset_ptr ? *apdopts->param_offset_ptr : 0;
+
+    *buffer = NULL;
+    *used = NULL;
+    if (apdopts->param_bind_type > 0)
+    {
+	offset += row * apdopts->param_bind_type;
+	if (param->buffer)
+	    *buffer = param->buffer + offset;
+	if (param->used)
+	    *used = (SQLLEN *) ((char *) param->used + offset);
+    }
+    else
+    {
+	SQLLEN width = ctype_length(ctype);
+
+	if (width <= 0)
+	    width = param->buflen;
+	if (param->buffer)
+	    *buffer = param->buffer + offset + row * width;
+	if (param->used)
+	    *used = (SQLLEN *) ((char *) param->used + offset) + row;
+    }
+}
+
+
+/*
+ *	Append a T-SQL string literal, doubling any quotes in it.  Non-ASCII
+ *	text gets an N'' literal so that it survives the trip into nvarchar
+ *	columns.
+ */
+static RETCODE
+QB_append_literal(QueryBuild * qb, const char *s, SQLLEN len)
+{
+    SQLLEN i;
+    BOOL ascii = TRUE;
+
+    for (i = 0; i < len && ascii; i++)
+	ascii = ((UCHAR) s[i] < 0x80);
+    ENLARGE_NEWSTATEMENT(qb, qb->npos + 2 * len + 4);
+    if (!ascii)
+	qb->query_statement[qb->npos++] = 'N';
+    qb->query_statement[qb->npos++] = LITERAL_QUOTE;
+    for (i = 0; i < len; i++)
+    {
+	if (LITERAL_QUOTE == s[i])
+	    qb->query_statement[qb->npos++] = LITERAL_QUOTE;
+	qb->query_statement[qb->npos++] = s[i];
+    }
+    qb->query_statement[qb->npos++] = LITERAL_QUOTE;
+    CVT_TERMINATE(qb);
+
+    return SQL_SUCCESS;
+}
+
+
+/*
+ *	Append row 'row' of a bound parameter as a T-SQL literal.
+ */
+static RETCODE
+QB_append_param(QueryBuild * qb, const ParameterInfoClass * param,
+		const ParameterImplClass * iparam, SQLULEN row)
+{
+    char *buffer, tmp[128];
+    SQLLEN *used, len;
+    SQLSMALLINT ctype = param->CType;
+
+    if (SQL_C_DEFAULT == ctype)
+	ctype = sqltype_to_default_ctype(qb->conn, iparam->SQLType);
+    param_row_ptrs(qb->apdopts, param, ctype, row, &buffer, &used);
+    if (!buffer || (used && SQL_NULL_DATA == *used))
+    {
+	CVT_APPEND_STR(qb, "NULL");
+	return SQL_SUCCESS;
+    }
+    if (used && (SQL_DATA_AT_EXEC == *used ||
+		 *used <= SQL_LEN_DATA_AT_EXEC_OFFSET))
+    {
+	qb->errornumber = STMT_NOT_IMPLEMENTED_ERROR;
+	qb->errormsg = "Data-at-execution parameters are not supported";
+	return SQL_ERROR;
+    }
+
+    switch (ctype)
+    {
+    case SQL_C_CHAR:
+	len = (!used || SQL_NTS == *used) ? (SQLLEN) strlen(buffer) : *used;
+	return QB_append_literal(qb, buffer, len);
+#ifdef	UNICODE_SUPPORT
+    case SQL_C_WCHAR:
+	{
+	    char *utf8;
+	    RETCODE ret;
+
+	    utf8 = ucs2_to_utf8((const SQLWCHAR *) buffer,
+				(!used || SQL_NTS == *used) ?
+				SQL_NTS : *used / WCLEN, &len, FALSE);
+	    if (!utf8)
+	    {
+		qb->errornumber = STMT_NO_MEMORY_ERROR;
+		qb->errormsg = "Couldn't convert a unicode parameter";
+		return SQL_ERROR;
+	    }
+	    ret = QB_append_literal(qb, utf8, len);
+	    free(utf8);
+	    return ret;
+	}
+#endif				/* UNICODE_SUPPORT */
+    case SQL_C_BINARY:
+	len = used ? *used : param->buflen;
+	ENLARGE_NEWSTATEMENT(qb, qb->npos + 2 * len + 3);
+	CVT_APPEND_STR(qb, "0x");
+	qb->npos += 2 * pg_bin2hex((UCHAR *) buffer,
+				   (UCHAR *) F_NewPtr(qb), len);
+	return SQL_SUCCESS;
+    case SQL_C_BIT:
+    case SQL_C_UTINYINT:
+	sprintf(tmp, "%u", *(UCHAR *) buffer);
+	break;
+    case SQL_C_STINYINT:
+    case SQL_C_TINYINT:
+	sprintf(tmp, "%d", *(SCHAR *) buffer);
+	break;
+    case SQL_C_SSHORT:
+    case SQL_C_SHORT:
+	sprintf(tmp, "%d", *(SWORD *) buffer);
+	break;
+    case SQL_C_USHORT:
+	sprintf(tmp, "%u", *(UWORD *) buffer);
+	break;
+    case SQL_C_SLONG:
+    case SQL_C_LONG:
+	sprintf(tmp, "%d", *(SDWORD *) buffer);
+	break;
+    case SQL_C_ULONG:
+	sprintf(tmp, "%u", *(UDWORD *) buffer);
+	break;
+    case SQL_C_SBIGINT:
+	sprintf(tmp, "%lld", (long long) *(SQLBIGINT *) buffer);
+	break;
+    case SQL_C_UBIGINT:
+	sprintf(tmp, "%llu", (unsigned long long) *(SQLUBIGINT *) buffer);
+	break;
+    case SQL_C_FLOAT:
+	vx_format_double(*(SFLOAT *) buffer, TRUE, tmp);
+	break;
+    case SQL_C_DOUBLE:
+	vx_format_double(*(SDOUBLE *) buffer, FALSE, tmp);
+	break;
+    case SQL_C_NUMERIC:
+	ResolveNumericParam((const SQL_NUMERIC_STRUCT *) buffer, tmp);
+	break;
+    case SQL_C_DATE:
+    case SQL_C_TYPE_DATE:
+	{
+	    const DATE_STRUCT *ds = (const DATE_STRUCT *) buffer;
+
+	    sprintf(tmp, "'%04d-%02d-%02d'", ds->year, ds->month, ds->day);
+	}
+	break;
+    case SQL_C_TIME:
+    case SQL_C_TYPE_TIME:
+	{
+	    const TIME_STRUCT *ts = (const TIME_STRUCT *) buffer;
+
+	    sprintf(tmp, "'%02d:%02d:%02d'", ts->hour, ts->minute,
+		    ts->second);
+	}
+	break;
+    case SQL_C_TIMESTAMP:
+    case SQL_C_TYPE_TIMESTAMP:
+	{
+	    const TIMESTAMP_STRUCT *ts = (const TIMESTAMP_STRUCT *) buffer;
+
+	    /* fraction is in nanoseconds; datetime keeps milliseconds */
+	    sprintf(tmp, "'%04d-%02d-%02d %02d:%02d:%02d.%03d'",
+		    ts->year, ts->month, ts->day, ts->hour, ts->minute,
+		    ts->second, (int) (ts->fraction / 1000000));
+	}
+	break;
+    default:
+	qb->errornumber = STMT_PROGRAM_TYPE_OUT_OF_RANGE;
+	qb->errormsg = "Unsupported parameter C type";
+	return SQL_ERROR;
+    }
+    CVT_APPEND_STR(qb, tmp);
+
+    return SQL_SUCCESS;
+}
+
+
+/*
+ *	Append the statement with row 'row' of the bound parameters in
+ *	place of its markers.  The text between the markers was found when
+ *	the statement was prepared, so it's just copied across.
+ */
+static RETCODE
+QB_append_statement_row(QueryBuild * qb, const PreparedQuery * pq,
+			SQLULEN row)
+{
+    size_t start = 0;
+    int param;
+    RETCODE ret;
+
+    for (param = 0; param < pq->num_params; param++)
+    {
+	if (param >= qb->apdopts->allocated || param >= qb->ipdopts->allocated
+	    || (!qb->apdopts->parameters[param].buffer &&
+		!qb->apdopts->parameters[param].used))
+	{
+	    qb->errornumber = STMT_COUNT_FIELD_INCORRECT;
+	    qb->errormsg = "Not all of the statement's parameters are bound";
+	    return SQL_ERROR;
+	}
+	CVT_APPEND_DATA(qb, pq->statement + start,
+			pq->markers[param] - start);
+	ret = QB_append_param(qb, &qb->apdopts->parameters[param],
+			      &qb->ipdopts->parameters[param], row);
+	if (SQL_ERROR == ret)
+	    return ret;
+	start = pq->markers[param] + 1;
+    }
+    CVT_APPEND_DATA(qb, pq->statement + start, pq->len - start);
+    CVT_TERMINATE(qb);
+
+    return SQL_SUCCESS;
+}
+
+
+/*
+ *	versaplexd takes only plain query text, so parameters are sent as
+ *	literals.  This builds a T-SQL batch which runs the statement once for
+ *	each row of the parameter set, starting at *row, until the set runs
+ *	out or the batch reaches about max_len bytes.  Rows that the
+ *	SQL_ATTR_PARAM_OPERATION_PTR array says to ignore are skipped.
+ *
+ *	On return, *row is the first row not in the batch, and *batch (which
+ *	the caller frees) is the batch itself; it's empty if every row was
+ *	ignored.
+ */
+RETCODE
+build_param_batch(StatementClass * stmt, SQLULEN * row, size_t max_len,
+		  char **batch)
+{
+    CSTR func = "build_param_batch";
+    QueryBuild query_org, *qb = &query_org;
+    APDFields *apdopts = SC_get_APDF(stmt);
+    SQLULEN size = apdopts->paramset_size > 0 ? apdopts->paramset_size : 1;
+    const PreparedQuery *pq = stmt->pquery;
+    RETCODE ret = SQL_SUCCESS;
+
+    *batch = NULL;
+    if (!pq)
+    {
+	SC_set_error(stmt, STMT_EXEC_ERROR,
+		     "The statement hasn't been parsed", func);
+	return SQL_ERROR;
+    }
+    if (QB_initialize(qb, pq->len, stmt, NULL) < 0)
+    {
+	SC_set_error(stmt, STMT_NO_MEMORY_ERROR,
+		     "Couldn't allocate the parameter batch", func);
+	return SQL_ERROR;
+    }
+    for (; *row < size; (*row)++)
+    {
+	if (apdopts->param_operation_ptr &&
+	    SQL_PARAM_IGNORE == apdopts->param_operation_ptr[*row])
+	    continue;
+	if (qb->npos > 0)
+	{
+	    if (qb->npos >= max_len)
+		break;
+	    CVT_APPEND_CHAR(qb, '\n');
+	}
+	if (ret = QB_append_statement_row(qb, pq, *row),
+	    SQL_ERROR == ret)
+	    break;
+    }
+    if (SQL_ERROR == ret || !qb->query_statement)
+    {
+	QB_replace_SC_error(stmt, qb, func);
+	QB_Destructor(qb);
+	return SQL_ERROR;
+    }
+    mylog("%s: %d bytes, up to row %d\n", func, (int) qb->npos, (int) *row);
+    *batch = qb->query_statement;
+
+    return SQL_SUCCESS;
+}
+
+
 BOOL convert_money(const char *s, char *sout, size_t soutmax)
 {
     size_t i = 0, out = 0;
@@ -2812,7 +3961,6 @@ convert_to_pgbinary(const UCHAR * in, char *out, size_t len,
 }
 
 
-static const char *hextbl = "0123456789ABCDEF";
 static SQLLEN pg_bin2hex(UCHAR * src, UCHAR * dst, SQLLEN length)
 {
     UCHAR chr, *src_wk, *dst_wk;
@@ -10,6 +10,7 @@
 #define __CONVERT_H__
 
 #include "psqlodbc.h"
+#include "coldata.h"
 
 #ifdef	__cplusplus
 extern "C" {
@@ -38,9 +39,18 @@ int		copy_and_convert_field_bindinfo(StatementClass *stmt, OID field_type, void
 int	copy_and_convert_field(StatementClass *stmt, OID field_type,
 			void *value, SQLSMALLINT fCType, PTR rgbValue,
 			SQLLEN cbValueMax, SQLLEN *pcbValue, SQLLEN *pIndicator);
+int		copy_and_convert_coldata_bindinfo(StatementClass *stmt, OID field_type, const ColumnDataClass *cd, SQLULEN row, int col);
+int	copy_and_convert_coldata(StatementClass *stmt, OID field_type,
+			const ColumnDataClass *cd, SQLULEN row, int col,
+			SQLSMALLINT fCType, PTR rgbValue,
+			SQLLEN cbValueMax, SQLLEN *pcbValue, SQLLEN *pIndicator);
 
 BOOL		convert_money(const char *s, char *sout, size_t soutmax);
 char		parse_datetime(const char *buf, SIMPLE_TIME *st);
+void		vx_datetime_to_simple_time(long long secs, int usecs, SIMPLE_TIME *std_time);
+double		vx_strtod(const char *str, char **endptr);
+void		decimal_to_numeric(const CD_Decimal *dec, SQL_NUMERIC_STRUCT *ns);
+int		vx_format_double(double value, BOOL is_float, char *buf);
 size_t		convert_linefeeds(const char *s, char *dst, size_t max, BOOL convlf, BOOL *changed);
 size_t		convert_special_chars(const char *si, char *dst, SQLLEN used, UInt4 flags,int ccsc, int escape_ch);
 
@@ -48,6 +58,9 @@ int		convert_pgbinary_to_char(const char *value, char *rgbValue, ssize_t cbValue
 size_t		convert_from_pgbinary(const UCHAR *value, UCHAR *rgbValue, SQLLEN cbValueMax);
 SQLLEN		pg_hex2bin(const UCHAR *in, UCHAR *out, SQLLEN len);
 Int4		findTag(const char *str, char dollar_quote, int ccsc);
+const char	*skip_sql_quoted(const char *p);
+BOOL		ResolveNumericParam(const SQL_NUMERIC_STRUCT *ns, char *chrform);
+RETCODE		build_param_batch(StatementClass *stmt, SQLULEN *row, size_t max_len, char **batch);
 
 #ifdef	__cplusplus
 }
@@ -112,6 +112,17 @@ copyAttributes(ConnInfo * ci, const char *attribute, const char *value)
 
     else if (stricmp(attribute, INI_DBUS) == 0)
         strcpy(ci->dbus_moniker, value);
+
+    else if (stricmp(attribute, INI_CATALOGCACHETTL) == 0)
+	strncpy_null(ci->catalog_cache_ttl, value,
+		     sizeof(ci->catalog_cache_ttl));
+
+    else if (stricmp(attribute, INI_CATALOGCACHESIZE) == 0)
+	strncpy_null(ci->catalog_cache_size, value,
+		     sizeof(ci->catalog_cache_size));
+
+    else if (stricmp(attribute, INI_PREFETCHCOLUMNS) == 0)
+	ci->prefetch_columns = atoi(value);
     
     else
 	found = FALSE;
@@ -161,6 +172,12 @@ void getDSNdefaults(ConnInfo * ci)
     if (ci->row_versioning[0] == '\0')
 	sprintf(ci->row_versioning, "%d", DEFAULT_ROWVERSIONING);
 
+    if (ci->catalog_cache_ttl[0] == '\0')
+	sprintf(ci->catalog_cache_ttl, "%d", DEFAULT_CATALOGCACHETTL);
+
+    if (ci->catalog_cache_size[0] == '\0')
+	sprintf(ci->catalog_cache_size, "%d", DEFAULT_CATALOGCACHESIZE);
+
     if (ci->disallow_premature < 0)
 	ci->disallow_premature = DEFAULT_DISALLOWPREMATURE;
     if (ci->allow_keyset < 0)
@@ -187,6 +204,8 @@ void getDSNdefaults(ConnInfo * ci)
 	ci->bde_environment = 0;
     if (ci->cvt_null_date_string < 0)
 	ci->cvt_null_date_string = 0;
+    if (ci->prefetch_columns < 0)
+	ci->prefetch_columns = DEFAULT_PREFETCHCOLUMNS;
 }
 
 int
@@ -255,6 +274,26 @@ void getDSNinfo(ConnInfo * ci, char overwrite)
         SQLGetPrivateProfileString(DSN, INI_DBUS, "dbus:session", 
                 ci->dbus_moniker, sizeof(ci->dbus_moniker), ODBC_INI);
 
+    if (ci->catalog_cache_ttl[0] == '\0' || overwrite)
+	SQLGetPrivateProfileString(DSN, INI_CATALOGCACHETTL, "",
+				   ci->catalog_cache_ttl,
+				   sizeof(ci->catalog_cache_ttl), ODBC_INI);
+
+    if (ci->catalog_cache_size[0] == '\0' || overwrite)
+	SQLGetPrivateProfileString(DSN, INI_CATALOGCACHESIZE, "",
+				   ci->catalog_cache_size,
+				   sizeof(ci->catalog_cache_size), ODBC_INI);
+
+    if (ci->prefetch_columns < 0 || overwrite)
+    {
+	char temp[SMALL_REGISTRY_LEN];
+
+	SQLGetPrivateProfileString(DSN, INI_PREFETCHCOLUMNS, "", temp,
+				   sizeof(temp), ODBC_INI);
+	if (temp[0])
+	    ci->prefetch_columns = atoi(temp);
+    }
+
     char llbuf[2] = {0, 0};
     if (!log_level || overwrite)
 	SQLGetPrivateProfileString(DSN, "LogLevel", "4", llbuf,
@@ -52,6 +52,12 @@ extern "C" {
 #define INI_PASSWORD			"Password"	/* Default Password */
 // Which DBus connection to use.  Defaults to "dbus:session".
 #define INI_DBUS                        "DBus"
+#define INI_CATALOGCACHETTL		"CatalogCacheTTL"	/* Seconds to keep
+							 * SQLTables etc. results */
+#define INI_CATALOGCACHESIZE		"CatalogCacheSize"	/* How many of them
+							 * to keep */
+#define INI_PREFETCHCOLUMNS		"PrefetchColumns"	/* SQLColumns gets
+							 * every table's at once */
 
 #define INI_READONLY			"ReadOnly"	/* Database is read only */
 #if 0
@@ -204,6 +210,12 @@ extern "C" {
 #define DEFAULT_SHOWOIDCOLUMN			0
 #define DEFAULT_ROWVERSIONING			0
 #define DEFAULT_SHOWSYSTEMTABLES		0		/* dont show system tables */
+#define DEFAULT_CATALOGCACHETTL			0		/* seconds; off unless asked
+							 * for, since other
+							 * connections' DDL
+							 * goes unnoticed */
+#define DEFAULT_CATALOGCACHESIZE		128		/* results */
+#define DEFAULT_PREFETCHCOLUMNS			0
 #define DEFAULT_LIE				0
 #define DEFAULT_PARSE				0
 
@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "connection.h"
+#include "catcache.h"
 
 #ifndef WIN32
 #include <sys/types.h>
@@ -155,6 +156,7 @@ PGAPI_DriverConnect(HDBC hdbc,
 
     /* Fill in any default parameters if they are not there. */
     getDSNdefaults(ci);
+    CC_size_catalog(conn);
     CC_initialize_pg_version(conn);
     memset(salt, 0, sizeof(salt));
 
@@ -15,6 +15,8 @@
 #include "connection.h"
 #include "statement.h"
 #include "qresult.h"
+#include "prepcache.h"
+#include "catcache.h"
 #include "convert.h"
 #include "bind.h"
 #include "pgtypes.h"
@@ -23,6 +25,9 @@
 
 /*extern GLOBAL_VALUES globals;*/
 
+/*	How much query text to send versaplexd at once for parameter arrays */
+#define VX_PARAM_BATCH_SIZE	(1024 * 1024)
+
 
 /*		Perform a Prepare on the SQL statement */
 RETCODE SQL_API
@@ -116,6 +121,17 @@ PGAPI_Prepare(HSTMT hstmt,
     self->prepare = PREPARE_STATEMENT;
     self->statement_type = statement_type(self->statement);
 
+    /* find the parameter markers now, rather than on every SQLExecute */
+    self->pquery = CC_get_prepared(SC_get_conn(self), self->statement);
+    if (!self->pquery)
+    {
+	SC_set_error(self, STMT_NO_MEMORY_ERROR,
+		     "No memory available to prepare statement", func);
+	retval = SQL_ERROR;
+	goto cleanup;
+    }
+    self->num_params = PQ_get_num_params(self->pquery);
+
     /* Check if connection is onlyread (only selects are allowed) */
     if (CC_is_onlyread(SC_get_conn(self)) && STMT_UPDATE(self))
     {
@@ -155,6 +171,273 @@ PGAPI_ExecDirect(HSTMT hstmt,
 }
 
 
+/*
+ *	With SQL_ASYNC_ENABLE_ON, the query is sent and SQL_STILL_EXECUTING
+ *	returned straight away; the application then calls the same function
+ *	again until the first chunk of rows is in.  A lone INSERT, UPDATE or
+ *	DELETE goes as ExecNoResult, the way it would without async, so the
+ *	row count comes out the same.
+ */
+static RETCODE ExecStart_Vx(StatementClass * stmt, const char *query)
+{
+    VxResultSet *rs = new VxResultSet(true);
+
+    {
+	VxStatement st(stmt);
+	if (PQ_is_no_result(stmt->pquery))
+	{
+	    WvDBusMsg msg("vx.versaplexd", "/db", "vx.db", "ExecNoResult");
+
+	    msg.append(query);
+	    st.sendscalar(*rs, msg);
+	}
+	else
+	    st.sendquery(*rs, "ExecChunkRecordset", query);
+    }
+    stmt->pending = rs;
+    stmt->status = STMT_EXECUTING;
+    return SQL_STILL_EXECUTING;
+}
+
+
+/*
+ *	Fill in the status of parameter rows first to row - 1, which went to
+ *	versaplexd in the same request and so all worked or all failed.
+ */
+static void ExecParamStatus_Vx(StatementClass * stmt, SQLULEN first,
+			       SQLULEN row, BOOL ok)
+{
+    APDFields *apdopts = SC_get_APDF(stmt);
+    IPDFields *ipdopts = SC_get_IPDF(stmt);
+    SQLULEN i;
+
+    for (i = first; i < row; i++)
+    {
+	BOOL ignored = (apdopts->param_operation_ptr &&
+	    SQL_PARAM_IGNORE == apdopts->param_operation_ptr[i]);
+
+	if (ipdopts->param_status_ptr)
+	    ipdopts->param_status_ptr[i] = ignored ? SQL_PARAM_UNUSED
+		: ok ? SQL_PARAM_SUCCESS : SQL_PARAM_ERROR;
+	if (ipdopts->param_processed_ptr && !ignored)
+	    (*ipdopts->param_processed_ptr)++;
+    }
+}
+
+
+static RETCODE ExecPoll_Vx(StatementClass * stmt)
+{
+    CSTR func = "ExecPoll_Vx";
+    APDFields *apdopts = SC_get_APDF(stmt);
+    VxResultSet *rs = stmt->pending;
+
+    if (!rs->poll())
+	return SQL_STILL_EXECUTING;
+    stmt->pending = NULL;
+
+    VxStatement st(stmt);
+    if (PQ_is_no_result(stmt->pquery))
+    {
+	if (!rs->error)
+	    rs->res->recent_processed_row_count = rs->scalar;
+	else
+	{
+	    SC_set_error(stmt, STMT_EXEC_ERROR, rs->error.cstr(), func);
+	    st.seterr();
+	}
+    }
+    /* ExecParamsStart_Vx() sent every parameter row at once */
+    if (stmt->num_params > 0)
+	ExecParamStatus_Vx(stmt, 0, apdopts->paramset_size > 0 ?
+			   apdopts->paramset_size : 1, !rs->error);
+    st.set_result(*rs);
+    delete rs;
+    return st.retcode();
+}
+
+
+/*
+ *	A lone INSERT, UPDATE or DELETE can't return any rows, so there's no
+ *	point in having versaplexd describe and send an empty recordset:
+ *	ExecNoResult just answers with the number of rows affected, which
+ *	ends up in rs.scalar.  Returns FALSE (with the complaint in rs.error)
+ *	if the statement failed.
+ */
+static BOOL ExecNoResult_Vx(VxStatement & st, VxResultSet & rs,
+			    const char *query)
+{
+    WvDBusMsg msg("vx.versaplexd", "/db", "vx.db", "ExecNoResult");
+
+    msg.append(query);
+    st.runscalar(rs, msg);
+    return !rs.error;
+}
+
+
+/*
+ *	Runs a statement with parameter markers once for each row of its
+ *	parameter set.  As many rows as fit in VX_PARAM_BATCH_SIZE bytes go
+ *	to versaplexd in one request, and the last request's result becomes
+ *	the statement's result.  For statements that don't return rows, the
+ *	result's row count is the total over all the requests.
+ */
+static RETCODE ExecParams_Vx(StatementClass * stmt)
+{
+    CSTR func = "ExecParams_Vx";
+    APDFields *apdopts = SC_get_APDF(stmt);
+    IPDFields *ipdopts = SC_get_IPDF(stmt);
+    SQLULEN size = apdopts->paramset_size > 0 ? apdopts->paramset_size : 1;
+    SQLULEN row = 0, first, i;
+    BOOL no_result = PQ_is_no_result(stmt->pquery);
+    SQLLEN total = 0;
+    char *batch;
+
+    if (ipdopts->param_processed_ptr)
+	*ipdopts->param_processed_ptr = 0;
+
+    VxStatement st(stmt);
+    while (row < size)
+    {
+	VxResultSet rs(true);
+
+	first = row;
+	if (SQL_ERROR ==
+	    build_param_batch(stmt, &row, VX_PARAM_BATCH_SIZE, &batch))
+	{
+	    /* nothing in this batch got run */
+	    for (i = first; ipdopts->param_status_ptr && i < size; i++)
+		ipdopts->param_status_ptr[i] =
+		    (i == row) ? SQL_PARAM_ERROR : SQL_PARAM_UNUSED;
+	    if (ipdopts->param_processed_ptr)
+		(*ipdopts->param_processed_ptr)++;
+	    st.seterr();
+	    break;
+	}
+	mylog("Running parameter rows %d to %d\n", (int) first, (int) row);
+	if (batch[0] && no_result)
+	{
+	    if (ExecNoResult_Vx(st, rs, batch))
+		total += rs.scalar;
+	}
+	else if (batch[0])
+	    st.runquery(rs, "ExecChunkRecordset", batch, row >= size);
+	free(batch);
+	if (rs.error)
+	{
+	    /* versaplexd turned down the whole batch */
+	    SC_set_error(stmt, STMT_EXEC_ERROR, rs.error.cstr(), func);
+	    st.seterr();
+	}
+	ExecParamStatus_Vx(stmt, first, row, st.isok());
+	if (!st.isok())
+	{
+	    for (i = row; ipdopts->param_status_ptr && i < size; i++)
+		ipdopts->param_status_ptr[i] = SQL_PARAM_UNUSED;
+	    break;
+	}
+	if (row >= size)
+	{
+	    if (no_result)
+		rs.res->recent_processed_row_count = total;
+	    st.set_result(rs);
+	}
+    }
+
+    return st.retcode();
+}
+
+
+/*
+ *	SQL_ASYNC_ENABLE_ON with parameters: if every row of the parameter
+ *	set fits in one request, send it the way ExecStart_Vx() does.  More
+ *	rows than that have to go in one request after another, which only
+ *	works synchronously, so then it returns SQL_SUCCESS for the caller
+ *	to run them with ExecParams_Vx() instead.
+ */
+static RETCODE ExecParamsStart_Vx(StatementClass * stmt)
+{
+    APDFields *apdopts = SC_get_APDF(stmt);
+    IPDFields *ipdopts = SC_get_IPDF(stmt);
+    SQLULEN size = apdopts->paramset_size > 0 ? apdopts->paramset_size : 1;
+    SQLULEN row = 0;
+    RETCODE ret;
+    char *batch;
+
+    /* ExecParams_Vx() says what was wrong with it, row by row */
+    if (SQL_ERROR ==
+	build_param_batch(stmt, &row, VX_PARAM_BATCH_SIZE, &batch))
+	return SQL_SUCCESS;
+    if (row < size || !batch[0])
+    {
+	free(batch);
+	return SQL_SUCCESS;
+    }
+    if (ipdopts->param_processed_ptr)
+	*ipdopts->param_processed_ptr = 0;
+    ret = ExecStart_Vx(stmt, batch);
+    free(batch);
+    return ret;
+}
+
+
+static RETCODE ExecStatement_Vx(StatementClass * stmt)
+{
+    CSTR func = "ExecStatement_Vx";
+    RETCODE ret;
+
+    if (!stmt->pquery)
+    {
+	stmt->pquery = CC_get_prepared(SC_get_conn(stmt), stmt->statement);
+	if (!stmt->pquery)
+	{
+	    SC_set_error(stmt, STMT_NO_MEMORY_ERROR,
+			 "No memory available to parse statement", func);
+	    return SQL_ERROR;
+	}
+	stmt->num_params = PQ_get_num_params(stmt->pquery);
+    }
+    stmt->statement_type = PQ_get_statement_type(stmt->pquery);
+    CONNLOCK_ACQUIRE(SC_get_conn(stmt));
+    stmt->cancelled = FALSE;	/* any SQLCancel was for an earlier call */
+    CONNLOCK_RELEASE(SC_get_conn(stmt));
+    if (PQ_changes_schema(stmt->pquery))
+	CC_forget_catalog(SC_get_conn(stmt));
+    if (stmt->num_params > 0
+	&& SQL_ASYNC_ENABLE_ON == stmt->options.async_enable)
+    {
+	if (ret = ExecParamsStart_Vx(stmt), SQL_STILL_EXECUTING == ret)
+	    return ret;
+	if (ret = ExecParams_Vx(stmt), SQL_SUCCESS == ret)
+	{
+	    SC_set_error(stmt, STMT_OPTION_VALUE_CHANGED,
+			 "Too many parameter rows to run asynchronously",
+			 func);
+	    ret = SQL_SUCCESS_WITH_INFO;
+	}
+	return ret;
+    }
+    if (stmt->num_params > 0)
+	return ExecParams_Vx(stmt);
+    if (SQL_ASYNC_ENABLE_ON == stmt->options.async_enable)
+	return ExecStart_Vx(stmt, stmt->statement);
+
+    VxStatement st(stmt);
+    VxResultSet rs(true);
+    if (!PQ_is_no_result(stmt->pquery))
+	st.runquery(rs, "ExecChunkRecordset", stmt->statement, true);
+    else if (ExecNoResult_Vx(st, rs, stmt->statement))
+	rs.res->recent_processed_row_count = rs.scalar;
+    else
+    {
+	SC_set_error(stmt, STMT_EXEC_ERROR, rs.error.cstr(), func);
+	st.seterr();
+    }
+    st.set_result(rs);
+
+    return st.retcode();
+}
+
+
 /* Performs the equivalent of SQLPrepare, followed by SQLExecute. */
 RETCODE SQL_API
 PGAPI_ExecDirect_Vx(HSTMT hstmt,
@@ -163,18 +446,16 @@ PGAPI_ExecDirect_Vx(HSTMT hstmt,
 {
     StatementClass *stmt = (StatementClass *)hstmt;
 
-    VxStatement st(stmt);
-    VxResultSet rs;
-    st.reinit();
-    st.runquery(rs, "ExecChunkRecordset", (const char *)szSqlStr);
-    st.set_result(rs);
+    if (SC_is_async_pending(stmt))
+	return ExecPoll_Vx(stmt);
+
+    if (SQL_ERROR == SC_initialize_and_recycle(stmt))
+	return SQL_ERROR;
     stmt->statement = strdup((const char *)szSqlStr);
     stmt->catalog_result = FALSE;
-    stmt->statement_type = STMT_TYPE_SELECT;
 //    SC_set_parse_forced(stmt);
 
-cleanup:
-    return st.retcode();
+    return ExecStatement_Vx(stmt);
 }
 
 
@@ -183,13 +464,10 @@ RETCODE SQL_API PGAPI_Execute_Vx(HSTMT hstmt, UWORD flag)
 {
     StatementClass *stmt = (StatementClass *)hstmt;
 
-    VxStatement st(stmt);
-    VxResultSet rs;
-    st.runquery(rs, "ExecChunkRecordset", stmt->statement);
-    st.set_result(rs);
+    if (SC_is_async_pending(stmt))
+	return ExecPoll_Vx(stmt);
 
-cleanup:
-    return st.retcode();
+    return ExecStatement_Vx(stmt);
 }
 
 
@@ -402,11 +680,27 @@ RETCODE SQL_API PGAPI_Cancel(HSTMT hstmt)	/* Statement to cancel. */
     if (estmt->data_at_exec < 0)
     {
 	/*
-	 * Tell the Backend that we're cancelling this request
+	 * Another thread running the statement has it locked until
+	 * versaplexd answers, which is what we're trying to cut short.
 	 */
-        mylog("Cancelling while in the middle of SQLParamData/SQLPutData not "
-            "yet supported\n");
-        ret = SQL_ERROR;
+	if (!TRY_ENTER_STMT_CS(stmt))
+	{
+	    SC_cancel_running(stmt);
+	    goto cleanup;
+	}
+	entered_cs = TRUE;
+
+	/*
+	 * Tell versaplexd that we're cancelling this request, and throw
+	 * away whatever we have of its results.
+	 */
+	SC_clear_error(stmt);
+	if (SC_is_async_pending(stmt))
+	{
+	    SC_abandon_async(stmt);
+	    stmt->status = STMT_FINISHED;
+	}
+	ret = PGAPI_FreeStmt(hstmt, SQL_CLOSE);
 	goto cleanup;
     }
 
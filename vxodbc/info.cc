@@ -1024,10 +1024,7 @@ RETCODE SQL_API
 	    pfExists[SQL_API_SQLSETPOS] = TRUE;
 	    pfExists[SQL_API_SQLSETSCROLLOPTIONS] = TRUE;	/* odbc 1.0 */
 	    pfExists[SQL_API_SQLTABLEPRIVILEGES] = TRUE;
-	    if (0 == ci->updatable_cursors)
-		pfExists[SQL_API_SQLBULKOPERATIONS] = FALSE;
-	    else
-		pfExists[SQL_API_SQLBULKOPERATIONS] = TRUE;
+	    pfExists[SQL_API_SQLBULKOPERATIONS] = TRUE;	/* SQL_ADD only */
 	}
     }
     else
@@ -1315,10 +1312,163 @@ static char *adjustLikePattern(const void *_src, int srclen,
 }
 
 
-/**
- * FIXME: we always return all tables, not parsing for wildcards, catalogs,
- * etc.  This seems to be good enough for now but could easily explode in
- * some apps.
+/*
+ *	Turn an ODBC search pattern (or, with search_pattern off, a plain
+ *	name) into the body of a T-SQL LIKE pattern literal, for the catalog
+ *	procedures on the server to do the matching.  '\' escapes become
+ *	'[x]', and '[' (which LIKE treats specially) is bracketed too.
+ *	Returns NULL for an argument that wouldn't filter anything out.
+ */
+static char *tsqlLikePattern(const void *_src, int srclen,
+			     BOOL search_pattern,
+			     const ConnectionClass * conn)
+{
+    int i, outlen;
+    const char *src = (const char *)_src, *in;
+    char *dest = NULL;
+    BOOL escape_in = FALSE;
+    encoded_str encstr;
+
+    if (!src || srclen == SQL_NULL_DATA)
+	return dest;
+    else if (srclen == SQL_NTS)
+	srclen = (int) strlen(src);
+    if (srclen <= 0)
+	return dest;
+    if (search_pattern && 1 == srclen && '%' == *src)
+	return dest;
+    encoded_str_constr(&encstr, conn->ccsc, src);
+    dest = (char *)malloc(3 * srclen + 1);
+    if (!dest)
+	return dest;
+    for (i = 0, in = src, outlen = 0; i < srclen; i++, in++)
+    {
+	encoded_nextchar(&encstr);
+	if (ENCODE_STATUS(encstr) != 0)
+	{
+	    dest[outlen++] = *in;
+	    continue;
+	}
+	if (!escape_in && search_pattern && SEARCH_PATTERN_ESCAPE == *in)
+	{
+	    escape_in = TRUE;
+	    continue;
+	}
+	switch (*in)
+	{
+	case '%':
+	case '_':
+	    if (!escape_in && search_pattern)
+	    {
+		dest[outlen++] = *in;
+		break;
+	    }
+	    /* fall through */
+	case '[':
+	    dest[outlen++] = '[';
+	    dest[outlen++] = *in;
+	    dest[outlen++] = ']';
+	    break;
+	case LITERAL_QUOTE:
+	    dest[outlen++] = *in;
+	    dest[outlen++] = *in;
+	    break;
+	default:
+	    dest[outlen++] = *in;
+	    break;
+	}
+	escape_in = FALSE;
+    }
+    if (escape_in)
+	dest[outlen++] = SEARCH_PATTERN_ESCAPE;
+    dest[outlen] = '\0';
+    mylog("tsql like output=%s(%d)\n", dest, outlen);
+    return dest;
+}
+
+/*
+ *	Turn SQLTables' list of table types ("TABLE,VIEW" or "'TABLE','VIEW'")
+ *	into the body of the quoted list sp_tables wants for @table_type.
+ *	That's a literal inside a literal, so a quote within a type has to
+ *	be doubled twice over.  Returns NULL if every type is wanted.
+ */
+static char *tsqlTableTypes(const void *_src, int srclen)
+{
+    const char *src = (const char *)_src, *in, *end, *next, *stop;
+    char *dest = NULL;
+    int outlen = 0;
+
+    if (!src || srclen == SQL_NULL_DATA)
+	return dest;
+    else if (srclen == SQL_NTS)
+	srclen = (int) strlen(src);
+    if (srclen <= 0)
+	return dest;
+    /* at worst, every character is a one-character type or a quote */
+    dest = (char *)malloc(9 * srclen + 1);
+    if (!dest)
+	return dest;
+    for (in = src, end = src + srclen; in < end; in = next + 1)
+    {
+	for (next = in; next < end && ',' != *next; next++)
+	    ;
+	/* the quotes and spaces around each type don't count */
+	for (stop = next; in < stop && (isspace((UCHAR) * in)
+					|| LITERAL_QUOTE == *in); in++)
+	    ;
+	for (; in < stop && (isspace((UCHAR) stop[-1])
+			     || LITERAL_QUOTE == stop[-1]); stop--)
+	    ;
+	if (1 == stop - in && '%' == *in)
+	{
+	    free(dest);
+	    return NULL;
+	}
+	if (in < stop)
+	{
+	    if (outlen > 0)
+		dest[outlen++] = ',';
+	    dest[outlen++] = LITERAL_QUOTE;
+	    dest[outlen++] = LITERAL_QUOTE;
+	    for (; in < stop; in++)
+	    {
+		if (LITERAL_QUOTE == *in)
+		{
+		    dest[outlen++] = LITERAL_QUOTE;
+		    dest[outlen++] = LITERAL_QUOTE;
+		    dest[outlen++] = LITERAL_QUOTE;
+		}
+		dest[outlen++] = *in;
+	    }
+	    dest[outlen++] = LITERAL_QUOTE;
+	    dest[outlen++] = LITERAL_QUOTE;
+	}
+	if (next >= end)
+	    break;
+    }
+    if (0 == outlen)
+    {
+	free(dest);
+	return NULL;
+    }
+    dest[outlen] = '\0';
+    return dest;
+}
+
+/*	Add "@name = N'value'" to a catalog procedure call, if there's a value */
+static void addCatalogArg(WvString & query, const char *name,
+			  const char *value, BOOL unicode)
+{
+    if (!value)
+	return;
+    query.append("%s @%s = %s'%s'", strchr(query.cstr(), '@') ? "," : "",
+		 name, unicode ? "N" : "", value);
+}
+
+
+/*
+ *	Only asks versaplexd for the tables matching the owner, name and
+ *	type arguments.  The catalog argument is still ignored.
  */
 RETCODE SQL_API PGAPI_Tables
     (HSTMT hstmt, 
@@ -1332,6 +1482,8 @@ RETCODE SQL_API PGAPI_Tables
      SQLSMALLINT cbTableType, UWORD flag)
 {
     StatementClass *stmt = (StatementClass *)hstmt;
+    ConnectionClass *conn = SC_get_conn(stmt);
+    BOOL search_pattern = (0 == (flag & PODBC_NOT_SEARCH_PATTERN));
 
     VxStatement st(stmt);
     VxResultSet rs;
@@ -1345,7 +1497,28 @@ RETCODE SQL_API PGAPI_Tables
 	cbTableQualifier == 1 && szTableQualifier[0] == '%')
 	rs.return_versaplex_db();
     else
-	st.runquery(rs, "ExecChunkRecordset", "LIST TABLES");
+    {
+	char *owner = tsqlLikePattern(szTableOwner, cbTableOwner,
+				      search_pattern, conn);
+	char *name = tsqlLikePattern(szTableName, cbTableName,
+				     search_pattern, conn);
+	char *types = tsqlTableTypes(szTableType, cbTableType);
+
+	if (!owner && !name && !types)
+	    st.runcatalog(rs, "LIST TABLES");
+	else
+	{
+	    WvString query("exec sp_tables");
+
+	    addCatalogArg(query, "table_name", name, TRUE);
+	    addCatalogArg(query, "table_owner", owner, TRUE);
+	    addCatalogArg(query, "table_type", types, FALSE);
+	    st.runcatalog(rs, query);
+	}
+	free(owner);
+	free(name);
+	free(types);
+    }
     st.set_result(rs);
     stmt->catalog_result = TRUE;
     return st.retcode();
@@ -1360,12 +1533,37 @@ RETCODE SQL_API PGAPI_Columns(HSTMT hstmt, const SQLCHAR FAR * szTableQualifier,
 			      UWORD flag, OID reloid, Int2 attnum)
 {
     StatementClass *stmt = (StatementClass *)hstmt;
+    ConnectionClass *conn = SC_get_conn(stmt);
+    BOOL search_pattern = (0 == (flag & PODBC_NOT_SEARCH_PATTERN));
+    char *owner, *name, *column;
 
     VxStatement st(stmt);
     VxResultSet rs;
     st.reinit();
-    st.runquery(rs, "ExecChunkRecordset",
-		WvString("LIST COLUMNS [%s]", (const char *)szTableName));
+    owner = tsqlLikePattern(szTableOwner, cbTableOwner, search_pattern, conn);
+    column = tsqlLikePattern(szColumnName, cbColumnName, search_pattern,
+			     conn);
+    if (!owner && !column)
+    {
+	st.prefetch_columns();
+	st.runcatalog(rs, WvString("LIST COLUMNS [%s]",
+				   (const char *)szTableName));
+    }
+    else
+    {
+	// sp_columns wants a table name, even if it's just '%'
+	WvString query("exec sp_columns");
+
+	name = tsqlLikePattern(szTableName, cbTableName, search_pattern,
+			       conn);
+	addCatalogArg(query, "table_name", name ? name : "%", TRUE);
+	addCatalogArg(query, "table_owner", owner, TRUE);
+	addCatalogArg(query, "column_name", column, TRUE);
+	st.runcatalog(rs, query);
+	free(name);
+    }
+    free(owner);
+    free(column);
     st.set_result(rs);
     stmt->catalog_result = TRUE;
     return st.retcode();
@@ -2343,9 +2541,8 @@ RETCODE SQL_API PGAPI_PrimaryKeys(HSTMT hstmt, const SQLCHAR FAR * szTableQualif
     VxStatement st(stmt);
     VxResultSet rs;
     st.reinit();
-    st.runquery(rs, "ExecChunkRecordset",
-		WvString("sp_primary_keys_rowset '%s'",
-			 (const char *)szTableName));
+    st.runcatalog(rs, WvString("sp_primary_keys_rowset '%s'",
+			       (const char *)szTableName));
     st.set_result(rs);
     stmt->catalog_result = TRUE;
     return st.retcode();
@@ -112,8 +112,14 @@ PGAPI_GetInfo30(HDBC hdbc, SQLUSMALLINT fInfoType, PTR rgbInfoValue,
 	value = 0;
 	break;
     case SQL_ASYNC_MODE:
-	len = 4;
-	value = SQL_AM_NONE;
+	/*
+	 * Per statement, but only SQLExecDirect and SQLExecute ever return
+	 * SQL_STILL_EXECUTING.  Everything else (the catalog functions,
+	 * SQLFetch and so on) finishes before it returns, as ODBC lets a
+	 * driver do with any function.
+	 */
+	len = 4;
+	value = SQL_AM_STATEMENT;
 	break;
     case SQL_BATCH_ROW_COUNT:
 	len = 4;
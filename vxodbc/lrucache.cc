@@ -0,0 +1,145 @@
+/*
+ * Description:	This module contains the hashed LRU list that the
+ *		per-connection caches are built on (see "lrucache.h").
+ */
+
+#include "lrucache.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*	FNV-1a */
+UInt4 LRU_hash(const char *s, size_t len)
+{
+    UInt4 h = 2166136261U;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+	h = (h ^ (UCHAR) s[i]) * 16777619U;
+    return h;
+}
+
+
+/*	For keys that compare case-insensitively, like table names */
+UInt4 LRU_hash_nocase(const char *s)
+{
+    UInt4 h = 2166136261U;
+
+    for (; *s; s++)
+	h = (h ^ (UCHAR) tolower((UCHAR) * s)) * 16777619U;
+    return h;
+}
+
+
+BOOL LRU_init(LRUCache * self)
+{
+    memset(self, 0, sizeof(*self));
+    self->num_buckets = LRU_INITIAL_BUCKETS;
+    self->buckets = (LRUEntry **) calloc(sizeof(LRUEntry *),
+					 self->num_buckets);
+    return NULL != self->buckets;
+}
+
+
+/*	Only the buckets; the entries belong to whoever put them there */
+void LRU_free(LRUCache * self)
+{
+    free(self->buckets);
+    self->buckets = NULL;
+}
+
+
+static void LRU_unlink(LRUCache * self, LRUEntry * entry)
+{
+    if (entry->prev)
+	entry->prev->next = entry->next;
+    else
+	self->head = entry->next;
+    if (entry->next)
+	entry->next->prev = entry->prev;
+    else
+	self->tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+
+static void LRU_push_front(LRUCache * self, LRUEntry * entry)
+{
+    entry->prev = NULL;
+    entry->next = self->head;
+    if (self->head)
+	self->head->prev = entry;
+    else
+	self->tail = entry;
+    self->head = entry;
+}
+
+
+/*
+ *	Double the number of buckets once there are more entries than
+ *	buckets.  If there's no memory for that, the chains just get longer.
+ */
+static void LRU_grow(LRUCache * self)
+{
+    UInt4 num_buckets = self->num_buckets * 2;
+    LRUEntry **buckets, *entry;
+
+    buckets = (LRUEntry **) calloc(sizeof(LRUEntry *), num_buckets);
+    if (!buckets)
+	return;
+    for (entry = self->head; entry; entry = entry->next)
+    {
+	entry->hnext = buckets[entry->hash & (num_buckets - 1)];
+	buckets[entry->hash & (num_buckets - 1)] = entry;
+    }
+    free(self->buckets);
+    self->buckets = buckets;
+    self->num_buckets = num_buckets;
+}
+
+
+/*	Add entry as the newest */
+void LRU_add(LRUCache * self, LRUEntry * entry, UInt4 hash)
+{
+    LRUEntry **bucket;
+
+    if ((UInt4) self->count >= self->num_buckets)
+	LRU_grow(self);
+    entry->hash = hash;
+    bucket = &LRU_bucket(self, hash);
+    entry->hnext = *bucket;
+    *bucket = entry;
+    LRU_push_front(self, entry);
+    self->count++;
+}
+
+
+/*	Take entry out, leaving it with no links; freeing it is up to the caller */
+void LRU_remove(LRUCache * self, LRUEntry * entry)
+{
+    LRUEntry **pp;
+
+    for (pp = &LRU_bucket(self, entry->hash); *pp; pp = &(*pp)->hnext)
+    {
+	if (*pp == entry)
+	{
+	    *pp = entry->hnext;
+	    break;
+	}
+    }
+    entry->hnext = NULL;
+    LRU_unlink(self, entry);
+    self->count--;
+}
+
+
+/*	Make entry the newest, since it's just been used */
+void LRU_touch(LRUCache * self, LRUEntry * entry)
+{
+    if (entry != self->head)
+    {
+	LRU_unlink(self, entry);
+	LRU_push_front(self, entry);
+    }
+}
@@ -0,0 +1,57 @@
+/* File:			lrucache.h
+ *
+ * Description:		See "lrucache.cc"
+ *
+ * Comments:		See "notice.txt" for copyright and license information.
+ *
+ */
+
+#ifndef __LRUCACHE_H__
+#define __LRUCACHE_H__
+
+#include "psqlodbc.h"
+
+#include <stddef.h>
+
+/*
+ *	The links a cached thing needs.  It must be the thing's first
+ *	member, so that an LRUEntry pointer is also a pointer to the thing.
+ */
+typedef struct LRUEntry_ LRUEntry;
+struct LRUEntry_
+{
+	UInt4		hash;
+	LRUEntry	*prev;		/* neighbours in the LRU list, */
+	LRUEntry	*next;		/* newest first */
+	LRUEntry	*hnext;		/* next in its hash bucket */
+};
+
+/*
+ *	Entries hashed for lookup and kept in LRU order, so the oldest can
+ *	be dropped.  What the key is, how entries compare and how they're
+ *	freed is up to the caches built on this (the prepared statement,
+ *	catalog and column info caches), which also do their own locking.
+ */
+typedef struct
+{
+	LRUEntry	*head;
+	LRUEntry	*tail;
+	LRUEntry	**buckets;
+	UInt4		num_buckets;	/* always a power of two */
+	int		count;
+} LRUCache;
+
+#define	LRU_INITIAL_BUCKETS	64
+
+/*	Where to start looking for an entry with this hash; follow hnext */
+#define LRU_bucket(self, h)	((self)->buckets[(h) & ((self)->num_buckets - 1)])
+
+UInt4		LRU_hash(const char *s, size_t len);
+UInt4		LRU_hash_nocase(const char *s);
+BOOL		LRU_init(LRUCache *self);
+void		LRU_free(LRUCache *self);
+void		LRU_add(LRUCache *self, LRUEntry *entry, UInt4 hash);
+void		LRU_remove(LRUCache *self, LRUEntry *entry);
+void		LRU_touch(LRUCache *self, LRUEntry *entry);
+
+#endif
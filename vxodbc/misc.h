@@ -75,8 +75,17 @@ extern "C" {
 #define MYLOGDIR			"c:\\temp"
 #endif /* WIN32 */
 
+/*
+ *	Nonzero (1 for Debug1, up to 5 for Debug5) only while mylog()/qlog()
+ *	output would actually go somewhere.  The macros check these before
+ *	evaluating their arguments, so disabled logging costs one load and a
+ *	branch, with no formatting or locking.
+ */
+extern int mylog_level, qlog_level;
+
 #ifdef MY_LOG
-# define mylog(fmt, args...)       _mylog(__func__, __LINE__, fmt, ## args)
+# define mylog(fmt, args...) \
+	(mylog_level ? _mylog(__func__, __LINE__, fmt, ## args) : 0)
 # define forcelog(fmt, args...) _forcelog(__func__, __LINE__, fmt, ## args)
   extern int _mylog(const char *file, int line, const char *fmt, ...);
   extern int _forcelog(const char *file, int line, const char *fmt, ...);
@@ -84,10 +93,11 @@ extern "C" {
 # define mylog(fmt, args...)
 #endif /* MY_LOG */
     
-#define	inolog	if (get_mylog() > 1) mylog /* for really temporary debug */
+#define	inolog	if (mylog_level > 1) mylog /* for really temporary debug */
 
 #ifdef Q_LOG
-# define qlog(fmt, args...)  _qlog(__func__, __LINE__, fmt, ## args)
+# define qlog(fmt, args...) \
+	(qlog_level ? _qlog(__func__, __LINE__, fmt, ## args) : 0)
   extern int _qlog(const char *file, int line, const char *fmt, ...);
 #else /* !Q_LOG */
 # define qlog(fmt, args...)
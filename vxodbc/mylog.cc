@@ -30,15 +30,28 @@ static CRITICAL_SECTION qlog_cs, mylog_cs;
 static pthread_mutex_t qlog_cs, mylog_cs;
 #endif				/* WIN_MULTITHREAD_SUPPORT */
 static int mylog_on = 0, qlog_on = 0;
+int mylog_level = 0, qlog_level = 0;
 
 int get_mylog(void)
 {
-    return mylog_on;
+    return mylog_level;
 }
 
 int get_qlog(void)
 {
-    return qlog_on;
+    return qlog_level;
+}
+
+/*
+ *	Work out whether mylog()/qlog() output is wanted, and would get past
+ *	the log's level filter.  Called whenever either might have changed.
+ */
+static void update_log_levels()
+{
+    int level = wvlog_debug_level();
+
+    mylog_level = mylog_on ? level : 0;
+    qlog_level = qlog_on ? level : 0;
 }
 
 void logs_on_off(int cnopen, int mylog_onoff, int qlog_onoff)
@@ -72,6 +85,7 @@ void logs_on_off(int cnopen, int mylog_onoff, int qlog_onoff)
 	qlog_on = 0;
     else
 	qlog_on = 1;
+    update_log_levels();
     LEAVE_QLOG_CS;
     LEAVE_MYLOG_CS;
 }
@@ -100,8 +114,8 @@ int _mylog(const char *file, int line, const char *fmt, ...)
 {
     va_list args;
 
-//      if (!mylog_on)  return;
-    
+    if (!mylog_level)
+	return 0;
     va_start(args, fmt);
     _vmylog(file, line, fmt, args);
     va_end(args);
@@ -123,6 +137,7 @@ static void mylog_initialize()
 static void mylog_finalize()
 {
     mylog_on = 0;
+    mylog_level = 0;
     wvlog_close();
     DELETE_MYLOG_CS;
 }
@@ -143,6 +158,9 @@ static void mylog_finalize()
 int _qlog(const char *file, int line, const char *fmt, ...)
 {
     va_list args;
+
+    if (!qlog_level)
+	return 0;
     va_start(args, fmt);
     _vmylog(file, line, fmt, args);
     va_end(args);
@@ -155,6 +173,7 @@ static void qlog_initialize()
 static void qlog_finalize()
 {
     qlog_on = 0;
+    qlog_level = 0;
     DELETE_QLOG_CS;
 }
 #else
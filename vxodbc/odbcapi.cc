@@ -264,7 +264,7 @@ SQLExecDirect(HSTMT StatementHandle,
     SC_clear_error(stmt);
     if (PG_VERSION_GE(SC_get_conn(stmt), 7.4))
 	flag |= PODBC_WITH_HOLD;
-    if (SC_opencheck(stmt, func))
+    if (!SC_is_async_pending(stmt) && SC_opencheck(stmt, func))
 	ret = SQL_ERROR;
     else
     {
@@ -290,7 +290,7 @@ RETCODE SQL_API SQLExecute(HSTMT StatementHandle)
     SC_clear_error(stmt);
     if (PG_VERSION_GE(SC_get_conn(stmt), 7.4))
 	flag |= PODBC_WITH_HOLD;
-    if (SC_opencheck(stmt, func))
+    if (!SC_is_async_pending(stmt) && SC_opencheck(stmt, func))
 	ret = SQL_ERROR;
     else
     {
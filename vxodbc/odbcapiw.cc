@@ -10,6 +10,12 @@
 #include "connection.h"
 #include "statement.h"
 
+/*
+ * Statements short enough to fit here even as all-3-byte UTF-8 get
+ * converted on the stack rather than in a malloc()ed copy.
+ */
+#define	STMT_TEXT_BUFSIZE	4096
+
 RETCODE SQL_API SQLColumnsW(HSTMT StatementHandle,
 			    SQLWCHAR * CatalogName,
 			    SQLSMALLINT NameLength1,
@@ -288,19 +294,20 @@ RETCODE SQL_API SQLExecDirectW(HSTMT StatementHandle,
 {
     CSTR func = "SQLExecDirectW";
     RETCODE ret;
-    char *stxt;
+    char *stxt, stxtbuf[STMT_TEXT_BUFSIZE];
     SQLLEN slen;
     StatementClass *stmt = (StatementClass *) StatementHandle;
     UWORD flag = 0;
     mylog("Start\n");
 
-    stxt = ucs2_to_utf8(StatementText, TextLength, &slen, FALSE);
+    stxt = ucs2_to_utf8_buf(StatementText, TextLength, &slen, FALSE,
+			    stxtbuf, sizeof(stxtbuf));
     ENTER_STMT_CS(stmt);
     SC_clear_error(stmt);
     if (PG_VERSION_GE(SC_get_conn(stmt), 7.4))
 	flag |= PODBC_WITH_HOLD;
     StartRollbackState(stmt);
-    if (SC_opencheck(stmt, func))
+    if (!SC_is_async_pending(stmt) && SC_opencheck(stmt, func))
 	ret = SQL_ERROR;
     else
 	ret =
@@ -309,7 +316,7 @@ RETCODE SQL_API SQLExecDirectW(HSTMT StatementHandle,
 			     flag);
     ret = DiscardStatementSvp(stmt, ret, FALSE);
     LEAVE_STMT_CS(stmt);
-    if (stxt)
+    if (stxt && stxt != stxtbuf)
 	free(stxt);
     return ret;
 }
@@ -398,11 +405,12 @@ RETCODE SQL_API SQLPrepareW(HSTMT StatementHandle,
 {
     StatementClass *stmt = (StatementClass *) StatementHandle;
     RETCODE ret;
-    char *stxt;
+    char *stxt, stxtbuf[STMT_TEXT_BUFSIZE];
     SQLLEN slen;
     mylog("Start\n");
 
-    stxt = ucs2_to_utf8(StatementText, TextLength, &slen, FALSE);
+    stxt = ucs2_to_utf8_buf(StatementText, TextLength, &slen, FALSE,
+			    stxtbuf, sizeof(stxtbuf));
     ENTER_STMT_CS(stmt);
     SC_clear_error(stmt);
     StartRollbackState(stmt);
@@ -410,7 +418,7 @@ RETCODE SQL_API SQLPrepareW(HSTMT StatementHandle,
 			(const UCHAR *)stxt, (SQLINTEGER)slen);
     ret = DiscardStatementSvp(stmt, ret, FALSE);
     LEAVE_STMT_CS(stmt);
-    if (stxt)
+    if (stxt && stxt != stxtbuf)
 	free(stxt);
     return ret;
 }
@@ -30,7 +30,16 @@ set_statement_option(ConnectionClass * conn,
 	ci = &(SC_get_conn(stmt)->connInfo);
     switch (fOption)
     {
-    case SQL_ASYNC_ENABLE:	/* ignored */
+    case SQL_ASYNC_ENABLE:
+	mylog("SetStmtOption: SQL_ASYNC_ENABLE = %d\n", vParam);
+	setval = (SQL_ASYNC_ENABLE_ON == vParam) ?
+	    SQL_ASYNC_ENABLE_ON : SQL_ASYNC_ENABLE_OFF;
+	if (conn)
+	    conn->stmtOptions.async_enable = (SQLUINTEGER) setval;
+	if (stmt)
+	    stmt->options.async_enable = (SQLUINTEGER) setval;
+	if (setval != vParam)
+	    changed = TRUE;
 	break;
 
     case SQL_BIND_TYPE:
@@ -691,8 +700,8 @@ PGAPI_GetStmtOption(HSTMT hstmt,
 
 	break;
 
-    case SQL_ASYNC_ENABLE:	/* NOT SUPPORTED */
-	*((SQLINTEGER *) pvParam) = SQL_ASYNC_ENABLE_OFF;
+    case SQL_ASYNC_ENABLE:
+	*((SQLINTEGER *) pvParam) = stmt->options.async_enable;
 	break;
 
     case SQL_BIND_TYPE:
@@ -25,12 +25,12 @@
 #include "pgtypes.h"
 #include "pgapifunc.h"
 #include "catfunc.h"
+#include "colicache.h"
 
 #include "multibyte.h"
 
 #define FLD_INCR	32
 #define TAB_INCR	8
-#define COLI_INCR	16
 
 static char *getNextToken(int ccsc, char escape_in_literal, char *s,
 			  char *token, int smax, char *delim,
@@ -503,6 +503,20 @@ void SC_initialize_cols_info(StatementClass * stmt, BOOL DCdestroy,
     /* Free the parsed table information */
     if (stmt->ti)
     {
+	ConnectionClass *conn = SC_get_conn(stmt);
+	int i;
+
+	/* No connection means it's being torn down, so no locking */
+	for (i = 0; i < stmt->ntab; i++)
+	{
+	    if (!stmt->ti[i] || !stmt->ti[i]->col_info)
+		continue;
+	    if (conn)
+		CC_release_col_info(conn, stmt->ti[i]->col_info);
+	    else
+		COLI_release(stmt->ti[i]->col_info);
+	    stmt->ti[i]->col_info = NULL;
+	}
 	TI_Destructor(stmt->ti, stmt->ntab);
 	free(stmt->ti);
 	stmt->ti = NULL;
@@ -672,13 +686,14 @@ static BOOL ColAttSet(StatementClass * stmt, TABLE_INFO * rti)
     return TRUE;
 }
 
+/*
+ *	Look for the table's SQLColumns info in the connection's cache.  A
+ *	*coli that's found comes with a reference for the caller.
+ */
 static BOOL
 getCOLIfromTable(ConnectionClass * conn, pgNAME * schema_name,
 		 pgNAME table_name, COL_INFO ** coli)
 {
-    int colidx;
-    BOOL found = FALSE;
-
     *coli = NULL;
     if (NAME_IS_NULL(table_name))
 	return TRUE;
@@ -693,24 +708,14 @@ getCOLIfromTable(ConnectionClass * conn, pgNAME * schema_name,
 	     * check the current_schema() when no
 	     * explicit schema name was specified.
 	     */
-	    for (colidx = 0; colidx < conn->ntables; colidx++)
+	    *coli = CC_find_col_info(conn, curschema,
+				     GET_NAME(table_name));
+	    if (*coli)
 	    {
-		if (!NAMEICMP
-		    (conn->col_info[colidx]->table_name, table_name)
-		    &&
-		    !stricmp(SAFE_NAME
-			     (conn->col_info[colidx]->schema_name),
-			     curschema))
-		{
-		    mylog
-			("FOUND col_info table='%s' current schema='%s'\n",
-			 PRINT_NAME(table_name), curschema);
-		    found = TRUE;
-		    STR_TO_NAME(*schema_name, curschema);
-		    break;
-		}
-	    }
-	    if (!found)
+		mylog("FOUND col_info table='%s' current schema='%s'\n",
+		      PRINT_NAME(table_name), curschema);
+		STR_TO_NAME(*schema_name, curschema);
+	    } else
 	    {
 		QResultClass *res;
 		char token[256];
@@ -742,37 +747,24 @@ getCOLIfromTable(ConnectionClass * conn, pgNAME * schema_name,
 		    return FALSE;
 	    }
 	}
-	if (!found && NAME_IS_VALID(*schema_name))
+	if (!*coli && NAME_IS_VALID(*schema_name))
 	{
-	    for (colidx = 0; colidx < conn->ntables; colidx++)
-	    {
-		if (!NAMEICMP
-		    (conn->col_info[colidx]->table_name, table_name)
-		    && !NAMEICMP(conn->col_info[colidx]->schema_name,
-				 *schema_name))
-		{
-		    mylog("FOUND col_info table='%s' schema='%s'\n",
-			  PRINT_NAME(table_name),
-			  PRINT_NAME(*schema_name));
-		    found = TRUE;
-		    break;
-		}
-	    }
+	    *coli = CC_find_col_info(conn, GET_NAME(*schema_name),
+				     GET_NAME(table_name));
+	    if (*coli)
+		mylog("FOUND col_info table='%s' schema='%s'\n",
+		      PRINT_NAME(table_name), PRINT_NAME(*schema_name));
 	}
     } else
     {
-	for (colidx = 0; colidx < conn->ntables; colidx++)
-	{
-	    if (!NAMEICMP
-		(conn->col_info[colidx]->table_name, table_name))
-	    {
-		mylog("FOUND col_info table='%s'\n", table_name);
-		found = TRUE;
-		break;
-	    }
-	}
+	/* Without schemas, a table of that name in any of them will do */
+	*coli = CC_find_col_info(conn, NULL, GET_NAME(table_name));
+	if (*coli)
+	    mylog("FOUND col_info table='%s'\n", PRINT_NAME(table_name));
     }
-    *coli = found ? conn->col_info[colidx] : NULL;
+    /* However many places it looked, that's one miss */
+    if (!*coli)
+	CC_col_info_missed(conn);
     return TRUE;		/* success */
 }
 
@@ -825,18 +817,12 @@ BOOL getCOLIfromTI(const char *func, ConnectionClass * conn,
     }
     if (greloid != 0)
     {
-	int colidx;
-
-	for (colidx = 0; colidx < conn->ntables; colidx++)
+	if (NULL != (wti->col_info = CC_find_col_info_oid(conn, greloid)))
 	{
-	    if (conn->col_info[colidx]->table_oid == greloid)
-	    {
-		mylog("FOUND col_info table=%ul\n", greloid);
-		found = TRUE;
-		wti->col_info = conn->col_info[colidx];
-		break;
-	    }
-	}
+	    mylog("FOUND col_info table=%ul\n", greloid);
+	    found = TRUE;
+	} else
+	    CC_col_info_missed(conn);
     } else
     {
 	if (!getCOLIfromTable
@@ -901,44 +887,17 @@ BOOL getCOLIfromTI(const char *func, ConnectionClass * conn,
 	    COL_INFO *coli;
 
 	    mylog("      Success\n");
-	    if (conn->ntables >= conn->coli_allocated)
-	    {
-		Int2 new_alloc;
-
-		new_alloc = conn->coli_allocated * 2;
-		if (new_alloc <= conn->ntables)
-		    new_alloc = COLI_INCR;
-		mylog("PARSE: Allocating col_info at ntables=%d\n",
-		      conn->ntables);
-
-		conn->col_info =
-		    (COL_INFO **) realloc(conn->col_info,
-					  new_alloc *
-					  sizeof(COL_INFO *));
-		if (!conn->col_info)
-		{
-		    if (stmt)
-			SC_set_error(stmt, STMT_NO_MEMORY_ERROR,
-				     "PGAPI_AllocStmt failed in parse_statement for col_info.",
-				     func);
-		    goto cleanup;
-		}
-		conn->coli_allocated = new_alloc;
-	    }
-
-	    mylog("PARSE: malloc at conn->col_info[%d]\n",
-		  conn->ntables);
-	    coli = conn->col_info[conn->ntables] =
-		(COL_INFO *) malloc(sizeof(COL_INFO));
+	    coli = (COL_INFO *) malloc(sizeof(COL_INFO));
 	    if (!coli)
 	    {
 		if (stmt)
 		    SC_set_error(stmt, STMT_NO_MEMORY_ERROR,
-				 "PGAPI_AllocStmt failed in parse_statement for col_info(2).",
+				 "PGAPI_AllocStmt failed in parse_statement for col_info.",
 				 func);
 		goto cleanup;
 	    }
 	    col_info_initialize(coli);
+	    coli->refcount = 1;	/* wti's */
 
 	    coli->result = res;
 	    if (res && QR_get_num_cached_tuples(res) > 0)
@@ -978,15 +937,14 @@ BOOL getCOLIfromTI(const char *func, ConnectionClass * conn,
 	     * make sure that the statement doesn't free it
 	     */
 	    SC_init_Result(col_stmt);
-
-	    conn->ntables++;
+	    CC_add_col_info(conn, coli);
 
 	    if (res && QR_get_num_cached_tuples(res) > 0)
 		inolog("oid item == %s\n",
 		       QR_get_value_backend_text(res, 0, 3));
 
-	    mylog("Created col_info table='%s', ntables=%d\n",
-		  PRINT_NAME(wti->table_name), conn->ntables);
+	    mylog("Created col_info table='%s'\n",
+		  PRINT_NAME(wti->table_name));
 	    /* Associate a table from the statement with a SQLColumn info */
 	    found = TRUE;
 	    wti->col_info = coli;
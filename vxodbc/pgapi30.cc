@@ -394,7 +394,7 @@ PGAPI_GetConnectAttr(HDBC ConnectionHandle,
     switch (Attribute)
     {
     case SQL_ATTR_ASYNC_ENABLE:
-	*((SQLINTEGER *) Value) = SQL_ASYNC_ENABLE_OFF;
+	*((SQLINTEGER *) Value) = conn->stmtOptions.async_enable;
 	break;
     case SQL_ATTR_AUTO_IPD:
 	*((SQLINTEGER *) Value) = SQL_FALSE;
@@ -622,7 +622,6 @@ PGAPI_SetConnectAttr(HDBC ConnectionHandle,
 	if (SQL_FALSE != Value)
 	    unsupported = TRUE;
 	break;
-    case SQL_ATTR_ASYNC_ENABLE:
     case SQL_ATTR_CONNECTION_DEAD:
     case SQL_ATTR_CONNECTION_TIMEOUT:
 	unsupported = TRUE;
@@ -792,7 +791,12 @@ RETCODE SQL_API
 PGAPI_BulkOperations(HSTMT hstmt, SQLSMALLINT operationX)
 {
     CSTR func = "PGAPI_BulkOperations";
-    SC_set_error((StatementClass *)hstmt, DESC_INTERNAL_ERROR, 
-	"Bulk operations are not yet supported.", func);
+    StatementClass *stmt = (StatementClass *) hstmt;
+
+    mylog("%s operation = %d\n", func, operationX);
+    if (SQL_ADD == operationX)
+	return SC_bulk_add(stmt);
+    SC_set_error(stmt, DESC_INTERNAL_ERROR,
+	"Only SQL_ADD bulk operations are supported.", func);
     return SQL_ERROR;
 }
@@ -0,0 +1,235 @@
+/*
+ * Description:	This module contains routines for parsing statements once
+ *		and keeping the results in a per-connection LRU cache (see
+ *		"prepcache.h").
+ */
+
+#include "prepcache.h"
+#include "connection.h"
+#include "convert.h"
+#include "statement.h"
+#include "misc.h"
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define	IS_WORD_CHAR(c)	(isalnum((UCHAR) (c)) || '_' == (c) || '@' == (c) \
+			 || '#' == (c) || '$' == (c))
+
+/*	Is p at the (lowercase) keyword, and not just part of a longer word? */
+static BOOL is_keyword(const char *statement, const char *p,
+		       const char *keyword, size_t len)
+{
+    return (p == statement || !IS_WORD_CHAR(p[-1]))
+	&& 0 == strnicmp(p, keyword, len) && !IS_WORD_CHAR(p[len]);
+}
+
+
+/*
+ *	Split statement up around its parameter markers.  Markers inside
+ *	quotes, [identifiers] and comments don't count.  Also work out
+ *	whether it's a single statement that can't return any rows: a lone
+ *	INSERT, UPDATE or DELETE without an OUTPUT clause, and whether it
+ *	might change the schema.
+ */
+static PreparedQuery *PQ_Constructor(const char *statement, size_t len)
+{
+    PreparedQuery *rv;
+    const char *p, *end;
+    Int2 count = 0;
+    BOOL multi = FALSE, output = FALSE, into = FALSE;
+
+    rv = (PreparedQuery *) calloc(sizeof(PreparedQuery), 1);
+    if (!rv)
+	return NULL;
+    rv->statement = (char *) malloc(len + 1);
+    if (!rv->statement)
+    {
+	free(rv);
+	return NULL;
+    }
+    memcpy(rv->statement, statement, len + 1);
+    rv->len = len;
+    rv->refcount = 1;
+
+    /* once to count the markers, then again to note where they are */
+    for (p = statement; *p;)
+    {
+	if (end = skip_sql_quoted(p), end != p)
+	    p = end;
+	else
+	{
+	    if ('?' == *p)
+		count++;
+	    else if (';' == *p && !multi)
+	    {
+		for (end = p + 1; isspace((UCHAR) * end); end++)
+		    ;
+		multi = ('\0' != *end);
+	    }
+	    else if (!output && is_keyword(statement, p, "output", 6))
+		output = TRUE;
+	    else if (!into && is_keyword(statement, p, "into", 4))
+		into = TRUE;
+	    p++;
+	}
+    }
+    rv->statement_type = statement_type(statement);
+    switch (rv->statement_type)
+    {
+    case STMT_TYPE_INSERT:
+    case STMT_TYPE_UPDATE:
+    case STMT_TYPE_DELETE:
+	/* ...unless it has an OUTPUT clause */
+	rv->no_result = !multi && !output;
+	rv->changes_schema = multi;
+	break;
+    case STMT_TYPE_SELECT:
+	/* SELECT ... INTO makes a table */
+	rv->changes_schema = multi || into;
+	break;
+    default:
+	/* CREATE, DROP, ALTER, procedures... */
+	rv->changes_schema = TRUE;
+	break;
+    }
+    if (count > 0)
+    {
+	rv->markers = (size_t *) malloc(sizeof(size_t) * count);
+	if (!rv->markers)
+	{
+	    free(rv->statement);
+	    free(rv);
+	    return NULL;
+	}
+	for (p = statement; *p;)
+	{
+	    if (end = skip_sql_quoted(p), end != p)
+		p = end;
+	    else if ('?' == *p++)
+		rv->markers[rv->num_params++] = p - 1 - statement;
+	}
+    }
+
+    return rv;
+}
+
+
+void PQ_release(PreparedQuery * self)
+{
+    if (!self || --self->refcount > 0)
+	return;
+    free(self->markers);
+    free(self->statement);
+    free(self);
+}
+
+
+PreparedCacheClass *PC_Constructor(int max_count)
+{
+    PreparedCacheClass *rv;
+
+    rv = (PreparedCacheClass *) calloc(sizeof(PreparedCacheClass), 1);
+    if (!rv)
+	return NULL;
+    if (!LRU_init(&rv->lru))
+    {
+	free(rv);
+	return NULL;
+    }
+    rv->max_count = max_count > 0 ? max_count : PC_DEFAULT_SIZE;
+
+    return rv;
+}
+
+
+void PC_Destructor(PreparedCacheClass * self)
+{
+    PreparedQuery *pq;
+
+    if (!self)
+	return;
+    mylog("PC_Destructor: %d entries, %u hits, %u misses\n",
+	  self->lru.count, self->hits, self->misses);
+    while (self->lru.tail)
+    {
+	pq = (PreparedQuery *) self->lru.tail;
+	LRU_remove(&self->lru, &pq->lru);
+	PQ_release(pq);
+    }
+    LRU_free(&self->lru);
+    free(self);
+}
+
+
+/*
+ *	Find (or parse and add) statement's PreparedQuery, and take a
+ *	reference to it for the caller, who must PQ_release() it.  When the
+ *	cache is full the least recently used entry is dropped; statements
+ *	still using it keep it alive until they let go.
+ */
+PreparedQuery *PC_get(PreparedCacheClass * self, const char *statement)
+{
+    size_t len = strlen(statement);
+    UInt4 hash = LRU_hash(statement, len);
+    LRUEntry *entry;
+    PreparedQuery *pq;
+
+    for (entry = LRU_bucket(&self->lru, hash); entry; entry = entry->hnext)
+    {
+	pq = (PreparedQuery *) entry;
+	if (entry->hash == hash && pq->len == len
+	    && 0 == memcmp(pq->statement, statement, len))
+	{
+	    self->hits++;
+	    LRU_touch(&self->lru, entry);
+	    pq->refcount++;
+	    return pq;
+	}
+    }
+
+    self->misses++;
+    if (pq = PQ_Constructor(statement, len), !pq)
+	return NULL;
+    if (self->lru.count >= self->max_count)
+    {
+	PreparedQuery *oldest = (PreparedQuery *) self->lru.tail;
+
+	LRU_remove(&self->lru, &oldest->lru);
+	PQ_release(oldest);
+    }
+    LRU_add(&self->lru, &pq->lru, hash);
+    pq->refcount++;
+
+    return pq;
+}
+
+
+/*	As PC_get(), under the connection's lock */
+PreparedQuery *CC_get_prepared(ConnectionClass * conn,
+			       const char *statement)
+{
+    PreparedQuery *pq;
+
+    CONNLOCK_ACQUIRE(conn);
+    pq = PC_get(conn->prepared, statement);
+    CONNLOCK_RELEASE(conn);
+
+    return pq;
+}
+
+
+void CC_release_prepared(ConnectionClass * conn, PreparedQuery * pq)
+{
+    if (!pq)
+	return;
+    if (!conn)
+    {
+	PQ_release(pq);
+	return;
+    }
+    CONNLOCK_ACQUIRE(conn);
+    PQ_release(pq);
+    CONNLOCK_RELEASE(conn);
+}
@@ -0,0 +1,61 @@
+/* File:			prepcache.h
+ *
+ * Description:		See "prepcache.cc"
+ *
+ * Comments:		See "notice.txt" for copyright and license information.
+ *
+ */
+
+#ifndef __PREPCACHE_H__
+#define __PREPCACHE_H__
+
+#include "psqlodbc.h"
+#include "lrucache.h"
+
+#include <stddef.h>
+
+/*
+ *	A statement's text parsed once, split up around its parameter
+ *	markers, so that running it again only costs formatting the
+ *	parameters.  Shared (read-only) by the cache and every statement
+ *	using it; all changes to refcount happen under the connection's
+ *	CONNLOCK.
+ */
+struct PreparedQuery_
+{
+	LRUEntry	lru;		/* must come first */
+	char		*statement;	/* the SQL text, which is also the key */
+	size_t		len;
+	Int2		num_params;
+	Int2		statement_type;	/* STMT_TYPE_xxx, from statement_type() */
+	char		no_result;	/* a lone INSERT, UPDATE or DELETE */
+	char		changes_schema;	/* DDL, SELECT INTO, or a batch */
+	size_t		*markers;	/* offset of each '?' in statement */
+	int		refcount;
+};
+
+/*	A connection's most recently used PreparedQuerys */
+struct PreparedCacheClass_
+{
+	LRUCache	lru;
+	int		max_count;
+	UInt4		hits;
+	UInt4		misses;
+};
+
+#define	PC_DEFAULT_SIZE		64
+
+#define PQ_get_num_params(self)	(self->num_params)
+#define PQ_get_statement_type(self)	(self->statement_type)
+#define PQ_is_no_result(self)	(self->no_result)
+#define PQ_changes_schema(self)	(self->changes_schema)
+
+PreparedCacheClass *PC_Constructor(int max_count);
+void		PC_Destructor(PreparedCacheClass *self);
+PreparedQuery	*PC_get(PreparedCacheClass *self, const char *statement);
+void		PQ_release(PreparedQuery *self);
+
+PreparedQuery	*CC_get_prepared(ConnectionClass *conn, const char *statement);
+void		CC_release_prepared(ConnectionClass *conn, PreparedQuery *pq);
+
+#endif
@@ -317,6 +317,13 @@ typedef struct BindInfoClass_ BindInfoClass;
 typedef struct ParameterInfoClass_ ParameterInfoClass;
 typedef struct ParameterImplClass_ ParameterImplClass;
 typedef struct ColumnInfoClass_ ColumnInfoClass;
+typedef struct ColumnDataClass_ ColumnDataClass;
+typedef struct ArenaClass_ ArenaClass;
+typedef struct PreparedQuery_ PreparedQuery;
+typedef struct PreparedCacheClass_ PreparedCacheClass;
+typedef struct CatalogEntry_ CatalogEntry;
+typedef struct CatalogCacheClass_ CatalogCacheClass;
+typedef struct ColInfoCacheClass_ ColInfoCacheClass;
 typedef struct EnvironmentClass_ EnvironmentClass;
 typedef struct TupleField_ TupleField;
 typedef struct KeySet_ KeySet;
@@ -345,6 +352,7 @@ typedef struct StatementOptions_
 	SQLUINTEGER		use_bookmarks;
 	void			*bookmark_ptr;
 	SQLUINTEGER		metadata_id;
+	SQLUINTEGER		async_enable;
 } StatementOptions;
 
 /*	Used to pass extra query info to send_query */
@@ -412,6 +420,7 @@ const pthread_mutexattr_t *getMutexAttr(void);
 #define WCLEN sizeof(SQLWCHAR)
 SQLULEN	ucs2strlen(const SQLWCHAR *ucs2str);
 char	*ucs2_to_utf8(const SQLWCHAR *ucs2str, SQLLEN ilen, SQLLEN *olen, BOOL tolower);
+char	*ucs2_to_utf8_buf(const SQLWCHAR *ucs2str, SQLLEN ilen, SQLLEN *olen, BOOL tolower, char *buf, SQLLEN bufsize);
 SQLULEN	utf8_to_ucs2_lf(const char * utf8str, SQLLEN ilen, BOOL lfconv, SQLWCHAR *ucs2str, SQLULEN buflen);
 #define	utf8_to_ucs2(utf8str, ilen, ucs2str, buflen) utf8_to_ucs2_lf(utf8str, ilen, FALSE, ucs2str, buflen)
 #endif /* UNICODE_SUPPORT */
@@ -132,6 +132,8 @@ QResultClass *QR_Constructor()
 	    return NULL;
 	}
 	rv->backend_tuples = NULL;
+	rv->coldata = NULL;
+	rv->arena = NULL;
 	rv->sqlstate[0] = '\0';
 	rv->message = NULL;
 	rv->command = NULL;
@@ -178,6 +180,7 @@ QResultClass *QR_Constructor()
 	rv->dl_count = 0;
 	rv->deleted = NULL;
 	rv->deleted_keyset = NULL;
+	rv->stream = NULL;
     }
 
     mylog("exit QR_Constructor\n");
@@ -194,6 +197,9 @@ void QR_close_result(QResultClass * self, BOOL destroy)
 	return;
     mylog("QResult: in QR_close_result\n");
 
+    /* Nobody is going to want the rest of the rows now */
+    QR_close_stream(self);
+
     /*
      * If conn is defined, then we may have used "backend_tuples", so in
      * case we need to, free it up.  Also, close the cursor.
@@ -325,15 +331,21 @@ void QR_add_notice(QResultClass * self, const char *msg)
 }
 
 
-TupleField *QR_AddNew(QResultClass * self)
+/*
+ *	Add num_rows empty rows to backend_tuples in one go, and return the
+ *	first of them (the rest follow it, num_fields apart).  Used to add a
+ *	whole chunk of rows without growing the array for each one.
+ */
+TupleField *QR_AddNewRows(QResultClass * self, SQLLEN num_rows)
 {
-    size_t alloc;
+    SQLULEN alloc, need;
     UInt4 num_fields;
+    TupleField *first;
 
-    if (!self)
+    if (!self || num_rows <= 0)
 	return NULL;
-    inolog("QR_AddNew %dth row(%d fields) alloc=%d\n",
-	   self->num_cached_rows, QR_NumResultCols(self),
+    inolog("QR_AddNewRows %dth row(%d fields) +%d alloc=%d\n",
+	   self->num_cached_rows, QR_NumResultCols(self), num_rows,
 	   self->count_backend_allocated);
     if (num_fields = QR_NumResultCols(self), !num_fields)
 	return NULL;
@@ -342,32 +354,140 @@ TupleField *QR_AddNew(QResultClass * self)
 	self->num_fields = num_fields;
 	QR_set_reached_eof(self);
     }
-    alloc = self->count_backend_allocated;
     if (!self->backend_tuples)
     {
 	self->num_cached_rows = 0;
-	alloc = TUPLE_MALLOC_INC;
-	self->backend_tuples = (TupleField *)
-	    malloc(alloc * sizeof(TupleField) * num_fields);
-    } else if (self->num_cached_rows >= self->count_backend_allocated)
+	self->count_backend_allocated = 0;
+    }
+    need = self->num_cached_rows + num_rows;
+    if (need > self->count_backend_allocated)
     {
-	alloc = self->count_backend_allocated * 2;
-	self->backend_tuples = (TupleField *)
+	TupleField *tuples;
+
+	alloc = self->count_backend_allocated ?
+	    self->count_backend_allocated * 2 : TUPLE_MALLOC_INC;
+	while (alloc < need)
+	    alloc *= 2;
+	tuples = (TupleField *)
 	    realloc(self->backend_tuples,
 		    alloc * sizeof(TupleField) * num_fields);
+	if (!tuples)
+	    return NULL;
+	self->backend_tuples = tuples;
+	self->count_backend_allocated = alloc;
     }
-    self->count_backend_allocated = alloc;
 
-    if (self->backend_tuples)
+    first = self->backend_tuples + num_fields * self->num_cached_rows;
+    memset(first, 0, num_rows * num_fields * sizeof(TupleField));
+    self->num_cached_rows += num_rows;
+    self->ad_count += num_rows;
+
+    return first;
+}
+
+TupleField *QR_AddNew(QResultClass * self)
+{
+    return QR_AddNewRows(self, 1);
+}
+
+/*
+ * Like QR_AddNew(), but for results whose rows are kept in a typed,
+ * column-major ColumnDataClass instead of backend_tuples.  Returns the
+ * (zero-based) number of the new row, whose values are then filled in
+ * with the CD_set_* functions, or -1 on failure.
+ */
+SQLLEN QR_AddNewColumnar(QResultClass * self)
+{
+    UInt4 num_fields;
+
+    if (!self)
+	return -1;
+    if (num_fields = QR_NumResultCols(self), !num_fields)
+	return -1;
+    if (!self->coldata && !QR_reserve_columnar(self, 0))
+	return -1;
+    if (self->num_fields <= 0)
     {
-	memset(self->backend_tuples +
-	       num_fields * self->num_cached_rows, 0,
-	       num_fields * sizeof(TupleField));
-	self->num_cached_rows++;
-	self->ad_count++;
+	self->num_fields = num_fields;
+	QR_set_reached_eof(self);
     }
-    return self->backend_tuples + num_fields * (self->num_cached_rows -
-						1);
+    if (!CD_add_row(self->coldata))
+	return -1;
+    self->num_cached_rows++;
+    self->ad_count++;
+
+    return self->num_cached_rows - 1;
+}
+
+/*
+ *	Make room for num_rows more QR_AddNewColumnar() rows at once.
+ */
+BOOL QR_reserve_columnar(QResultClass * self, SQLLEN num_rows)
+{
+    if (!self || !QR_NumResultCols(self))
+	return FALSE;
+    if (!self->coldata)
+    {
+	if (self->backend_tuples)
+	    return FALSE;	/* can't mix the two */
+	if (self->coldata = CD_Constructor(self->fields), !self->coldata)
+	    return FALSE;
+	self->num_cached_rows = 0;
+    }
+    return num_rows <= 0 || CD_reserve_rows(self->coldata, num_rows);
+}
+
+/*
+ *	Make room in the arena for the values of num_rows more rows, going by
+ *	how big the rows so far have been.  Called before adding a chunk of
+ *	rows, so that the whole chunk lands in one block.
+ */
+BOOL QR_reserve_arena(QResultClass * self, SQLLEN num_rows)
+{
+    size_t per_row;
+
+    if (num_rows <= 0)
+	return TRUE;
+    if (!self->arena)
+    {
+	if (self->arena = AR_Constructor(0), !self->arena)
+	    return FALSE;
+    }
+    if (self->num_cached_rows > 0 && AR_get_total_used(self->arena) > 0)
+	per_row = AR_get_total_used(self->arena) / self->num_cached_rows;
+    else
+	per_row = 16 * (QR_NumResultCols(self) > 0 ? QR_NumResultCols(self) : 1);
+
+    return AR_reserve(self->arena, per_row * num_rows);
+}
+
+/*
+ *	Set a value of a row from QR_AddNew(), copying it into the arena.
+ *	A result's values must either all come from here or all be malloc'd
+ *	(with set_tuplefield_string() and friends), since the arena's are
+ *	never freed one by one.
+ */
+BOOL QR_set_tuplefield_string(QResultClass * self, TupleField * field,
+			      const char *str, size_t len)
+{
+    if (!str)
+    {
+	set_tuplefield_null(field);
+	return TRUE;
+    }
+    if (!self->arena)
+    {
+	if (self->arena = AR_Constructor(0), !self->arena)
+	    return FALSE;
+    }
+    if (field->value = AR_strndup(self->arena, str, len), !field->value)
+    {
+	field->len = 0;
+	return FALSE;
+    }
+    field->len = (Int4) len;	/* PG restriction */
+
+    return TRUE;
 }
 
 void QR_free_memory(QResultClass * self)
@@ -379,12 +499,24 @@ void QR_free_memory(QResultClass * self)
 
     if (self->backend_tuples)
     {
-	ClearCachedRows(self->backend_tuples, num_fields,
-			num_backend_rows);
+	/* values from the arena go all at once, below */
+	if (!self->arena)
+	    ClearCachedRows(self->backend_tuples, num_fields,
+			    num_backend_rows);
 	free(self->backend_tuples);
 	self->count_backend_allocated = 0;
 	self->backend_tuples = NULL;
     }
+    if (self->arena)
+    {
+	AR_Destructor(self->arena);
+	self->arena = NULL;
+    }
+    if (self->coldata)
+    {
+	CD_Destructor(self->coldata);
+	self->coldata = NULL;
+    }
     if (self->keyset)
     {
 	ConnectionClass *conn = QR_get_conn(self);
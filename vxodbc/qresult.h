@@ -5,9 +5,12 @@
 
 #include "connection.h"
 #include "columninfo.h"
+#include "coldata.h"
+#include "arena.h"
 #include "tuple.h"
 
 #ifdef	__cplusplus
+class VxResultSet;
 extern	"C" {
 #endif
 
@@ -71,6 +74,9 @@ struct QResultClass_
 	char	*notice;
 
 	TupleField *backend_tuples;	/* data from the backend (the tuple cache) */
+	ArenaClass *arena;		/* if set, backend_tuples' values all
+					 * live here rather than being malloc'd */
+	ColumnDataClass *coldata;	/* or, the same kept typed and by column */
 	TupleField *tupleField;		/* current backend tuple being retrieved */
 
 	char	pstatus;		/* processing status */
@@ -99,6 +105,7 @@ struct QResultClass_
 	SQLULEN		*updated;	/* updated index info */
 	KeySet		*updated_keyset;	/* uddated keyset info */
 	TupleField	*updated_tuples;	/* uddated data by myself */
+	VxResultSet	*stream;	/* versaplexd is still sending us rows */
 };
 
 enum {
@@ -184,6 +191,9 @@ do { \
 #define QR_get_cursor(self)				(self->cursor_name)
 #define QR_get_rowstart_in_cache(self)			(self->base)
 #define QR_once_reached_eof(self)	((self->pstatus & FQR_REACHED_EOF) != 0)
+#define QR_is_streaming(self)		(NULL != self->stream)
+#define QR_has_coldata(self)		(NULL != self->coldata)
+#define QR_has_arena(self)		(NULL != self->arena)
 #define QR_is_fetching_tuples(self)	((self->pstatus & FQR_FETCHING_TUPLES) != 0)
 #define	QR_has_valid_base(self)		(0 != (self->pstatus & FQR_HAS_VALID_BASE))
 
@@ -205,6 +215,11 @@ do { \
 QResultClass	*QR_Constructor(void);
 void		QR_Destructor(QResultClass *self);
 TupleField	*QR_AddNew(QResultClass *self);
+TupleField	*QR_AddNewRows(QResultClass *self, SQLLEN num_rows);
+SQLLEN		QR_AddNewColumnar(QResultClass *self);
+BOOL		QR_reserve_columnar(QResultClass *self, SQLLEN num_rows);
+BOOL		QR_reserve_arena(QResultClass *self, SQLLEN num_rows);
+BOOL		QR_set_tuplefield_string(QResultClass *self, TupleField *field, const char *str, size_t len);
 void		QR_close_result(QResultClass *self, BOOL destroy);
 void		QR_free_memory(QResultClass *self);
 void		QR_set_command(QResultClass *self, const char *msg);
@@ -224,6 +239,10 @@ void		QR_set_position(QResultClass *self, SQLLEN pos);
 void		QR_set_cursor(QResultClass *self, const char *name);
 SQLLEN		getNthValid(const QResultClass *self, SQLLEN sta, UWORD orientation, SQLULEN nth, SQLLEN *nearest);
 
+/* Streamed results (vxhelpers.cc) */
+void		QR_fetch_more(QResultClass *self, SQLLEN num_rows); /* num_rows < 0 means all of them */
+void		QR_close_stream(QResultClass *self);
+
 #define QR_MALLOC_return_with_error(t, tp, s, a, m, r) \
 do { \
  	if (t = (tp *) malloc(s), NULL == t) \
@@ -62,6 +62,11 @@ RETCODE SQL_API PGAPI_RowCount(HSTMT hstmt, SQLLEN FAR * pcrow)
 	    *pcrow = res->recent_processed_row_count;
 	    mylog("**** %s: THE ROWS: *pcrow = %d\n", func, *pcrow);
 
+	    return SQL_SUCCESS;
+	} else if (QR_is_streaming(res))
+	{
+	    /* we won't know until the last chunk arrives */
+	    *pcrow = -1;
 	    return SQL_SUCCESS;
 	} else if (QR_NumResultCols(res) > 0)
 	{
@@ -750,6 +755,7 @@ PGAPI_GetData(HSTMT hstmt,
     SQLLEN num_rows;
     OID field_type;
     void *value = NULL;
+    SQLLEN curt = 0;
     RETCODE result = SQL_SUCCESS;
     char get_bookmark = FALSE;
     ConnInfo *ci;
@@ -861,9 +867,11 @@ PGAPI_GetData(HSTMT hstmt,
 	}
 	mylog("     num_rows = %d\n", num_rows);
 
-	if (!get_bookmark)
+	if (!get_bookmark && QR_has_coldata(res))
+	    curt = GIdx2CacheIdx(stmt->currTuple, stmt, res);
+	else if (!get_bookmark)
 	{
-	    SQLLEN curt = GIdx2CacheIdx(stmt->currTuple, stmt, res);
+	    curt = GIdx2CacheIdx(stmt->currTuple, stmt, res);
 	    value = QR_get_value_backend_row(res, curt, icol);
 	    inolog("currT=%d base=%d rowset=%d\n", stmt->currTuple,
 		   QR_get_rowstart_in_cache(res),
@@ -907,9 +915,14 @@ PGAPI_GetData(HSTMT hstmt,
 
     SC_set_current_col(stmt, icol);
 
-    result = copy_and_convert_field(stmt, field_type, value,
-				    target_type, rgbValue, cbValueMax,
-				    pcbValue, pcbValue);
+    if (QR_has_coldata(res))
+	result = copy_and_convert_coldata(stmt, field_type, res->coldata,
+					  curt, icol, target_type, rgbValue,
+					  cbValueMax, pcbValue, pcbValue);
+    else
+	result = copy_and_convert_field(stmt, field_type, value,
+					target_type, rgbValue, cbValueMax,
+					pcbValue, pcbValue);
 
     switch (result)
     {
@@ -1263,6 +1276,7 @@ PGAPI_ExtendedFetch(HSTMT hstmt,
     char truncated, error, should_set_rowset_start = FALSE;
     ConnInfo *ci;
     SQLLEN currp;
+    SQLULEN nrows;
     UWORD pstatus;
     BOOL currp_is_valid, reached_eof;
 
@@ -1346,6 +1360,26 @@ PGAPI_ExtendedFetch(HSTMT hstmt,
     if (pcrow)
 	*pcrow = 0;
 
+    /*
+     * Pull in enough of a streamed result for this rowset.  Anything but
+     * moving forward may need to know where the end is, so get it all.
+     */
+    if (QR_is_streaming(res))
+    {
+	if (SQL_FETCH_NEXT == fFetchType)
+	{
+	    SQLLEN want = SC_get_rowset_start(stmt);
+
+	    if (want < 0)
+		want = 0;
+	    else
+		want += (stmt->save_rowset_size > 0 ?
+			 stmt->save_rowset_size : rowsetSize);
+	    QR_fetch_more(res, want + rowsetSize + 1);
+	} else
+	    QR_fetch_more(res, -1);
+    }
+
     num_tuples = QR_get_num_total_tuples(res);
     reached_eof = QR_once_reached_eof(res) && QR_get_cursor(res);
 
@@ -1634,6 +1668,23 @@ PGAPI_ExtendedFetch(HSTMT hstmt,
 
     mylog("PGAPI_ExtendedFetch: new currTuple = %d\n", stmt->currTuple);
 
+    /* Whole rowsets of simple bound columns can skip SC_fetch */
+    if (rowsetSize > 1 && SC_fetch_rowset(stmt, rowsetSize, &nrows, &result))
+    {
+	for (i = 0; rgfRowStatus && i < (SQLLEN) nrows; i++)
+	    rgfRowStatus[i] = SQL_ROW_SUCCESS;
+	stmt->last_fetch_count = stmt->last_fetch_count_include_ommitted =
+	    nrows;
+	stmt->bind_row = 0;
+	stmt->currTuple = RowIdx2GIdx(0, stmt);
+	if (pcrow)
+	    *pcrow = nrows;
+	if (SQL_SUCCESS == result
+	    && SC_get_errornumber(stmt) == STMT_POS_BEFORE_RECORDSET)
+	    result = SQL_SUCCESS_WITH_INFO;
+	goto cleanup;
+    }
+
     truncated = error = FALSE;
 
     currp = -1;
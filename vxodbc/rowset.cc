@@ -0,0 +1,633 @@
+/*
+ * Description:	This module contains the fast path for bound columns in
+ *		SQLFetch/SQLExtendedFetch/SQLFetchScroll: copying values
+ *		straight from a result's ColumnDataClass with a copier
+ *		picked once per binding, a whole rowset a column at a time
+ *		where possible and a row at a time from SC_fetch otherwise.
+ */
+
+#include "statement.h"
+#include "qresult.h"
+#include "connection.h"
+#include "bind.h"
+#include "convert.h"
+#include "descriptor.h"
+#include "pgtypes.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+/*
+ *	Everything about one bound column that doesn't change from row to
+ *	row, worked out once per fetch.
+ */
+struct RowsetColumn
+{
+    const ColumnDataClass *cd;
+    int col;
+    RowsetCopyFunc copy;
+    char *dst;			/* the first row's value */
+    SQLLEN buflen;
+    SQLLEN stride;		/* bytes from one row's value to the next */
+    SQLLEN *used;		/* the first row's length, if any */
+    SQLLEN *indicator;		/* ...and indicator, if it's separate */
+    SQLLEN len_stride;
+};
+
+#define RS_DST(rc, i, type)	((type *) ((rc)->dst + (i) * (rc)->stride))
+#define RS_LEN(p, rc, i)	(*(SQLLEN *) ((char *) (p) + (i) * (rc)->len_stride))
+
+/*
+ *	Handles a NULL in cache row 'row' (rowset row i), if that's what it
+ *	is.  Columns that have NULLs were checked for an indicator up front.
+ */
+static inline BOOL rs_null(const RowsetColumn * rc, SQLULEN row, SQLULEN i)
+{
+    if (!CD_is_null(rc->cd, rc->col, row))
+	return FALSE;
+    RS_LEN(rc->indicator ? rc->indicator : rc->used, rc, i) = SQL_NULL_DATA;
+    return TRUE;
+}
+
+static inline void rs_set_len(const RowsetColumn * rc, SQLULEN i,
+			      SQLLEN len)
+{
+    if (rc->indicator)
+	RS_LEN(rc->indicator, rc, i) = 0;
+    if (rc->used)
+	RS_LEN(rc->used, rc, i) = len;
+}
+
+
+/*
+ *	One loop per kind of source column, so that the kind is only looked
+ *	at once per rowset.  Integer C types get doubles and decimals
+ *	truncated to a SQLBIGINT first, the way copy_and_convert_coldata()
+ *	does it.
+ */
+#define RS_NUMERIC_LOOP(dtype, via, getter) \
+	for (i = 0; i < n; i++) \
+	{ \
+	    if (rs_null(rc, first + i, i)) \
+		continue; \
+	    *RS_DST(rc, i, dtype) = (dtype) (via) getter(cd, col, first + i); \
+	    rs_set_len(rc, i, sizeof(dtype)); \
+	}
+
+#define RS_DECIMAL_AS_SQLBIGINT(cd, col, row) \
+	CD_decimal_to_integer(CD_get_decimal(cd, col, row))
+#define RS_DECIMAL_AS_double(cd, col, row) \
+	CD_decimal_to_double(CD_get_decimal(cd, col, row))
+
+#define RS_NUMERIC_COPY(name, dtype, via) \
+static BOOL name(const RowsetColumn * rc, SQLULEN first, SQLULEN n) \
+{ \
+    const ColumnDataClass *cd = rc->cd; \
+    int col = rc->col; \
+    SQLULEN i; \
+ \
+    switch (CD_get_kind(cd, col)) \
+    { \
+    case CD_INT8: \
+	RS_NUMERIC_LOOP(dtype, via, CD_get_int8); \
+	break; \
+    case CD_INT4: \
+	RS_NUMERIC_LOOP(dtype, via, CD_get_int4); \
+	break; \
+    case CD_INT2: \
+	RS_NUMERIC_LOOP(dtype, via, CD_get_int2); \
+	break; \
+    case CD_UINT1: \
+    case CD_BOOL: \
+	RS_NUMERIC_LOOP(dtype, via, CD_get_uint1); \
+	break; \
+    case CD_DOUBLE: \
+	RS_NUMERIC_LOOP(dtype, via, CD_get_double); \
+	break; \
+    case CD_DECIMAL: \
+	RS_NUMERIC_LOOP(dtype, via, RS_DECIMAL_AS_##via); \
+	break; \
+    default: \
+	break; \
+    } \
+    return FALSE; \
+}
+
+RS_NUMERIC_COPY(rs_copy_uchar, UCHAR, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_schar, SCHAR, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_short, SQLSMALLINT, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_ushort, SQLUSMALLINT, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_long, SQLINTEGER, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_ulong, SQLUINTEGER, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_sbigint, SQLBIGINT, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_ubigint, SQLUBIGINT, SQLBIGINT)
+RS_NUMERIC_COPY(rs_copy_float, SFLOAT, double)
+RS_NUMERIC_COPY(rs_copy_double, SDOUBLE, double)
+
+#undef	RS_NUMERIC_COPY
+#undef	RS_NUMERIC_LOOP
+#undef	RS_DECIMAL_AS_SQLBIGINT
+#undef	RS_DECIMAL_AS_double
+
+
+static BOOL rs_copy_numeric(const RowsetColumn * rc, SQLULEN first,
+			    SQLULEN n)
+{
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	if (rs_null(rc, first + i, i))
+	    continue;
+	decimal_to_numeric(CD_get_decimal(rc->cd, rc->col, first + i),
+			   RS_DST(rc, i, SQL_NUMERIC_STRUCT));
+	rs_set_len(rc, i, sizeof(SQL_NUMERIC_STRUCT));
+    }
+    return FALSE;
+}
+
+
+static BOOL rs_copy_date(const RowsetColumn * rc, SQLULEN first, SQLULEN n)
+{
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	const CD_DateTime *dt = CD_get_datetime(rc->cd, rc->col, first + i);
+	DATE_STRUCT *ds = RS_DST(rc, i, DATE_STRUCT);
+	SIMPLE_TIME st;
+
+	if (rs_null(rc, first + i, i))
+	    continue;
+	memset(&st, 0, sizeof(st));
+	vx_datetime_to_simple_time(dt->secs, dt->usecs, &st);
+	ds->year = st.y;
+	ds->month = st.m;
+	ds->day = st.d;
+	rs_set_len(rc, i, 6);
+    }
+    return FALSE;
+}
+
+static BOOL rs_copy_time(const RowsetColumn * rc, SQLULEN first, SQLULEN n)
+{
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	const CD_DateTime *dt = CD_get_datetime(rc->cd, rc->col, first + i);
+	TIME_STRUCT *ts = RS_DST(rc, i, TIME_STRUCT);
+	SIMPLE_TIME st;
+
+	if (rs_null(rc, first + i, i))
+	    continue;
+	memset(&st, 0, sizeof(st));
+	vx_datetime_to_simple_time(dt->secs, dt->usecs, &st);
+	ts->hour = st.hh;
+	ts->minute = st.mm;
+	ts->second = st.ss;
+	rs_set_len(rc, i, 6);
+    }
+    return FALSE;
+}
+
+static BOOL rs_copy_timestamp(const RowsetColumn * rc, SQLULEN first,
+			      SQLULEN n)
+{
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	const CD_DateTime *dt = CD_get_datetime(rc->cd, rc->col, first + i);
+	TIMESTAMP_STRUCT *ts = RS_DST(rc, i, TIMESTAMP_STRUCT);
+	SIMPLE_TIME st;
+
+	if (rs_null(rc, first + i, i))
+	    continue;
+	memset(&st, 0, sizeof(st));
+	vx_datetime_to_simple_time(dt->secs, dt->usecs, &st);
+	ts->year = st.y;
+	ts->month = st.m;
+	ts->day = st.d;
+	ts->hour = st.hh;
+	ts->minute = st.mm;
+	ts->second = st.ss;
+	ts->fraction = st.fr;
+	rs_set_len(rc, i, 16);
+    }
+    return FALSE;
+}
+
+
+/*
+ *	Text goes out as is, truncated (but still NUL terminated) if it
+ *	doesn't fit; *used always gets the whole length.
+ */
+static BOOL rs_copy_text(const RowsetColumn * rc, SQLULEN first, SQLULEN n)
+{
+    BOOL truncated = FALSE;
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	char *dst = RS_DST(rc, i, char);
+	const char *text;
+	SQLLEN len, copy_len;
+
+	if (rs_null(rc, first + i, i))
+	    continue;
+	text = CD_get_blob(rc->cd, rc->col, first + i, &len);
+	copy_len = len;
+	if (len >= rc->buflen)
+	{
+	    truncated = TRUE;
+	    copy_len = rc->buflen > 0 ? rc->buflen - 1 : -1;
+	}
+	if (copy_len >= 0)
+	{
+	    memcpy(dst, text, copy_len);
+	    dst[copy_len] = '\0';
+	}
+	rs_set_len(rc, i, len);
+    }
+    return truncated;
+}
+
+static BOOL rs_copy_binary(const RowsetColumn * rc, SQLULEN first,
+			   SQLULEN n)
+{
+    BOOL truncated = FALSE;
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	const char *data;
+	SQLLEN len, copy_len;
+
+	if (rs_null(rc, first + i, i))
+	    continue;
+	data = CD_get_blob(rc->cd, rc->col, first + i, &len);
+	copy_len = len;
+	if (len > rc->buflen)
+	{
+	    truncated = TRUE;
+	    copy_len = rc->buflen;
+	}
+	memcpy(RS_DST(rc, i, char), data, copy_len);
+	rs_set_len(rc, i, len);
+    }
+    return truncated;
+}
+
+/*	Integers as decimal text, for applications that bind everything
+ *	as SQL_C_CHAR. */
+/*
+ *	Stores a value formatted into a local buffer as SQL_C_CHAR.
+ *	Returns TRUE if it had to be truncated.
+ */
+static inline BOOL rs_put_text(const RowsetColumn * rc, SQLULEN i,
+			       const char *buf, SQLLEN len)
+{
+    char *dst = RS_DST(rc, i, char);
+    SQLLEN copy_len = len;
+    BOOL truncated = FALSE;
+
+    if (len >= rc->buflen)
+    {
+	truncated = TRUE;
+	copy_len = rc->buflen > 0 ? rc->buflen - 1 : -1;
+    }
+    if (copy_len >= 0)
+    {
+	memcpy(dst, buf, copy_len);
+	dst[copy_len] = '\0';
+    }
+    rs_set_len(rc, i, len);
+    return truncated;
+}
+
+static BOOL rs_copy_integer_text(const RowsetColumn * rc, SQLULEN first,
+				 SQLULEN n)
+{
+    BOOL truncated = FALSE;
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	char buf[32];
+	SQLLEN len;
+
+	if (rs_null(rc, first + i, i))
+	    continue;
+	len = snprintf(buf, sizeof(buf), "%lld",
+		       (long long) CD_get_integer(rc->cd, rc->col,
+						  first + i));
+	if (rs_put_text(rc, i, buf, len))
+	    truncated = TRUE;
+    }
+    return truncated;
+}
+
+static BOOL rs_copy_decimal_text(const RowsetColumn * rc, SQLULEN first,
+				 SQLULEN n)
+{
+    BOOL truncated = FALSE;
+    SQLULEN i;
+
+    for (i = 0; i < n; i++)
+    {
+	char buf[48];
+	SQLLEN len;
+
+	if (rs_null(rc, first + i, i))
+	    continue;
+	len = CD_decimal_to_text(CD_get_decimal(rc->cd, rc->col, first + i),
+				 buf);
+	if (rs_put_text(rc, i, buf, len))
+	    truncated = TRUE;
+    }
+    return truncated;
+}
+
+
+/*
+ *	Picks the copier for a column and C type, or NULL if the value has
+ *	to go through copy_and_convert_coldata() after all.  Anything
+ *	involving character set, line feed or locale conversions does.
+ */
+static RowsetCopyFunc rs_choose_copy(const StatementClass * stmt,
+				     OID field_type, SQLSMALLINT ctype)
+{
+    const ConnectionClass *conn = SC_get_conn(stmt);
+    ColumnDataKind kind = CD_kind_from_type(field_type);
+
+    if (CD_DOUBLE == kind || CD_DECIMAL == kind || CD_INT8 == kind
+	|| CD_INT4 == kind || CD_INT2 == kind || CD_UINT1 == kind
+	|| CD_BOOL == kind)
+    {
+	switch (ctype)
+	{
+	case SQL_C_BIT:
+	case SQL_C_UTINYINT:
+	    return rs_copy_uchar;
+	case SQL_C_STINYINT:
+	case SQL_C_TINYINT:
+	    return rs_copy_schar;
+	case SQL_C_SSHORT:
+	case SQL_C_SHORT:
+	    return rs_copy_short;
+	case SQL_C_USHORT:
+	    return rs_copy_ushort;
+	case SQL_C_SLONG:
+	case SQL_C_LONG:
+	    return rs_copy_long;
+	case SQL_C_ULONG:
+	    return rs_copy_ulong;
+	case SQL_C_SBIGINT:
+	    return rs_copy_sbigint;
+	case SQL_C_UBIGINT:
+	    return rs_copy_ubigint;
+	case SQL_C_FLOAT:
+	    return rs_copy_float;
+	case SQL_C_DOUBLE:
+	    return rs_copy_double;
+	case SQL_C_NUMERIC:
+	    return CD_DECIMAL == kind ? rs_copy_numeric : NULL;
+	case SQL_C_CHAR:
+	    if (NULL != conn->DataSourceToDriver)
+		return NULL;
+	    if (CD_DECIMAL == kind)
+		return rs_copy_decimal_text;
+	    /* bools go out as text their own way */
+	    if (CD_DOUBLE != kind && CD_BOOL != kind)
+		return rs_copy_integer_text;
+	    return NULL;
+	default:
+	    return NULL;
+	}
+    }
+
+    switch (kind)
+    {
+    case CD_DATETIME:
+	switch (ctype)
+	{
+	case SQL_C_DATE:
+	case SQL_C_TYPE_DATE:
+	    return rs_copy_date;
+	case SQL_C_TIME:
+	case SQL_C_TYPE_TIME:
+	    return rs_copy_time;
+	case SQL_C_TIMESTAMP:
+	case SQL_C_TYPE_TIMESTAMP:
+	    return rs_copy_timestamp;
+	}
+	return NULL;
+    case CD_BINARY:
+	return SQL_C_BINARY == ctype ? rs_copy_binary : NULL;
+    case CD_TEXT:
+#ifndef	WIN_UNICODE_SUPPORT
+	if (SQL_C_CHAR == ctype && PG_TYPE_VARCHAR == field_type
+	    && !conn->connInfo.lf_conversion
+	    && NULL == conn->DataSourceToDriver)
+	    return rs_copy_text;
+#endif				/* WIN_UNICODE_SUPPORT */
+	return NULL;
+    default:
+	return NULL;
+    }
+}
+
+
+/*
+ *	The copier for a bound column, worked out the first time the
+ *	binding is fetched into and kept with it until the column's type or
+ *	the binding's C type changes.
+ */
+static RowsetCopyFunc rs_plan(StatementClass * stmt, BindInfoClass * bic,
+			      OID field_type)
+{
+    if (!bic->copy_ready || bic->copy_type != field_type
+	|| bic->copy_ctype != bic->returntype)
+    {
+	SQLSMALLINT ctype = bic->returntype;
+
+	if (SQL_C_DEFAULT == ctype)
+	    ctype = pgtype_to_ctype(stmt, field_type);
+	bic->copy = rs_choose_copy(stmt, field_type, ctype);
+	bic->copy_type = field_type;
+	bic->copy_ctype = bic->returntype;
+	bic->copy_ready = TRUE;
+	mylog("rs_plan: type %u to ctype %d: %s\n", field_type, ctype,
+	      bic->copy ? "direct" : "copy_and_convert_field");
+    }
+    return bic->copy;
+}
+
+
+/*
+ *	Fills in rc for bound column col, with row 0 being the application's
+ *	row bind_row.  Returns FALSE if the column has no copier, or has
+ *	NULLs and nowhere to say so (an error SC_fetch has to report).
+ */
+static BOOL rs_setup(StatementClass * stmt, QResultClass * res, int col,
+		     SQLULEN offset, SQLULEN bind_row, RowsetColumn * rc)
+{
+    ARDFields *opts = SC_get_ARDF(stmt);
+    BindInfoClass *bic = &opts->bindings[col];
+    OID field_type = QR_get_field_type(res, col);
+    SQLSMALLINT ctype = bic->returntype;
+
+    /* a DECIMAL column that had to be kept as text after all */
+    if (CD_get_kind(res->coldata, col) != CD_kind_from_type(field_type))
+	return FALSE;
+    if (rc->copy = rs_plan(stmt, bic, field_type), !rc->copy)
+	return FALSE;
+    if (SQL_C_DEFAULT == ctype)
+	ctype = pgtype_to_ctype(stmt, field_type);
+    rc->cd = res->coldata;
+    rc->col = col;
+    rc->indicator = LENADDR_SHIFT(bic->indicator, offset);
+    if (rc->cd->cols[col].valid && !rc->indicator)
+	return FALSE;
+    rc->used = LENADDR_SHIFT(bic->used, offset);
+    rc->buflen = bic->buflen;
+    if (opts->bind_size > 0)
+	rc->stride = rc->len_stride = opts->bind_size;
+    else
+    {
+	rc->len_stride = sizeof(SQLLEN);
+	switch (ctype)
+	{
+	case SQL_C_CHAR:
+	case SQL_C_BINARY:
+	    rc->stride = bic->buflen;
+	    break;
+	case SQL_C_SBIGINT:
+	case SQL_C_UBIGINT:
+	    rc->stride = sizeof(SQLBIGINT);
+	    break;
+	case SQL_C_NUMERIC:
+	    rc->stride = sizeof(SQL_NUMERIC_STRUCT);
+	    break;
+	default:
+	    rc->stride = ctype_length(ctype);
+	    break;
+	}
+    }
+    rc->dst = bic->buffer + offset + bind_row * rc->stride;
+    if (rc->used)
+	rc->used = (SQLLEN *) ((char *) rc->used + bind_row * rc->len_stride);
+    if (rc->indicator)
+	rc->indicator =
+	    (SQLLEN *) ((char *) rc->indicator + bind_row * rc->len_stride);
+    if (rc->indicator == rc->used)
+	rc->indicator = NULL;
+    return TRUE;
+}
+
+
+/*
+ *	Fill the rowset starting at the statement's rowset_start, as
+ *	PGAPI_ExtendedFetch's row at a time loop would, but a column at a
+ *	time.  Returns FALSE, having touched nothing, if this rowset needs
+ *	that loop after all: keysets, bookmarks, SQL_RD_OFF, and any bound
+ *	column without a fast copier (or with NULLs and nowhere to say so)
+ *	all do.  Otherwise *nrows gets the number of rows filled in and
+ *	*result what the fetch should return.
+ */
+BOOL SC_fetch_rowset(StatementClass * self, SQLLEN rowset_size,
+		     SQLULEN * nrows, RETCODE * result)
+{
+    CSTR func = "SC_fetch_rowset";
+    QResultClass *res = SC_get_Curres(self);
+    ARDFields *opts = SC_get_ARDF(self);
+    GetDataInfo *gdata = SC_get_GDTI(self);
+    const ColumnDataClass *cd;
+    std::vector<RowsetColumn> cols;
+    SQLLEN start = SC_get_rowset_start(self), end, first;
+    SQLULEN offset, n, i;
+    BOOL truncated = FALSE;
+    int num_cols, lf;
+
+    if (!res || !QR_has_coldata(res) || res->keyset
+	|| (opts->bookmark && opts->bookmark->buffer)
+	|| SQL_RD_OFF == self->options.retrieve_data
+	|| !opts->bindings || start < 0)
+	return FALSE;
+    cd = res->coldata;
+
+    end = start + rowset_size;
+    if (end > (SQLLEN) QR_get_num_total_tuples(res))
+	end = QR_get_num_total_tuples(res);
+    if (self->options.maxRows > 0 && end > self->options.maxRows)
+	end = self->options.maxRows;
+    if (end <= start)
+	return FALSE;
+    n = end - start;
+    first = GIdx2CacheIdx(start, self, res);
+    if (first < 0 || first + n > CD_get_num_rows(cd))
+	return FALSE;
+
+    offset = opts->row_offset_ptr ? *opts->row_offset_ptr : 0;
+    num_cols = QR_NumPublicResultCols(res);
+    if (num_cols > opts->allocated)
+	num_cols = opts->allocated;
+    for (lf = 0; lf < num_cols; lf++)
+    {
+	RowsetColumn rc;
+
+	if (!opts->bindings[lf].buffer)
+	    continue;
+	if (!rs_setup(self, res, lf, offset, 0, &rc))
+	    return FALSE;
+	cols.push_back(rc);
+    }
+
+    mylog("%s: rows %d to %d, %d bound columns\n", func, (int) start,
+	  (int) end, (int) cols.size());
+    for (i = 0; i < cols.size(); i++)
+	if (cols[i].copy(&cols[i], first, n))
+	    truncated = TRUE;
+
+    /* leave things as SC_fetch would have */
+    if (gdata->allocated != opts->allocated)
+	extend_getdata_info(gdata, opts->allocated, TRUE);
+    for (lf = 0; lf < gdata->allocated; lf++)
+	gdata->gdata[lf].data_left = -1;
+
+    if (truncated)
+    {
+	SC_set_error(self, STMT_TRUNCATED, "Fetched item was truncated.",
+		     func);
+	*result = SQL_SUCCESS_WITH_INFO;
+    } else
+	*result = SQL_SUCCESS;
+    *nrows = n;
+    return TRUE;
+}
+
+
+/*
+ *	SC_fetch's way in: copies cache row 'row' of bound column col into
+ *	the statement's current bind_row using the column's copier, setting
+ *	*retval as copy_and_convert_coldata_bindinfo() would.  Returns FALSE,
+ *	having touched nothing, if the column has to go that way instead.
+ */
+BOOL SC_copy_bound_value(StatementClass * self, int col, SQLULEN row,
+			 int *retval)
+{
+    QResultClass *res = SC_get_Curres(self);
+    ARDFields *opts = SC_get_ARDF(self);
+    RowsetColumn rc;
+
+    if (!res || !QR_has_coldata(res)
+	|| !rs_setup(self, res, col,
+		     opts->row_offset_ptr ? *opts->row_offset_ptr : 0,
+		     self->bind_row, &rc))
+	return FALSE;
+    SC_set_current_col(self, -1);
+    *retval = rc.copy(&rc, row, 1) ? COPY_RESULT_TRUNCATED : COPY_OK;
+    return TRUE;
+}
@@ -13,6 +13,7 @@
 #include "connection.h"
 #include "multibyte.h"
 #include "qresult.h"
+#include "prepcache.h"
 #include "convert.h"
 #include "environ.h"
 
@@ -258,6 +259,11 @@ RETCODE SQL_API PGAPI_FreeStmt(HSTMT hstmt, SQLUSMALLINT fOption)
 	SC_Destructor(stmt);
     } else if (fOption == SQL_UNBIND)
 	SC_unbind_cols(stmt);
+    else if (fOption == SQL_RESET_PARAMS)
+    {
+	APD_free_params(SC_get_APDF(stmt), STMT_FREE_PARAMS_ALL);
+	IPD_free_params(SC_get_IPDF(stmt), STMT_FREE_PARAMS_ALL);
+    }
     else if (fOption == SQL_CLOSE)
     {
 	/*
@@ -300,6 +306,7 @@ void InitializeStatementOptions(StatementOptions * opt)
     opt->retrieve_data = SQL_RD_ON;
     opt->use_bookmarks = SQL_UB_OFF;
     opt->metadata_id = SQL_FALSE;
+    opt->async_enable = SQL_ASYNC_ENABLE_OFF;
 }
 
 static void SC_clear_parse_status(StatementClass * self,
@@ -421,6 +428,10 @@ StatementClass *SC_Constructor(ConnectionClass * conn)
 	rv->allocated_callbacks = 0;
 	rv->num_callbacks = 0;
 	rv->callbacks = NULL;
+	rv->pending = NULL;
+	rv->running_serial = 0;
+	rv->cancelled = FALSE;
+	rv->pquery = NULL;
 	GetDataInfoInitialize(SC_get_GDTI(rv));
 	INIT_STMT_CS(rv);
     }
@@ -437,6 +448,12 @@ char SC_Destructor(StatementClass * self)
     mylog("self=%p, self->result=%p, self->hdbc=%p\n",
 	  self, res, self->hdbc);
     SC_clear_error(self);
+    if (!self->hdbc && SC_is_async_pending(self))
+    {
+	/* the connection is going away; nobody will poll this again */
+	SC_abandon_async(self);
+	self->status = STMT_FINISHED;
+    }
     if (STMT_EXECUTING == self->status)
     {
 	SC_set_error(self, STMT_SEQUENCE_ERROR,
@@ -500,6 +517,54 @@ int statement_type(const char *statement)
     return STMT_TYPE_OTHER;
 }
 
+/*
+ *	Count the '?' parameter markers in a query, ignoring any in quotes or
+ *	comments.  If the query holds more than one statement, *next_cmd is
+ *	where the second one starts, and *multi is set.  Procedure calls
+ *	with a return value ({?= call ...}) aren't supported, so
+ *	*proc_return is always 0.
+ */
+void
+SC_scanQueryAndCountParams(const char *query, const ConnectionClass * conn,
+			   Int4 * next_cmd, SQLSMALLINT * pcpar,
+			   char *multi, char *proc_return)
+{
+    const char *p, *end;
+    SQLSMALLINT num_p = 0;
+
+    if (next_cmd)
+	*next_cmd = -1;
+    if (multi)
+	*multi = FALSE;
+    if (proc_return)
+	*proc_return = 0;
+    for (p = query; p && *p;)
+    {
+	if (end = skip_sql_quoted(p), end != p)
+	{
+	    p = end;
+	    continue;
+	}
+	if ('?' == *p)
+	    num_p++;
+	else if (';' == *p)
+	{
+	    for (end = p + 1; isspace((UCHAR) * end); end++)
+		;
+	    if (*end)
+	    {
+		if (next_cmd && *next_cmd < 0)
+		    *next_cmd = (Int4) (p + 1 - query);
+		if (multi)
+		    *multi = TRUE;
+	    }
+	}
+	p++;
+    }
+    if (pcpar)
+	*pcpar = num_p;
+}
+
 void SC_set_planname(StatementClass * stmt, const char *plan_name)
 {
     if (stmt->plan_name)
@@ -601,6 +666,11 @@ SC_initialize_stmts(StatementClass * self, BOOL initializeOriginal)
 	    free(self->statement);
 	    self->statement = NULL;
 	}
+	if (self->pquery)
+	{
+	    CC_release_prepared(conn, self->pquery);
+	    self->pquery = NULL;
+	}
 	if (self->execute_statement)
 	{
 	    free(self->execute_statement);
@@ -1294,6 +1364,10 @@ RETCODE SC_fetch(StatementClass * self)
     mylog("fetch_cursor=%d, %p->total_read=%d\n",
 	  0 /*SC_is_fetchcursor(self)*/, res, res->num_total_read);
 
+    /* make sure the next row is here, if there is one */
+    if (QR_is_streaming(res))
+	QR_fetch_more(res, self->currTuple + 2);
+
     if (self->currTuple >= (Int4) QR_get_num_total_tuples(res) - 1
 	|| (self->options.maxRows > 0
 	    && self->currTuple == self->options.maxRows - 1))
@@ -1400,12 +1474,23 @@ RETCODE SC_fetch(StatementClass * self)
 		   QR_get_rowstart_in_cache(res), self->currTuple,
 		   SC_get_rowset_start(self));
 	    inolog("curt=%d\n", curt);
-	    value = (char *)QR_get_value_backend_row(res, curt, lf);
+	    if (QR_has_coldata(res))
+	    {
+		value = NULL;
+		if (!SC_copy_bound_value(self, lf, curt, &retval))
+		    retval =
+			copy_and_convert_coldata_bindinfo(self, type,
+							  res->coldata, curt,
+							  lf);
+	    } else
+	    {
+		value = (char *)QR_get_value_backend_row(res, curt, lf);
 
-	    mylog("value = '%s'\n", (value == NULL) ? "<NULL>" : value);
+		mylog("value = '%s'\n", (value == NULL) ? "<NULL>" : value);
 
-	    retval =
-		copy_and_convert_field_bindinfo(self, type, value, lf);
+		retval =
+		    copy_and_convert_field_bindinfo(self, type, value, lf);
+	    }
 
 	    mylog("copy_and_convert: retval = %d\n", retval);
 
@@ -1433,7 +1518,7 @@ RETCODE SC_fetch(StatementClass * self)
 			     "Fetched item was truncated.", func);
 		qlog("The %dth item was truncated\n", lf + 1);
 		qlog("The buffer size = %d", opts->bindings[lf].buflen);
-		qlog(" and the value is '%s'\n", value);
+		qlog(" and the value is '%s'\n", value ? value : "<typed>");
 		result = SQL_SUCCESS_WITH_INFO;
 		break;
 
@@ -20,6 +20,10 @@
 #include <pthread.h>
 #endif
 
+#ifdef	__cplusplus
+class VxResultSet;
+#endif
+
 typedef enum
 {
 	STMT_ALLOCATED,				/* The statement handle is allocated, but
@@ -205,6 +209,8 @@ struct StatementClass_
 
 	char	   *statement;		/* if non--null pointer to the SQL
 					 * statement that has been executed */
+	PreparedQuery	*pquery;	/* statement, split around its
+					 * parameter markers */
 
 	TABLE_INFO	**ti;
 	Int2		ntab;
@@ -259,6 +265,11 @@ struct StatementClass_
 	UInt2		allocated_callbacks;
 	UInt2		num_callbacks;
 	NeedDataCallback	*callbacks;
+	VxResultSet	*pending;	/* an SQL_ASYNC_ENABLE_ON query still
+					 * waiting for its first rows */
+	UInt4		running_serial;	/* the query a thread is waiting on,
+					 * for SQLCancel; under CONNLOCK */
+	char		cancelled;	/* SQLCancel came from another thread */
 #if defined(WIN_MULTITHREAD_SUPPORT)
 	CRITICAL_SECTION	cs;
 #elif defined(POSIX_THREADMUTEX_SUPPORT)
@@ -441,6 +452,13 @@ void		SC_scanQueryAndCountParams(const char *, const ConnectionClass *,
 			Int4 *next_cmd, SQLSMALLINT *num_params,
 			char *multi, char *proc_return);
 
+#define	SC_is_async_pending(a)	(NULL != (a)->pending)
+void	SC_abandon_async(StatementClass *self);	/* in vxhelpers.cc */
+BOOL	SC_cancel_running(StatementClass *self);	/* in vxhelpers.cc */
+RETCODE	SC_bulk_add(StatementClass *self);	/* in bulk.cc */
+BOOL	SC_fetch_rowset(StatementClass *self, SQLLEN rowset_size, SQLULEN *nrows, RETCODE *result);	/* in rowset.cc */
+BOOL	SC_copy_bound_value(StatementClass *self, int col, SQLULEN row, int *retval);	/* in rowset.cc */
+
 BOOL	SC_IsExecuting(const StatementClass *self);
 BOOL	SC_SetExecuting(StatementClass *self, BOOL on);
 BOOL	SC_SetCancelRequest(StatementClass *self);
@@ -0,0 +1,209 @@
+#include "common.h"
+#include "wvtest.h"
+#include "table.h"
+#include "vxodbctester.h"
+
+#include <vector>
+
+#ifdef WIN32
+#define msleep(ms) Sleep(ms)
+#else
+#include <unistd.h>
+#define msleep(ms) usleep((ms) * 1000)
+#endif
+
+WVTEST_MAIN("Asynchronous SQLExecDirect")
+{
+    VxOdbcTester v;
+    bool nullable = 0;
+    Table t("asynctest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.cols[0].append(42);
+    v.t = &t;
+    SQLINTEGER val = 0;
+    SQLLEN ind = 0;
+    SQLRETURN ret;
+    SQLUINTEGER async = SQL_ASYNC_ENABLE_OFF;
+
+    v.expected_query = "SELECT i FROM asynctest";
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE,
+            (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+    WVPASS_SQL(SQLGetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE, &async,
+            sizeof(async), NULL));
+    WVPASSEQ(async, SQL_ASYNC_ENABLE_ON);
+
+    int polls = 0;
+    while ((ret = SQLExecDirect(Statement,
+                    (SQLCHAR *)v.expected_query.cstr(), SQL_NTS))
+            == SQL_STILL_EXECUTING)
+        polls++;
+    WVPASS_SQL(ret);
+    WVPASS(polls > 0);
+
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_LONG, &val, 0, &ind));
+    WVPASSEQ(val, 42);
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+WVTEST_MAIN("SQLCancel on an asynchronous query")
+{
+    VxOdbcTester v;
+    bool nullable = 0;
+    Table t("asynctest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.cols[0].append(42);
+    v.t = &t;
+    SQLINTEGER val = 0;
+    SQLLEN ind = 0;
+
+    v.expected_query = "SELECT i FROM asynctest";
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE,
+            (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+    WVPASSEQ(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+                SQL_NTS), SQL_STILL_EXECUTING);
+    WVPASS_SQL(SQLCancel(Statement));
+
+    // versaplexd gets told, and there's no result left to fetch from
+    for (int i = 0; i < 100 && v.num_cancels < 1; i++)
+        msleep(10);
+    WVPASSEQ(v.num_cancels, 1);
+    WVPASSEQ(SQLFetch(Statement), SQL_ERROR);
+
+    // The statement can be used again straight away
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE,
+            (SQLPOINTER)SQL_ASYNC_ENABLE_OFF, 0));
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+                SQL_NTS));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_LONG, &val, 0, &ind));
+    WVPASSEQ(val, 42);
+}
+
+WVTEST_MAIN("Asynchronous UPDATE counts rows like a synchronous one")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("asynctest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+    const char *update = "update asynctest set i = 20";
+    SQLLEN rows = 0;
+    SQLRETURN ret;
+
+    v.rows_affected = 7;
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE,
+            (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+    while ((ret = SQLExecDirect(Statement, (SQLCHAR *)update, SQL_NTS))
+            == SQL_STILL_EXECUTING)
+        ;
+    WVPASS_SQL(ret);
+    WVPASSEQ(v.noresult_query, update);
+    WVPASS_SQL(SQLRowCount(Statement, &rows));
+    WVPASSEQ(rows, 7);
+}
+
+WVTEST_MAIN("Only execution is asynchronous")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("columns");
+    t.addStringCol("COLUMN_NAME", 128, nullable);
+    t.cols[0].append("i");
+    v.t = &t;
+    SQLUINTEGER mode = SQL_AM_NONE;
+
+    WVPASS_SQL(SQLGetInfo(Connection, SQL_ASYNC_MODE, &mode, sizeof(mode),
+            NULL));
+    WVPASSEQ(mode, SQL_AM_STATEMENT);
+
+    // A catalog function just finishes, even with async on
+    v.expected_query = "LIST COLUMNS [asynctest]";
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE,
+            (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+    WVPASSEQ(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"asynctest", SQL_NTS, NULL, 0), SQL_SUCCESS);
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+WVTEST_MAIN("Asynchronous parameter arrays")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("asynctest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+    const char *insert = "INSERT INTO asynctest VALUES (?)";
+    SQLINTEGER ints[3] = { 1, 2, 3 };
+    SQLLEN ind[3] = { 0, 0, 0 };
+    SQLUSMALLINT status[3] = { 99, 99, 99 };
+    SQLUINTEGER processed = 0;
+    SQLLEN rows = 0;
+    SQLRETURN ret;
+
+    WVPASS_SQL(SQLBindParameter(Statement, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+            SQL_INTEGER, 0, 0, ints, 0, ind));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMSET_SIZE,
+            (SQLPOINTER)3, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAM_STATUS_PTR,
+            status, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMS_PROCESSED_PTR,
+            &processed, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE,
+            (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+
+    // All three rows fit in one request, so it runs asynchronously
+    v.rows_affected = 3;
+    int polls = 0;
+    while ((ret = SQLExecDirect(Statement, (SQLCHAR *)insert, SQL_NTS))
+            == SQL_STILL_EXECUTING)
+        polls++;
+    WVPASS_SQL(ret);
+    WVPASS(polls > 0);
+    WVPASSEQ(v.noresult_query, "INSERT INTO asynctest VALUES (1)\n"
+        "INSERT INTO asynctest VALUES (2)\n"
+        "INSERT INTO asynctest VALUES (3)");
+    WVPASSEQ(processed, 3);
+    for (int i = 0; i < 3; i++)
+        WVPASSEQ(status[i], SQL_PARAM_SUCCESS);
+    WVPASS_SQL(SQLRowCount(Statement, &rows));
+    WVPASSEQ(rows, 3);
+}
+
+WVTEST_MAIN("Parameter arrays too big to run asynchronously")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("asynctest");
+    t.addStringCol("s", 0, nullable);
+    v.t = &t;
+    const char *insert = "INSERT INTO asynctest VALUES (?)";
+    // Each row is over half of what goes in one request
+    const int len = 600 * 1024;
+    std::vector<char> strs(2 * (len + 1), 'x');
+    strs[len] = strs[2 * len + 1] = '\0';
+    SQLLEN ind[2] = { SQL_NTS, SQL_NTS };
+    SQLUSMALLINT status[2] = { 99, 99 };
+    char state[6] = "";
+    SQLINTEGER native = 0;
+    SQLSMALLINT msglen = 0;
+
+    WVPASS_SQL(SQLBindParameter(Statement, 1, SQL_PARAM_INPUT, SQL_C_CHAR,
+            SQL_LONGVARCHAR, len, 0, &strs[0], len + 1, ind));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMSET_SIZE,
+            (SQLPOINTER)2, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAM_STATUS_PTR,
+            status, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ASYNC_ENABLE,
+            (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+
+    // So they go one after the other, synchronously, and it says so
+    WVPASSEQ(SQLExecDirect(Statement, (SQLCHAR *)insert, SQL_NTS),
+            SQL_SUCCESS_WITH_INFO);
+    WVPASS_SQL(SQLGetDiagRec(SQL_HANDLE_STMT, Statement, 1,
+            (SQLCHAR *)state, &native, NULL, 0, &msglen));
+    WVPASSEQ(state, "01S02");
+    for (int i = 0; i < 2; i++)
+        WVPASSEQ(status[i], SQL_PARAM_SUCCESS);
+}
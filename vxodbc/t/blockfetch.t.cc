@@ -0,0 +1,176 @@
+#include "common.h"
+#include "wvtest.h"
+#include "table.h"
+#include "vxodbctester.h"
+
+WVTEST_MAIN("Column-wise block cursor")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("blocktest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.addStringCol("s", 20, nullable);
+    t.addCol("n", ColumnInfo::Int64, nullable, 8, 0, 0);
+    t.cols[0].append(42);
+    t.cols[1].append("hello");
+    t.cols[2].appendNull();
+    v.t = &t;
+    v.num_rows = 5;
+
+    SQLINTEGER ints[3];
+    SQLLEN int_ind[3];
+    char strs[3][8];
+    SQLLEN str_ind[3];
+    SQLBIGINT bigs[3];
+    SQLLEN big_ind[3];
+    SQLUSMALLINT status[3];
+    SQLULEN fetched = 0;
+
+    v.expected_query = "SELECT i, s, n FROM blocktest";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+            SQL_NTS));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROW_ARRAY_SIZE,
+            (SQLPOINTER)3, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROW_STATUS_PTR,
+            status, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROWS_FETCHED_PTR,
+            &fetched, 0));
+    WVPASS_SQL(SQLBindCol(Statement, 1, SQL_C_LONG, ints, 0, int_ind));
+    WVPASS_SQL(SQLBindCol(Statement, 2, SQL_C_CHAR, strs, sizeof(strs[0]),
+            str_ind));
+    WVPASS_SQL(SQLBindCol(Statement, 3, SQL_C_SBIGINT, bigs, 0, big_ind));
+
+    WVPASSEQ(SQLFetch(Statement), SQL_SUCCESS);
+    WVPASSEQ(fetched, 3);
+    for (int i = 0; i < 3; i++)
+    {
+        WVPASSEQ(status[i], SQL_ROW_SUCCESS);
+        WVPASSEQ(ints[i], 42);
+        WVPASSEQ(int_ind[i], 4);
+        WVPASSEQ(strs[i], "hello");
+        WVPASSEQ(str_ind[i], 5);
+        WVPASSEQ(big_ind[i], SQL_NULL_DATA);
+    }
+
+    // Only two rows are left for the second rowset
+    memset(ints, 0, sizeof(ints));
+    WVPASSEQ(SQLFetch(Statement), SQL_SUCCESS);
+    WVPASSEQ(fetched, 2);
+    WVPASSEQ(ints[0], 42);
+    WVPASSEQ(ints[1], 42);
+    WVPASSEQ(ints[2], 0);
+    WVPASSEQ(status[1], SQL_ROW_SUCCESS);
+    WVPASSEQ(status[2], SQL_ROW_NOROW);
+
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+struct BlockRow
+{
+    SQLINTEGER i;
+    SQLLEN i_ind;
+    char s[4];
+    SQLLEN s_ind;
+};
+
+WVTEST_MAIN("Row-wise block cursor")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("blocktest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.addStringCol("s", 20, nullable);
+    t.cols[0].append(-7);
+    t.cols[1].append("hello");
+    v.t = &t;
+    v.num_rows = 4;
+
+    BlockRow rows[4];
+    SQLULEN fetched = 0;
+
+    memset(rows, 0, sizeof(rows));
+    v.expected_query = "SELECT i, s FROM blocktest";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+            SQL_NTS));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROW_BIND_TYPE,
+            (SQLPOINTER)sizeof(BlockRow), 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROW_ARRAY_SIZE,
+            (SQLPOINTER)4, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROWS_FETCHED_PTR,
+            &fetched, 0));
+    WVPASS_SQL(SQLBindCol(Statement, 1, SQL_C_LONG, &rows[0].i, 0,
+            &rows[0].i_ind));
+    WVPASS_SQL(SQLBindCol(Statement, 2, SQL_C_CHAR, rows[0].s,
+            sizeof(rows[0].s), &rows[0].s_ind));
+
+    // "hello" doesn't fit, so every row gets truncated
+    WVPASSEQ(SQLFetch(Statement), SQL_SUCCESS_WITH_INFO);
+    WVPASSEQ(fetched, 4);
+    for (int i = 0; i < 4; i++)
+    {
+        WVPASSEQ(rows[i].i, -7);
+        WVPASSEQ(rows[i].i_ind, 4);
+        WVPASSEQ(rows[i].s, "hel");
+        WVPASSEQ(rows[i].s_ind, 5);
+    }
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+WVTEST_MAIN("Bound columns fetched a row at a time")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("rowtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.addCol("d", ColumnInfo::Double, nullable, 8, 0, 0);
+    t.addCol("ts", ColumnInfo::DateTime, nullable, 8, 0, 0);
+    t.cols[0].append(1234567);
+    t.cols[1].append(2.5);
+    // time_t value for 2002-12-27 18:43:21 UTC
+    t.cols[2].append(1041014601).append(0);
+    v.t = &t;
+    v.num_rows = 3;
+
+    SQLINTEGER i = 0;
+    double d = 0;
+    TIMESTAMP_STRUCT ts;
+    SQLLEN i_ind, d_ind, ts_ind;
+
+    v.expected_query = "SELECT i, d, ts FROM rowtest";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+            SQL_NTS));
+    WVPASS_SQL(SQLBindCol(Statement, 1, SQL_C_LONG, &i, 0, &i_ind));
+    WVPASS_SQL(SQLBindCol(Statement, 2, SQL_C_DOUBLE, &d, 0, &d_ind));
+    WVPASS_SQL(SQLBindCol(Statement, 3, SQL_C_TIMESTAMP, &ts, 0, &ts_ind));
+
+    memset(&ts, 0, sizeof(ts));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(i, 1234567);
+    WVPASSEQ(i_ind, 4);
+    WVPASSEQ(d, 2.5);
+    WVPASSEQ(d_ind, 8);
+    WVPASSEQ(ts.year, 2002);
+    WVPASSEQ(ts.month, 12);
+    WVPASSEQ(ts.day, 27);
+    WVPASSEQ(ts.hour, 18);
+    WVPASSEQ(ts.minute, 43);
+    WVPASSEQ(ts.second, 21);
+
+    // Rebinding to another C type picks a new conversion
+    char buf[4];
+    SQLSMALLINT small = 0;
+    WVPASS_SQL(SQLBindCol(Statement, 1, SQL_C_CHAR, buf, sizeof(buf),
+            &i_ind));
+    WVPASS_SQL(SQLBindCol(Statement, 2, SQL_C_SHORT, &small, 0, &d_ind));
+    WVPASSEQ(SQLFetch(Statement), SQL_SUCCESS_WITH_INFO);
+    WVPASSEQ(buf, "123");
+    WVPASSEQ(i_ind, 7);
+    WVPASSEQ(small, 2);
+
+    // ...and binding it back picks the old one again
+    WVPASS_SQL(SQLBindCol(Statement, 1, SQL_C_LONG, &i, 0, &i_ind));
+    i = 0;
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(i, 1234567);
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
@@ -0,0 +1,72 @@
+#include "common.h"
+#include "wvtest.h"
+#include "table.h"
+#include "vxodbctester.h"
+
+WVTEST_MAIN("SQLBulkOperations(SQL_ADD)")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("bulktest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+
+    SQLINTEGER ints[3] = { 1, 2, 3 };
+    SQLLEN ind[3] = { 0, 0, SQL_NULL_DATA };
+    SQLUSMALLINT status[3] = { 99, 99, 99 };
+    SQLLEN rows = 0;
+
+    v.expected_query = "SELECT i FROM bulktest";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+            SQL_NTS));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROW_ARRAY_SIZE,
+            (SQLPOINTER)3, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROW_STATUS_PTR,
+            status, 0));
+    WVPASS_SQL(SQLBindCol(Statement, 1, SQL_C_LONG, ints, 0, ind));
+
+    // The whole rowset goes over in a single BulkInsert
+    WVPASS_SQL(SQLBulkOperations(Statement, SQL_ADD));
+    WVPASSEQ(v.bulk_table, "bulktest");
+    WVPASSEQ(v.bulk_rows, 3);
+    for (int i = 0; i < 3; i++)
+        WVPASSEQ(status[i], SQL_ROW_ADDED);
+    WVPASS_SQL(SQLRowCount(Statement, &rows));
+    WVPASSEQ(rows, 3);
+
+    // Anything but SQL_ADD is still refused
+    WVPASSEQ(SQLBulkOperations(Statement, SQL_UPDATE_BY_BOOKMARK),
+            SQL_ERROR);
+}
+
+
+WVTEST_MAIN("SQL_ADD leaves the cursor alone and uses base column names")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("bulktest");
+    // What the server calls the column is the alias, not the table's name
+    t.addCol("n", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.cols[0].append(42);
+    v.t = &t;
+    v.num_rows = 6;
+
+    SQLINTEGER ints[3] = { 0, 0, 0 };
+    SQLLEN ind[3] = { 0, 0, 0 };
+
+    v.expected_query = "SELECT i AS n FROM bulktest";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+            SQL_NTS));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_ROW_ARRAY_SIZE,
+            (SQLPOINTER)3, 0));
+    WVPASS_SQL(SQLBindCol(Statement, 1, SQL_C_LONG, ints, 0, ind));
+    WVPASS_SQL(SQLFetch(Statement));
+
+    WVPASS_SQL(SQLBulkOperations(Statement, SQL_ADD));
+    WVPASSEQ(v.bulk_columns, "i");
+    WVPASSEQ(v.bulk_rows, 3);
+
+    // The next fetch carries on from the rowset before the SQL_ADD
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
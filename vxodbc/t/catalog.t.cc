@@ -0,0 +1,291 @@
+#include "common.h"
+#include "wvtest.h"
+#include "table.h"
+#include "vxodbctester.h"
+
+#ifdef WIN32
+#define msleep(ms) Sleep(ms)
+#else
+#include <unistd.h>
+#define msleep(ms) usleep((ms) * 1000)
+#endif
+
+static WvString first_column_name()
+{
+    char name[64];
+    SQLLEN ind = 0;
+
+    name[0] = '\0';
+    WVPASS_SQL(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"cattest", SQL_NTS, NULL, 0));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, name, sizeof(name),
+            &ind));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+    return name;
+}
+
+// Reconnect with some connection options turned on
+static void reconnect(VxOdbcTester &v, const char *options)
+{
+    SQLFreeStmt(Statement, SQL_DROP);
+    SQLDisconnect(Connection);
+    Statement = SQL_NULL_HSTMT;
+    WvString connstr("DRIVER=vxodbc;UID=pmccurdy;PWD=scs;database=pmccurdy;"
+        "DBus=%s;%s", v.dbus_moniker, options);
+    SQLCHAR outbuf[1024];
+    SQLSMALLINT num_written = 0;
+    WVPASS_SQL(SQLDriverConnect(Connection, NULL,
+        (SQLCHAR *)connstr.cstr(), connstr.len(),
+        outbuf, sizeof(outbuf), &num_written, SQL_DRIVER_NOPROMPT));
+    WVPASS_SQL(SQLAllocHandle(SQL_HANDLE_STMT, Connection, &Statement));
+}
+
+// Run something that doesn't care what the fake server says back
+static void exec_anything(VxOdbcTester &v, const char *query)
+{
+    v.expected_query = query;
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)query, SQL_NTS));
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+    v.expected_query = "LIST COLUMNS [cattest]";
+}
+
+WVTEST_MAIN("Catalog results come from the connection's cache")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("columns");
+    t.addStringCol("COLUMN_NAME", 128, nullable);
+    t.cols[0].append("i");
+    v.t = &t;
+
+    // It's off unless asked for
+    v.expected_query = "LIST COLUMNS [cattest]";
+    WVPASSEQ(first_column_name(), "i");
+    t.cols[0].zapData().append("j");
+    WVPASSEQ(first_column_name(), "j");
+
+    reconnect(v, "CatalogCacheTTL=30");
+    WVPASSEQ(first_column_name(), "j");
+
+    // versaplexd would say something else now, but isn't asked
+    t.cols[0].zapData().append("k");
+    WVPASSEQ(first_column_name(), "j");
+
+    // Nor does running a query make it ask...
+    exec_anything(v, "SELECT * FROM cattest");
+    WVPASSEQ(first_column_name(), "j");
+
+    // ...until something that might change the schema goes by
+    exec_anything(v, "CREATE TABLE cattest2 (k int)");
+    WVPASSEQ(first_column_name(), "k");
+
+    t.cols[0].zapData().append("l");
+    exec_anything(v, "SELECT * INTO cattest3 FROM cattest");
+    WVPASSEQ(first_column_name(), "l");
+
+    t.cols[0].zapData().append("m");
+    exec_anything(v, "INSERT INTO cattest VALUES (1); DROP TABLE cattest2");
+    WVPASSEQ(first_column_name(), "m");
+}
+
+WVTEST_MAIN("NULLs in catalog results")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("columns");
+    t.addStringCol("COLUMN_NAME", 128, nullable);
+    t.addStringCol("REMARKS", 254, nullable);
+    t.cols[0].append("i");
+    t.cols[1].appendNull();
+    v.t = &t;
+
+    char remarks[64];
+    SQLLEN ind = 0;
+
+    v.expected_query = "LIST COLUMNS [cattest]";
+    WVPASS_SQL(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"cattest", SQL_NTS, NULL, 0));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 2, SQL_C_CHAR, remarks,
+            sizeof(remarks), &ind));
+    WVPASSEQ(ind, SQL_NULL_DATA);
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+WVTEST_MAIN("Catalog patterns are matched by the server")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("tables");
+    t.addStringCol("TABLE_NAME", 128, nullable);
+    t.cols[0].append("cat_1");
+    v.t = &t;
+
+    char name[64];
+    SQLLEN ind = 0;
+
+    // '\_' is a real underscore, so it goes to the server as '[_]'
+    v.expected_query = "exec sp_tables @table_name = N'cat[_]%', "
+        "@table_type = '''TABLE'',''VIEW'''";
+    WVPASS_SQL(SQLTables(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"cat\\_%", SQL_NTS, (SQLCHAR *)"'TABLE','VIEW'",
+            SQL_NTS));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, name, sizeof(name),
+            &ind));
+    WVPASSEQ(name, "cat_1");
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+
+    // A quote inside a type can't end either of the literals it's in
+    v.expected_query = "exec sp_tables @table_type = "
+        "'''TABLE''''; drop table x; --'''";
+    WVPASS_SQL(SQLTables(Statement, NULL, 0, NULL, 0, NULL, 0,
+            (SQLCHAR *)"TABLE'; drop table x; --", SQL_NTS));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+
+    v.expected_query = "exec sp_columns @table_name = N'cat_1', "
+        "@column_name = N'i%'";
+    WVPASS_SQL(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"cat_1", SQL_NTS, (SQLCHAR *)"i%", SQL_NTS));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+WVTEST_MAIN("Prefetching every table's columns")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("columns");
+    t.addStringCol("TABLE_OWNER", 128, nullable);
+    t.addStringCol("TABLE_NAME", 128, nullable);
+    t.addStringCol("COLUMN_NAME", 128, nullable);
+    t.cols[0].append("dbo");
+    t.cols[1].append("cattest");
+    t.cols[2].append("i");
+    v.t = &t;
+    v.num_rows = 2;
+
+    reconnect(v, "CatalogCacheTTL=30;PrefetchColumns=1");
+
+    // Only the whole-schema query gets an answer, so the table's own
+    // "LIST COLUMNS [cattest]" has to come from what it filed away.
+    char name[64];
+    SQLLEN ind = 0;
+    v.expected_query = "exec sp_columns @table_name = N'%'";
+    WVPASS_SQL(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"cattest", SQL_NTS, NULL, 0));
+    for (int i = 0; i < 2; i++)
+    {
+        WVPASS_SQL(SQLFetch(Statement));
+        WVPASS_SQL(SQLGetData(Statement, 3, SQL_C_CHAR, name, sizeof(name),
+                &ind));
+        WVPASSEQ(name, "i");
+    }
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+WVTEST_MAIN("A prefetch that got nothing is tried again")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("columns");
+    t.addStringCol("TABLE_OWNER", 128, nullable);
+    t.addStringCol("TABLE_NAME", 128, nullable);
+    t.addStringCol("COLUMN_NAME", 128, nullable);
+    t.cols[0].append("dbo");
+    t.cols[1].append("cattest");
+    t.cols[2].append("i");
+    v.t = &t;
+
+    reconnect(v, "CatalogCacheTTL=30;PrefetchColumns=1");
+
+    // The whole-schema query is turned down, so the table gets asked
+    // about on its own
+    v.expected_query = "LIST COLUMNS [cattest]";
+    WVPASS_SQL(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"cattest", SQL_NTS, NULL, 0));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+
+    // Which didn't count as a prefetch, so the next SQLColumns does one,
+    // and finds "other" in what it filed
+    t.cols[1].zapData().append("other");
+    v.expected_query = "exec sp_columns @table_name = N'%'";
+    WVPASS_SQL(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)"other", SQL_NTS, NULL, 0));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+}
+
+// The name of table's one column, which must come from the prefetch
+static WvString prefetched_column(const char *table)
+{
+    char name[64];
+    SQLLEN ind = 0;
+
+    name[0] = '\0';
+    WVPASS_SQL(SQLColumns(Statement, NULL, 0, NULL, 0,
+            (SQLCHAR *)table, SQL_NTS, NULL, 0));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 3, SQL_C_CHAR, name, sizeof(name),
+            &ind));
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+    return name;
+}
+
+WVTEST_MAIN("A prefetch keeps every table, however small the cache")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("columns");
+    t.addStringCol("TABLE_OWNER", 128, nullable);
+    t.addStringCol("TABLE_NAME", 128, nullable);
+    t.addStringCol("COLUMN_NAME", 128, nullable);
+    const char *tables[] = { "t1", "t2", "t3" };
+    for (int i = 0; i < 3; i++)
+    {
+        t.cols[0].append("dbo");
+        t.cols[1].append(tables[i]);
+        t.cols[2].append("i");
+    }
+    v.t = &t;
+
+    reconnect(v, "CatalogCacheTTL=30;CatalogCacheSize=1;PrefetchColumns=1");
+
+    // Nothing but the whole-schema query gets an answer
+    v.expected_query = "exec sp_columns @table_name = N'%'";
+    for (int i = 0; i < 3; i++)
+        WVPASSEQ(prefetched_column(tables[i]), "i");
+    WVPASSEQ(prefetched_column("t1"), "i");
+}
+
+WVTEST_MAIN("A prefetch is done again once it has expired")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("columns");
+    t.addStringCol("TABLE_OWNER", 128, nullable);
+    t.addStringCol("TABLE_NAME", 128, nullable);
+    t.addStringCol("COLUMN_NAME", 128, nullable);
+    t.cols[0].append("dbo");
+    t.cols[1].append("cattest");
+    t.cols[2].append("i");
+    v.t = &t;
+
+    reconnect(v, "CatalogCacheTTL=1;PrefetchColumns=1");
+
+    v.expected_query = "exec sp_columns @table_name = N'%'";
+    WVPASSEQ(prefetched_column("cattest"), "i");
+
+    // Rather than asking about the one table, it gets everything again
+    t.cols[2].zapData().append("j");
+    msleep(1100);
+    WVPASSEQ(prefetched_column("cattest"), "j");
+}
@@ -0,0 +1,58 @@
+#include "wvtest.h"
+#include "../connection.h"
+#include "../colicache.h"
+
+#include <stdlib.h>
+
+// The cache is exercised directly here: getting hundreds of tables parsed
+// through the fake server just to fill it up would prove no more.
+static COL_INFO *new_col_info(const char *table)
+{
+    COL_INFO *coli = (COL_INFO *)calloc(1, sizeof(COL_INFO));
+    STR_TO_NAME(coli->table_name, table);
+    return coli;
+}
+
+WVTEST_MAIN("Column info cache evicts the least recently used table")
+{
+    ColInfoCacheClass *cache = CIC_Constructor(2);
+    COL_INFO *a = new_col_info("a"), *b = new_col_info("b");
+    COL_INFO *c = new_col_info("c"), *found;
+
+    CIC_add(cache, a);
+    CIC_add(cache, b);
+    WVPASSEQ(a->refcount, 1);
+
+    // Hang on to b, the way a statement's TABLE_INFO would
+    found = CIC_find(cache, NULL, "b");
+    WVPASS(found == b);
+    WVPASSEQ(b->refcount, 2);
+
+    // Table names don't care about case, and using a makes b the oldest
+    found = CIC_find(cache, NULL, "A");
+    WVPASS(found == a);
+    COLI_release(found);
+
+    CIC_add(cache, c);
+    WVPASSEQ(cache->lru.count, 2);
+    WVPASSEQ((int)cache->evicted, 1);
+    WVPASS(CIC_find(cache, NULL, "b") == NULL);
+    WVPASS((found = CIC_find(cache, NULL, "a")) == a);
+    COLI_release(found);
+    WVPASS((found = CIC_find(cache, "", "c")) == c);
+    COLI_release(found);
+
+    // The dropped entry is still good to whoever holds it, and goes away
+    // when they let go
+    WVPASSEQ(b->refcount, 1);
+    WVPASSEQ(SAFE_NAME(b->table_name), "b");
+    WVPASS(b->lru.prev == NULL && b->lru.next == NULL
+           && b->lru.hnext == NULL);
+    COLI_release(b);
+
+    // Misses are left to the caller, which may look in several schemas
+    WVPASSEQ((int)cache->hits, 4);
+    WVPASSEQ((int)cache->misses, 0);
+
+    CIC_Destructor(cache);
+}
@@ -82,10 +82,15 @@ void ColumnInfo::writeHeader(WvDBusMsg &msg)
     msg.struct_end();
 }
 
-void Column::addDataTo(WvDBusMsg &reply)
+bool Column::addDataTo(WvDBusMsg &reply)
 {
     if (data.size() < 1)
-        return;
+        return true;
+
+    // A NULL still needs a placeholder value of the right type; it's the
+    // nullity array that says it's NULL.
+    if (isNull())
+        return addPlaceholderTo(reply);
 
     switch (info.coltype)
     {
@@ -123,9 +128,10 @@ void Column::addDataTo(WvDBusMsg &reply)
         reply.append((char *)data[0]);
         break;
     case ColumnInfo::DateTime:
-        reply.struct_start("ii");
         // FIXME: Each element in the vector should be a complete entry
-        WVPASS(data.size() >= 2);
+        if (data.size() < 2)
+            return false;
+        reply.struct_start("ii");
         reply.append(*(long long *)data[0]);
         reply.append(*(int *)data[1]);
         reply.struct_end();
@@ -135,10 +141,53 @@ void Column::addDataTo(WvDBusMsg &reply)
         break;
     case ColumnInfo::ColumnTypeMax:
     default:
-        WVFAILEQ(WvString("Unknown SQL type %d", info.coltype), WvString::null);
+        return false;
+    }
+    return true;
+}
+
+bool Column::addPlaceholderTo(WvDBusMsg &reply)
+{
+    switch (info.coltype)
+    {
+    case ColumnInfo::Int64:
+        reply.append((long long)0);
         break;
+    case ColumnInfo::Int32:
+        reply.append((int)0);
+        break;
+    case ColumnInfo::Int16:
+        reply.append((short)0);
+        break;
+    case ColumnInfo::UInt8:
+        reply.append((unsigned char)0);
+        break;
+    case ColumnInfo::Bool:
+        reply.append(false);
+        break;
+    case ColumnInfo::Double:
+        reply.append((double)0);
+        break;
+    case ColumnInfo::Binary:
+        reply.array_start("y");
+        reply.array_end();
+        break;
+    case ColumnInfo::DateTime:
+        reply.struct_start("ii");
+        reply.append((long long)0);
+        reply.append((int)0);
+        reply.struct_end();
+        break;
+    case ColumnInfo::Uuid:
+    case ColumnInfo::String:
+    case ColumnInfo::Decimal:
+        reply.append("");
+        break;
+    case ColumnInfo::ColumnTypeMax:
+    default:
+        return false;
     }
-    return;
+    return true;
 }
 
 Column& Column::append(WvStringParm str)
@@ -203,3 +252,8 @@ Column& Column::append(double element)
     return *this;
 }
 
+Column& Column::appendNull()
+{
+    data.push_back(NULL);
+    return *this;
+}
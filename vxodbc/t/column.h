@@ -81,7 +81,16 @@ public:
         return *this;
     }
 
-    void addDataTo(WvDBusMsg &reply);
+    // NULLs are stored as a NULL pointer in place of the value
+    bool isNull()
+    {
+        return data.size() > 0 && data[0] == NULL;
+    }
+
+    // These run on the fake server's thread, so they can't use WvTest;
+    // they return false if they couldn't write the value.
+    bool addDataTo(WvDBusMsg &reply);
+    bool addPlaceholderTo(WvDBusMsg &reply);
 
     Column& append(WvStringParm element);
     Column& append(long long element);
@@ -90,6 +99,7 @@ public:
     Column& append(unsigned char element);
     Column& append(signed char element);
     Column& append(double element);
+    Column& appendNull();
 };
 
 #endif
@@ -116,14 +116,8 @@ WVTEST_MAIN("Data conversion")
     // This checks that a TIMESTAMP value is truncated to 8 bytes
     t.cols.clear();
     t.addCol("data", ColumnInfo::Binary, nullable, 8, 0, 0).append("abcdefghi");
-    // This insanely ugly mess is "[y97,y98,y99,y100,y101,y102,y103,y104]" 
-    // rendered into its component bytes.  The important thing is that it
-    // only represents the first 8 bytes.
-    Test(v, "TIMESTAMP", "abcdefghi", SQL_C_BINARY, 
-	//[ 9 7 , 9 8 , 9 9 , 1 0 0 , 1 0 1 ,
-	"5B39372C39382C39392C3130302C3130312C"
-	//1 0 2 , 1 0 3 , 1 0 4 ]
-	"3130322C3130332C3130345D");
+    // The important thing is that it only represents the first 8 bytes.
+    Test(v, "TIMESTAMP", "abcdefghi", SQL_C_BINARY, "6162636465666768");
 
 #ifdef VXODBC_SUPPORTS_CONVERTING_DATETIME_TO_BINARY
     t.cols.clear();
@@ -22,7 +22,7 @@ static void DoTest(int convert_to_char)
     TIMESTAMP_STRUCT ts;
 
     v.expected_query = "select convert(datetime, '2002-12-27 18:43:21')";
-    WVPASS_SQL(CommandWithResult(Statement, v.expected_query));
+    WVPASS_SQL(CommandWithResult(Statement, v.expected_query.cstr()));
 
     WVPASS_SQL(SQLFetch(Statement));
 
@@ -59,3 +59,45 @@ WVTEST_MAIN("Date conversion to char")
 {
     DoTest(1);
 }
+
+WVTEST_MAIN("Dates before the Unix epoch")
+{
+    VxOdbcTester v;
+    bool nullable = 0;
+    Table t("unnamed");
+    t.addCol("unnamed", ColumnInfo::DateTime, nullable, 8, 0, 0);
+    // 1815-06-18 11:30:05.25 UTC
+    t.cols[0].append(-4876806595LL).append(250000);
+    v.t = &t;
+
+    TIMESTAMP_STRUCT ts;
+    SQLCHAR output[256];
+    SQLLEN dataSize;
+
+    v.expected_query = "select convert(datetime, '1815-06-18 11:30:05.25')";
+    WVPASS_SQL(CommandWithResult(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+
+    memset(&ts, 0, sizeof(ts));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_TIMESTAMP, &ts, sizeof(ts),
+            &dataSize));
+    WVPASSEQ(ts.year, 1815);
+    WVPASSEQ(ts.month, 6);
+    WVPASSEQ(ts.day, 18);
+    WVPASSEQ(ts.hour, 11);
+    WVPASSEQ(ts.minute, 30);
+    WVPASSEQ(ts.second, 5);
+    WVPASSEQ(ts.fraction, 250000000);
+    WVPASS_SQL(SQLCloseCursor(Statement));
+
+    // Midnight comes out as just the date
+    t.cols[0].zapData().append(-310521600).append(0);
+    v.expected_query = "select convert(datetime, '1960-02-29')";
+    WVPASS_SQL(CommandWithResult(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, output, sizeof(output),
+            &dataSize));
+    WVPASSEQ((char *) output, "1960-02-29");
+    WVPASSEQ(dataSize, 10);
+    WVPASS_SQL(SQLCloseCursor(Statement));
+}
@@ -18,7 +18,7 @@ void sanity_check(VxOdbcTester &v)
     WVPASS_SQL(CommandWithResult(Statement, command));
 
     v.expected_query = "select * from odbctestdata";
-    WVPASS_SQL(CommandWithResult(Statement, v.expected_query));
+    WVPASS_SQL(CommandWithResult(Statement, v.expected_query.cstr()));
 
     WVPASS_SQL(SQLFetch(Statement));
     long longval = 0;
@@ -2,6 +2,10 @@
 #include "wvtest.h"
 #include "table.h"
 #include "vxodbctester.h"
+#include <locale.h>
+#include <string>
+#include <string.h>
+#include <vector>
 
 WVTEST_MAIN("SQLGetData")
 {
@@ -33,3 +37,297 @@ WVTEST_MAIN("SQLGetData")
     WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, 16, NULL));
     WVPASSEQ(buf, "ova");
 }
+
+WVTEST_MAIN("SQLGetData on NULLs")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("whatever");
+    t.addCol("", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.cols[0].appendNull();
+    v.t = &t;
+    SQLINTEGER val = 42;
+    SQLLEN ind = 0;
+
+    v.expected_query = "SELECT CONVERT(INT,NULL)";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+
+    WVPASS_SQL(SQLFetch(Statement));
+
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_LONG, &val, 0, &ind));
+    WVPASSEQ(ind, SQL_NULL_DATA);
+    WVPASSEQ(val, 42);
+
+    /* a NULL with nowhere to say so is an error */
+    WVPASS_SQL_EQ(SQLGetData(Statement, 1, SQL_C_LONG, &val, 0, NULL),
+            SQL_ERROR);
+}
+
+WVTEST_MAIN("SQLGetData of doubles as text")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("whatever");
+    t.addCol("", ColumnInfo::Double, nullable, 8, 0, 0);
+    t.cols[0].append(1.0 / 3);
+    v.t = &t;
+    char buf[32];
+    double d = 0;
+
+    // A comma locale, if there is one, mustn't change anything
+    setlocale(LC_NUMERIC, "de_DE.UTF-8");
+
+    v.expected_query = "SELECT 1.0/3";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+
+    // Just enough digits to read back as the same double
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), NULL));
+    WVPASSEQ(buf, "0.3333333333333333");
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_DOUBLE, &d, 0, NULL));
+    WVPASSEQ(d, 1.0 / 3);
+    WVPASS_SQL(SQLCloseCursor(Statement));
+
+    t.cols[0].zapData().append(0.1);
+    v.expected_query = "SELECT 0.1";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), NULL));
+    WVPASSEQ(buf, "0.1");
+    WVPASS_SQL(SQLCloseCursor(Statement));
+
+    // Big and small ones go in exponent form, the way %g would put them
+    t.cols[0].zapData().append(-1.5e20);
+    v.expected_query = "SELECT -1.5e20";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), NULL));
+    WVPASSEQ(buf, "-1.5e+20");
+    WVPASS_SQL(SQLCloseCursor(Statement));
+
+    t.cols[0].zapData().append(0.000012);
+    v.expected_query = "SELECT 0.000012";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), NULL));
+    WVPASSEQ(buf, "1.2e-05");
+
+    setlocale(LC_NUMERIC, "C");
+}
+
+WVTEST_MAIN("SQLGetData of decimals")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("whatever");
+    t.addCol("", ColumnInfo::Decimal, nullable, 17, 38, 4);
+    t.cols[0].append("-12345678901234567890.0625");
+    v.t = &t;
+    char buf[64];
+    SQLBIGINT big = 0;
+    double d = 0;
+    SQL_NUMERIC_STRUCT ns;
+    SQLLEN len = 0;
+
+    v.expected_query = "SELECT CONVERT(DECIMAL(38,4), -12345678901234567890.0625)";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), &len));
+    WVPASSEQ(buf, "-12345678901234567890.0625");
+    WVPASSEQ(len, 26);
+
+    // 123456789012345678900625 is 0x1A249B1F10A06C96AD91
+    memset(&ns, 0, sizeof(ns));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_NUMERIC, &ns, sizeof(ns), &len));
+    WVPASSEQ(ns.precision, 24);
+    WVPASSEQ(ns.scale, 4);
+    WVPASSEQ(ns.sign, 0);
+    WVPASSEQ(ns.val[0], 0x91);
+    WVPASSEQ(ns.val[1], 0xAD);
+    WVPASSEQ(ns.val[9], 0x1A);
+    WVPASSEQ(ns.val[10], 0);
+
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_DOUBLE, &d, 0, NULL));
+    WVPASSEQ(d, -12345678901234567890.0625);
+    WVPASS_SQL(SQLCloseCursor(Statement));
+
+    // Integer types get the integer part, as atoi() would
+    t.cols[0].zapData().append("-42.75");
+    v.expected_query = "SELECT CONVERT(DECIMAL(38,4), -42.75)";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_SBIGINT, &big, 0, NULL));
+    WVPASSEQ(big, -42);
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_DOUBLE, &d, 0, NULL));
+    WVPASSEQ(d, -42.75);
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), NULL));
+    WVPASSEQ(buf, "-42.75");
+}
+
+WVTEST_MAIN("SQLGetData of a decimal too big to parse")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("whatever");
+    const char *huge = "123456789012345678901234567890123456789012";
+    t.addCol("", ColumnInfo::Decimal, nullable, 17, 38, 0);
+    t.cols[0].append(huge);
+    v.t = &t;
+    char buf[64];
+    double d = 0;
+    SQLLEN len = 0;
+
+    // It's kept as the text it came as, not turned into a zero
+    v.expected_query = "SELECT CONVERT(FLOAT, 1.2e41)";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), &len));
+    WVPASSEQ(buf, huge);
+    WVPASSEQ(len, (SQLLEN)strlen(huge));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_DOUBLE, &d, 0, NULL));
+    WVPASS(d > 1.2e41 && d < 1.3e41);
+}
+
+WVTEST_MAIN("SQLGetData of a long string in pieces")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("whatever");
+    t.addCol("", ColumnInfo::String, nullable, 0, 0, 0);
+    std::string data;
+    for (int i = 0; i < 100000; i++)
+        data += "0123456789abcdef"[i % 16];
+    t.cols[0].append(data.c_str());
+    v.t = &t;
+    char buf[4096];
+    SQLLEN len = 0;
+    SQLRETURN rc;
+    std::string got;
+
+    v.expected_query = "SELECT big FROM whatever";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+
+    // Each piece says how much was left before it
+    SQLLEN expect_left = data.size();
+    while ((rc = SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf),
+                    &len)) != SQL_NO_DATA)
+    {
+        WVPASS_SQL(rc);
+        WVPASSEQ(len, expect_left);
+        got += buf;
+        expect_left -= strlen(buf);
+        if (rc == SQL_SUCCESS)
+            break;
+    }
+    WVPASSEQ(got.size(), data.size());
+    WVPASS(got == data);
+    WVPASSEQ(SQLGetData(Statement, 1, SQL_C_CHAR, buf, sizeof(buf), &len),
+            SQL_NO_DATA);
+    WVPASS_SQL(SQLCloseCursor(Statement));
+
+    // SQL_C_BINARY pieces have no NUL taking up room
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASSEQ(SQLGetData(Statement, 1, SQL_C_BINARY, buf, sizeof(buf), &len),
+            SQL_SUCCESS_WITH_INFO);
+    WVPASSEQ(len, data.size());
+    WVPASS(memcmp(buf, data.data(), sizeof(buf)) == 0);
+    WVPASSEQ(SQLGetData(Statement, 1, SQL_C_BINARY, buf, sizeof(buf), &len),
+            SQL_SUCCESS_WITH_INFO);
+    WVPASSEQ(len, data.size() - sizeof(buf));
+    WVPASS(memcmp(buf, data.data() + sizeof(buf), sizeof(buf)) == 0);
+}
+
+// What the driver should make of utf8 (which only uses 1-3 byte
+// sequences): UCS-2, with LFs turned into CR/LF where that's the default
+static std::vector<SQLWCHAR> expected_ucs2(const char *utf8)
+{
+    std::vector<SQLWCHAR> rv;
+    const unsigned char *s = (const unsigned char *)utf8;
+
+    while (*s)
+    {
+        if (*s < 0x80)
+        {
+#ifdef _WIN32
+            if (*s == '\n')
+                rv.push_back('\r');
+#endif
+            rv.push_back(*s++);
+        }
+        else if ((*s & 0xe0) == 0xe0)
+        {
+            rv.push_back(((s[0] & 0x0f) << 12) | ((s[1] & 0x3f) << 6)
+                    | (s[2] & 0x3f));
+            s += 3;
+        }
+        else
+        {
+            rv.push_back(((s[0] & 0x1f) << 6) | (s[1] & 0x3f));
+            s += 2;
+        }
+    }
+    return rv;
+}
+
+WVTEST_MAIN("SQLGetData as SQL_C_WCHAR")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("whatever");
+    // LFs and the ends of the strings land right at (or just before)
+    // the 16-byte boundaries the converters work in
+    const char *values[] = {
+        "abcdefghijklmno\n\xc3\xa9pqrstuvwxyz\xe2\x82\xac",
+        "0123456789abcdef\nghijklmnopqrstu\xc3\xa9",
+        "0123456789abcdef",
+    };
+    const int num_values = sizeof(values) / sizeof(values[0]);
+    for (int i = 0; i < num_values; i++)
+    {
+        t.addStringCol(WvString("c%s", i), 64, nullable);
+        t.cols[i].append(values[i]);
+    }
+    v.t = &t;
+    SQLWCHAR buf[64];
+    SQLLEN ind;
+
+    // With room for all of it, it's all there at once
+    v.expected_query = "SELECT c0, c1, c2 FROM whatever";
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    for (int i = 0; i < num_values; i++)
+    {
+        std::vector<SQLWCHAR> want = expected_ucs2(values[i]);
+        size_t n = want.size();
+        memset(buf, 0xff, sizeof(buf));
+        WVPASS_SQL_EQ(SQLGetData(Statement, i + 1, SQL_C_WCHAR, buf,
+                (n + 1) * sizeof(SQLWCHAR), &ind), SQL_SUCCESS);
+        WVPASSEQ(ind, (SQLLEN)(n * sizeof(SQLWCHAR)));
+        WVPASS(!memcmp(buf, &want[0], n * sizeof(SQLWCHAR)));
+        WVPASSEQ(buf[n], 0);
+    }
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+
+    // Without room for the terminator, the last character comes next time
+    WVPASS_SQL(Command(Statement, v.expected_query.cstr()));
+    WVPASS_SQL(SQLFetch(Statement));
+    for (int i = 0; i < num_values; i++)
+    {
+        std::vector<SQLWCHAR> want = expected_ucs2(values[i]);
+        size_t n = want.size();
+        memset(buf, 0xff, sizeof(buf));
+        WVPASS_SQL_EQ(SQLGetData(Statement, i + 1, SQL_C_WCHAR, buf,
+                n * sizeof(SQLWCHAR), &ind), SQL_SUCCESS_WITH_INFO);
+        WVPASSEQ(ind, (SQLLEN)(n * sizeof(SQLWCHAR)));
+        WVPASS(!memcmp(buf, &want[0], (n - 1) * sizeof(SQLWCHAR)));
+        WVPASSEQ(buf[n - 1], 0);
+        WVPASS_SQL_EQ(SQLGetData(Statement, i + 1, SQL_C_WCHAR, buf,
+                sizeof(buf), &ind), SQL_SUCCESS);
+        WVPASSEQ(ind, (SQLLEN)sizeof(SQLWCHAR));
+        WVPASSEQ(buf[0], want[n - 1]);
+        WVPASSEQ(buf[1], 0);
+    }
+}
@@ -0,0 +1,213 @@
+#include "common.h"
+#include "wvtest.h"
+#include "table.h"
+#include "vxodbctester.h"
+
+WVTEST_MAIN("Column-wise parameter arrays")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("paramtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+
+    const char *query = "INSERT INTO paramtest VALUES (?, ?)";
+    SQLINTEGER ints[3] = { 1, 2, -3 };
+    SQLLEN int_ind[3] = { 0, 0, 0 };
+    char strs[3][8] = { "a", "it's", "" };
+    SQLLEN str_ind[3] = { SQL_NTS, SQL_NTS, SQL_NULL_DATA };
+    SQLUSMALLINT status[3] = { 99, 99, 99 };
+    SQLUINTEGER processed = 0;
+    SQLSMALLINT num_params = 0;
+    SQLLEN rows = 0;
+
+    WVPASS_SQL(SQLBindParameter(Statement, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+            SQL_INTEGER, 0, 0, ints, 0, int_ind));
+    WVPASS_SQL(SQLBindParameter(Statement, 2, SQL_PARAM_INPUT, SQL_C_CHAR,
+            SQL_VARCHAR, 7, 0, strs, sizeof(strs[0]), str_ind));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMSET_SIZE,
+            (SQLPOINTER)3, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAM_STATUS_PTR,
+            status, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMS_PROCESSED_PTR,
+            &processed, 0));
+
+    // All three rows go to the server in one go
+    v.rows_affected = 3;
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)query, SQL_NTS));
+    WVPASSEQ(v.noresult_query, "INSERT INTO paramtest VALUES (1, 'a')\n"
+        "INSERT INTO paramtest VALUES (2, 'it''s')\n"
+        "INSERT INTO paramtest VALUES (-3, NULL)");
+    WVPASSEQ(processed, 3);
+    for (int i = 0; i < 3; i++)
+        WVPASSEQ(status[i], SQL_PARAM_SUCCESS);
+    WVPASS_SQL(SQLRowCount(Statement, &rows));
+    WVPASSEQ(rows, 3);
+
+    WVPASS_SQL(SQLNumParams(Statement, &num_params));
+    WVPASSEQ(num_params, 2);
+}
+
+struct ParamRow
+{
+    SQLINTEGER i;
+    SQLLEN i_ind;
+    double d;
+    SQLLEN d_ind;
+};
+
+WVTEST_MAIN("Row-wise parameter arrays")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("paramtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+
+    // The '?' in the comment isn't a marker
+    const char *query = "UPDATE paramtest SET d = ? WHERE i = ? -- why?";
+    ParamRow rows[2] = { { 1, 0, 0.5, 0 }, { 2, 0, 0, SQL_NULL_DATA } };
+    SQLUSMALLINT ops[2] = { SQL_PARAM_PROCEED, SQL_PARAM_IGNORE };
+    SQLUSMALLINT status[2] = { 99, 99 };
+
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAM_BIND_TYPE,
+            (SQLPOINTER)sizeof(ParamRow), 0));
+    WVPASS_SQL(SQLBindParameter(Statement, 1, SQL_PARAM_INPUT, SQL_C_DOUBLE,
+            SQL_DOUBLE, 0, 0, &rows[0].d, 0, &rows[0].d_ind));
+    WVPASS_SQL(SQLBindParameter(Statement, 2, SQL_PARAM_INPUT, SQL_C_LONG,
+            SQL_INTEGER, 0, 0, &rows[0].i, 0, &rows[0].i_ind));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMSET_SIZE,
+            (SQLPOINTER)2, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAM_OPERATION_PTR,
+            ops, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAM_STATUS_PTR,
+            status, 0));
+
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)query, SQL_NTS));
+    WVPASSEQ(v.noresult_query,
+            "UPDATE paramtest SET d = 0.5 WHERE i = 1 -- why?");
+    WVPASSEQ(status[0], SQL_PARAM_SUCCESS);
+    WVPASSEQ(status[1], SQL_PARAM_UNUSED);
+}
+
+WVTEST_MAIN("Re-executing a prepared statement")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("paramtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+
+    const char *query = "SELECT i FROM paramtest WHERE i = ? AND s = '?'";
+    SQLINTEGER val = 0;
+    SQLLEN ind = 0;
+    SQLSMALLINT num_params = 0;
+
+    WVPASS_SQL(SQLPrepare(Statement, (SQLCHAR *)query, SQL_NTS));
+    WVPASS_SQL(SQLNumParams(Statement, &num_params));
+    WVPASSEQ(num_params, 1);
+    WVPASS_SQL(SQLBindParameter(Statement, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+            SQL_INTEGER, 0, 0, &val, 0, &ind));
+
+    for (val = 1; val <= 3; val++)
+    {
+        WvString expected("SELECT i FROM paramtest WHERE i = %s AND s = '?'",
+                val);
+        v.expected_query = expected;
+        WVPASS_SQL(SQLExecute(Statement));
+        WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+    }
+
+    // Another statement with the same text shares the parsed copy
+    HSTMT stmt2;
+    WVPASS_SQL(SQLAllocHandle(SQL_HANDLE_STMT, Connection, &stmt2));
+    WVPASS_SQL(SQLPrepare(stmt2, (SQLCHAR *)query, SQL_NTS));
+    WVPASS_SQL(SQLBindParameter(stmt2, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+            SQL_INTEGER, 0, 0, &val, 0, &ind));
+    val = 42;
+    v.expected_query = "SELECT i FROM paramtest WHERE i = 42 AND s = '?'";
+    WVPASS_SQL(SQLExecute(stmt2));
+    WVPASS_SQL(SQLFreeHandle(SQL_HANDLE_STMT, stmt2));
+}
+
+WVTEST_MAIN("Statements that don't return rows")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("paramtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+
+    const char *update = "update paramtest set i = 20";
+    SQLLEN rows = 0;
+    SQLSMALLINT cols = -1;
+
+    v.rows_affected = 7;
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)update, SQL_NTS));
+    WVPASSEQ(v.noresult_query, update);
+    WVPASS_SQL(SQLRowCount(Statement, &rows));
+    WVPASSEQ(rows, 7);
+    WVPASS_SQL(SQLNumResultCols(Statement, &cols));
+    WVPASSEQ(cols, 0);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+
+    // A second statement might return rows, so it's run as a query
+    v.noresult_query = WvString::null;
+    v.expected_query = "delete from paramtest where i = 20; "
+        "select i from paramtest";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+            SQL_NTS));
+    WVPASSEQ(v.noresult_query, WvString::null);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+
+    // Nor can anything with an OUTPUT clause, whose rows have to come back
+    t.cols[0].append(20);
+    v.expected_query = "update paramtest set i = 21 output deleted.i";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)v.expected_query.cstr(),
+            SQL_NTS));
+    WVPASSEQ(v.noresult_query, WvString::null);
+    WVPASS_SQL(SQLFetch(Statement));
+    SQLINTEGER i = 0;
+    SQLLEN ind = 0;
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_LONG, &i, 0, &ind));
+    WVPASSEQ(i, 20);
+    WVPASSEQ(SQLFetch(Statement), SQL_NO_DATA);
+    WVPASS_SQL(SQLFreeStmt(Statement, SQL_CLOSE));
+
+    // ...but a column that happens to be called something like it is fine
+    v.expected_query = WvString::null;
+    const char *update2 = "update paramtest set output_id = 1";
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)update2, SQL_NTS));
+    WVPASSEQ(v.noresult_query, update2);
+}
+
+WVTEST_MAIN("A parameter batch the server turns down")
+{
+    VxOdbcTester v;
+    bool nullable = 1;
+    Table t("paramtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    v.t = &t;
+
+    // Nothing's expected, so the fake server answers with an error
+    const char *query = "SELECT i FROM paramtest WHERE i = ?";
+    SQLINTEGER ints[2] = { 1, 2 };
+    SQLLEN int_ind[2] = { 0, 0 };
+    SQLUSMALLINT status[2] = { 99, 99 };
+    SQLUINTEGER processed = 0;
+
+    WVPASS_SQL(SQLBindParameter(Statement, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+            SQL_INTEGER, 0, 0, ints, 0, int_ind));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMSET_SIZE,
+            (SQLPOINTER)2, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAM_STATUS_PTR,
+            status, 0));
+    WVPASS_SQL(SQLSetStmtAttr(Statement, SQL_ATTR_PARAMS_PROCESSED_PTR,
+            &processed, 0));
+
+    WVPASSEQ(SQLExecDirect(Statement, (SQLCHAR *)query, SQL_NTS),
+            SQL_ERROR);
+    WVPASSEQ(processed, 2);
+    WVPASSEQ(status[0], SQL_PARAM_ERROR);
+    WVPASSEQ(status[1], SQL_PARAM_ERROR);
+}
@@ -17,7 +17,7 @@ WVTEST_MAIN("SQLPrepare results")
 
     v.expected_query = 
         "create table odbctestdata (i int, c char(20), n numeric(34,12) )";
-    WVPASS_SQL(CommandWithResult(Statement, v.expected_query));
+    WVPASS_SQL(CommandWithResult(Statement, v.expected_query.cstr()));
 
     /* reset state */
     v.expected_query = "select * from odbctestdata";
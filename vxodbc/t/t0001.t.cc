@@ -58,7 +58,7 @@ WVTEST_MAIN("Basic data insertion and retrieval")
     WVPASS_SQL(CommandWithResult(Statement, command)); 
 
     v.expected_query = "select * from odbctestdata";
-    WVPASS_SQL(CommandWithResult(Statement, v.expected_query));
+    WVPASS_SQL(CommandWithResult(Statement, v.expected_query.cstr()));
 
     WVPASS_SQL(SQLFetch(Statement));
 
@@ -0,0 +1,173 @@
+#include "common.h"
+#include "wvtest.h"
+#include "table.h"
+#include "vxodbctester.h"
+
+// FIXME: Only pthreads for now
+#ifndef WIN32
+
+#include <pthread.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define NUM_THREADS 8
+#define QUERIES_PER_THREAD 50
+
+struct Worker
+{
+    pthread_t thread;
+    int successes;
+};
+
+static const char *query = "SELECT i FROM threadtest";
+
+// Each worker gets its own connection, and runs its queries with no
+// coordination with the others.  WvTest isn't thread-safe, so they just
+// count their successes and the main thread checks them afterwards.
+static void *worker_main(void *userdata)
+{
+    Worker *w = (Worker *)userdata;
+    HDBC dbc;
+    HSTMT stmt;
+
+    w->successes = 0;
+    if (!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_DBC, Environment, &dbc)))
+        return NULL;
+    if (SQL_SUCCEEDED(SQLConnect(dbc, (SQLCHAR *)SERVER, SQL_NTS,
+                (SQLCHAR *)USER, SQL_NTS, (SQLCHAR *)PASSWORD, SQL_NTS)))
+    {
+        if (SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, dbc, &stmt)))
+        {
+            for (int i = 0; i < QUERIES_PER_THREAD; i++)
+            {
+                SQLINTEGER val = 0;
+                SQLLEN ind = 0;
+
+                if (SQL_SUCCEEDED(SQLExecDirect(stmt, (SQLCHAR *)query,
+                            SQL_NTS))
+                    && SQL_SUCCEEDED(SQLFetch(stmt))
+                    && SQL_SUCCEEDED(SQLGetData(stmt, 1, SQL_C_LONG, &val,
+                            0, &ind))
+                    && val == 42
+                    && SQLFetch(stmt) == SQL_NO_DATA)
+                    w->successes++;
+                SQLFreeStmt(stmt, SQL_CLOSE);
+            }
+            SQLFreeHandle(SQL_HANDLE_STMT, stmt);
+        }
+        SQLDisconnect(dbc);
+    }
+    SQLFreeHandle(SQL_HANDLE_DBC, dbc);
+    return NULL;
+}
+
+WVTEST_MAIN("Concurrent queries on separate connections")
+{
+    VxOdbcTester v;
+    bool nullable = 0;
+    Table t("threadtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.cols[0].append(42);
+    v.t = &t;
+    v.expected_query = query;
+
+    Worker workers[NUM_THREADS];
+    struct timeval start, end;
+
+    gettimeofday(&start, NULL);
+    for (int i = 0; i < NUM_THREADS; i++)
+        WVPASSEQ(pthread_create(&workers[i].thread, NULL, worker_main,
+                &workers[i]), 0);
+
+    int total = 0;
+    for (int i = 0; i < NUM_THREADS; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        WVPASSEQ(workers[i].successes, QUERIES_PER_THREAD);
+        total += workers[i].successes;
+    }
+    gettimeofday(&end, NULL);
+
+    double secs = (end.tv_sec - start.tv_sec)
+        + (end.tv_usec - start.tv_usec) / 1000000.0;
+    fprintf(stderr, "%d queries on %d threads in %.3f seconds "
+            "(%.1f queries/sec)\n", total, NUM_THREADS, secs,
+            secs > 0 ? total / secs : 0.0);
+    WVPASSEQ(total, NUM_THREADS * QUERIES_PER_THREAD);
+}
+
+struct CancelWorker
+{
+    pthread_t thread;
+    RETCODE ret;
+    char state[6];
+};
+
+static const char *slow_query = "SELECT i FROM slowtest";
+
+static void *cancel_worker_main(void *userdata)
+{
+    CancelWorker *w = (CancelWorker *)userdata;
+    SQLINTEGER native = 0;
+    SQLSMALLINT len = 0;
+
+    w->ret = SQLExecDirect(Statement, (SQLCHAR *)slow_query, SQL_NTS);
+    SQLGetDiagRec(SQL_HANDLE_STMT, Statement, 1, (SQLCHAR *)w->state,
+            &native, NULL, 0, &len);
+    return NULL;
+}
+
+WVTEST_MAIN("SQLCancel from another thread stops a running query")
+{
+    VxOdbcTester v;
+    bool nullable = 0;
+    Table t("slowtest");
+    t.addCol("i", ColumnInfo::Int32, nullable, 4, 0, 0);
+    t.cols[0].append(42);
+    v.t = &t;
+    v.hang_query = slow_query;
+
+    CancelWorker w;
+    w.ret = SQL_SUCCESS;
+    memset(w.state, 0, sizeof(w.state));
+    WVPASSEQ(pthread_create(&w.thread, NULL, cancel_worker_main, &w), 0);
+
+    // The server never answers by itself, so the worker is stuck in
+    // SQLExecDirect (holding the statement) until this gets through
+    for (int i = 0; i < 500 && !v.hung; i++)
+        usleep(10000);
+    WVPASS(v.hung);
+
+    // The worker spends up to a second at a time waiting for rows, which
+    // mustn't hold the cancel up
+    struct timeval start, now;
+    double secs = 0;
+    gettimeofday(&start, NULL);
+    WVPASS_SQL(SQLCancel(Statement));
+    while (v.num_cancels < 1 && secs < 5)
+    {
+        usleep(1000);
+        gettimeofday(&now, NULL);
+        secs = (now.tv_sec - start.tv_sec)
+            + (now.tv_usec - start.tv_usec) / 1000000.0;
+    }
+    fprintf(stderr, "The cancel arrived after %.3f seconds\n", secs);
+    WVPASS(secs < 0.5);
+
+    pthread_join(w.thread, NULL);
+    WVPASSEQ(w.ret, SQL_ERROR);
+    WVPASSEQ(w.state, "HY008");
+    WVPASSEQ(v.num_cancels, 1);
+
+    // The statement's fine for the next query
+    v.expected_query = slow_query;
+    v.hang_query = WvString::null;
+    SQLINTEGER val = 0;
+    SQLLEN ind = 0;
+    WVPASS_SQL(SQLExecDirect(Statement, (SQLCHAR *)slow_query, SQL_NTS));
+    WVPASS_SQL(SQLFetch(Statement));
+    WVPASS_SQL(SQLGetData(Statement, 1, SQL_C_LONG, &val, 0, &ind));
+    WVPASSEQ(val, 42);
+}
+
+#endif // WIN32
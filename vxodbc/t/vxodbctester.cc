@@ -28,9 +28,17 @@ VxOdbcTester::VxOdbcTester(bool always_create_server) :
     dbus_server(),
     vxserver_conn(dbus_server.moniker),
     t(NULL),
+    num_rows(1),
     expected_query(WvString::null),
     num_names_registered(0),
-    log("Fake Versaplex", WvLog::Debug1)
+    num_cancels(0),
+    hung_msg(NULL),
+    hung(false),
+    bulk_rows(0),
+    rows_affected(1),
+    log("Fake Versaplex", WvLog::Debug1),
+    server_running(false),
+    server_failures("")
 {
     dbus_moniker = dbus_server.moniker;
 
@@ -48,6 +56,7 @@ VxOdbcTester::VxOdbcTester(bool always_create_server) :
         WvDBusCallback cb(wv::bind(
             &VxOdbcTester::msg_received, this, _1));
         vxserver_conn.add_callback(WvDBusConn::PriNormal, cb, this);
+        start_server();
     }
     else
         dbus_moniker = "dbus:session";
@@ -61,6 +70,9 @@ VxOdbcTester::VxOdbcTester(bool always_create_server) :
 VxOdbcTester::~VxOdbcTester()
 {
     Disconnect();
+    stop_server();
+    WVPASSEQ(server_failures, "");
+    delete hung_msg;
 
 #ifndef WIN32
     // Dirty hack: Close any WvLog files VxODBC opened.  This keeps the WvTest
@@ -80,6 +92,69 @@ VxOdbcTester::~VxOdbcTester()
 	WvIStreamList::globallist.runonce(10);
 }
 
+#ifdef WIN32
+static DWORD WINAPI server_thread_main(LPVOID userdata)
+{
+    ((VxOdbcTester *)userdata)->run_server();
+    return 0;
+}
+#else
+static void *server_thread_main(void *userdata)
+{
+    ((VxOdbcTester *)userdata)->run_server();
+    return NULL;
+}
+#endif
+
+void VxOdbcTester::run_server()
+{
+    while (server_running)
+        WvIStreamList::globallist.runonce(10);
+}
+
+void VxOdbcTester::start_server()
+{
+    server_running = true;
+#ifdef WIN32
+    server_thread = CreateThread(NULL, 0, server_thread_main, this, 0, NULL);
+    WVPASS(server_thread != NULL);
+#else
+    WVPASSEQ(pthread_create(&server_thread, NULL, server_thread_main, this),
+        0);
+#endif
+}
+
+void VxOdbcTester::stop_server()
+{
+    if (!server_running)
+        return;
+    server_running = false;
+#ifdef WIN32
+    WaitForSingleObject(server_thread, INFINITE);
+    CloseHandle(server_thread);
+#else
+    pthread_join(server_thread, NULL);
+#endif
+}
+
+void VxOdbcTester::count_cancel()
+{
+#ifdef WIN32
+    InterlockedIncrement((LONG volatile *)&num_cancels);
+#else
+    __sync_add_and_fetch(&num_cancels, 1);
+#endif
+}
+
+// Only for the server thread, which mustn't use WvTest itself
+void VxOdbcTester::server_failed(WvStringParm what)
+{
+    log("*** %s\n", what);
+    failures_lock.acquire();
+    server_failures.append("%s\n", what);
+    failures_lock.release();
+}
+
 bool VxOdbcTester::msg_received(WvDBusMsg &msg)
 {
     if (msg.get_dest() != "vx.versaplexd")
@@ -108,7 +183,17 @@ bool VxOdbcTester::msg_received(WvDBusMsg &msg)
 	// ExecChunkRecordset is only meant for really big queries anyways.
         log("Processing ExecChunkRecordSet\n");
         WvString query(msg.get_argstr());
-        if (query == expected_query)
+        // Our own copies of what the test set, which it may change
+        WvString hang(hang_query.get());
+        Table *t = this->t.get();
+        int num_rows = this->num_rows.get();
+        if (!!hang && query == hang && !hung_msg)
+        {
+            log("*** Sitting on it\n");
+            hung_msg = new WvDBusMsg(msg);
+            hung = true;
+        }
+        else if (query == expected_query.get())
         {
             log("*** Sending reply\n");
             WvDBusMsg reply = msg.reply();
@@ -125,27 +210,30 @@ bool VxOdbcTester::msg_received(WvDBusMsg &msg)
                 WvString sig(t->getDBusTypeSignature());
                 log("Body signature is %s\n", sig);
                 reply.varray_start(WvString("(%s)", sig));
-                if (t->cols[0].data.size() > 0) {
+                for (int r = 0; t->cols[0].data.size() > 0 && r < num_rows;
+                        r++)
+                {
                     reply.struct_start(sig);
                     // Write the body
                     for (it = t->cols.begin(); it != t->cols.end(); ++it)
                     {
-                        it->addDataTo(reply);
+                        if (!it->addDataTo(reply))
+                            server_failed(WvString("Can't send column %s",
+                                    it->info.colname));
                     }
                     reply.struct_end();
                 } 
                 reply.varray_end();
             }
 
-            // Nullity
-            // FIXME: Need to send one copy per row, and properly reflect 
-            // the data (not the column's overall nullability)
+            // Nullity: one array per row, saying which values are NULL
             reply.array_start("ay");
-            if (t->cols.size() > 0 && t->cols[0].data.size() > 0)
+            for (int r = 0; t->cols.size() > 0 && t->cols[0].data.size() > 0
+                    && r < num_rows; r++)
             {
                 reply.array_start("y");
                 for (it = t->cols.begin(); it != t->cols.end(); ++it)
-                    reply.append(it->info.nullable);
+                    reply.append((unsigned char)it->isNull());
                 reply.array_end();
             }
             reply.array_end();
@@ -158,6 +246,63 @@ bool VxOdbcTester::msg_received(WvDBusMsg &msg)
                 "Not yet implemented.  Try again later.").send(vxserver_conn);
         }
     }
+    else if (msg.get_member() == "CancelQuery")
+    {
+        // Our replies all go out straight away, except to hang_query, so
+        // that's the only thing there can be to cancel; otherwise just
+        // count them.
+        log("Processing CancelQuery\n");
+        count_cancel();
+        WvDBusMsg::Iter top(msg);
+        uint32_t serial = top.getnext().get_int();
+        if (hung_msg && hung_msg->get_serial() == serial)
+        {
+            WvDBusError(*hung_msg, "vx.db.sqlerror",
+                "The query was cancelled").send(vxserver_conn);
+            delete hung_msg;
+            hung_msg = NULL;
+        }
+        WvDBusMsg reply = msg.reply();
+        reply.append("Cancel");
+        reply.send(vxserver_conn);
+    }
+    else if (msg.get_member() == "ExecNoResult")
+    {
+        // There's nothing to write to, so take any statement at all, and
+        // remember the last one for the test to check.
+        log("Processing ExecNoResult\n");
+        noresult_query = msg.get_argstr();
+        WvDBusMsg reply = msg.reply();
+        reply.append(rows_affected.get());
+        reply.send(vxserver_conn);
+    }
+    else if (msg.get_member() == "BulkInsert")
+    {
+        // Just remember where the rows were going, into which columns,
+        // and how many there were
+        log("Processing BulkInsert\n");
+        WvDBusMsg::Iter top(msg);
+        WvString table = top.getnext();
+        bulk_table = table;
+        WvDBusMsg::Iter colinfo(top.getnext().open());
+        bulk_columns = "";
+        while (colinfo.next())
+        {
+            WvDBusMsg::Iter ci(colinfo.open());
+            ci.getnext();
+            if (!!bulk_columns)
+                bulk_columns.append(",");
+            bulk_columns.append(ci.getnext().get_str());
+        }
+        WvDBusMsg::Iter data(top.getnext().open().getnext().open());
+        int count = 0;
+        while (data.next())
+            count++;
+        bulk_rows += count;
+        WvDBusMsg reply = msg.reply();
+        reply.append((int)count);
+        reply.send(vxserver_conn);
+    }
     else if (msg.get_member() == "Test")
     {
         log("Processing Test message!\n");
@@ -178,17 +323,16 @@ bool VxOdbcTester::msg_received(WvDBusMsg &msg)
 	
 	reply.struct_start(sig);
         // Write the body
-        f.cols[0].addDataTo(reply);
+        if (!f.cols[0].addDataTo(reply))
+            server_failed("Can't send the Test column");
         reply.struct_end();
         
 	reply.varray_end();
 
         // Nullity
-        // FIXME: Need to send one copy per row, and properly reflect 
-        // the data (not the column's overall nullability)
         reply.array_start("ay");
         reply.array_start("y");
-        reply.append(f.cols[0].info.nullable);
+        reply.append((unsigned char)f.cols[0].isNull());
         reply.array_end();
         reply.array_end();
 
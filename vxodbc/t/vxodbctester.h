@@ -7,6 +7,12 @@
 #include "wvdbusserver.h"
 #include "wvdbusconn.h"
 
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 #define WVPASS_SQL(sql) \
     do \
     { \
@@ -19,6 +25,88 @@ class Table;
 class WvDBusConn;
 class WvDBusMsg;
 
+class TesterLock
+{
+#ifdef WIN32
+    CRITICAL_SECTION cs;
+#else
+    pthread_mutex_t mutex;
+#endif
+    TesterLock(const TesterLock &);
+    TesterLock &operator=(const TesterLock &);
+
+public:
+#ifdef WIN32
+    TesterLock() { InitializeCriticalSection(&cs); }
+    ~TesterLock() { DeleteCriticalSection(&cs); }
+    void acquire() { EnterCriticalSection(&cs); }
+    void release() { LeaveCriticalSection(&cs); }
+#else
+    TesterLock() { pthread_mutex_init(&mutex, NULL); }
+    ~TesterLock() { pthread_mutex_destroy(&mutex); }
+    void acquire() { pthread_mutex_lock(&mutex); }
+    void release() { pthread_mutex_unlock(&mutex); }
+#endif
+};
+
+// WvStrings share their buffers with non-atomic refcounts, so the server
+// thread has to have one all of its own
+static inline void make_private(WvString &s)
+{
+    s.unique();
+}
+
+template <typename T>
+static inline void make_private(T &)
+{
+}
+
+// Something a test sets for the fake server, which reads it on its own
+// thread.  Only the test thread ever sets it, so the test can read it
+// back directly; the server takes a copy with get().
+template <typename T>
+class ServerSetting
+{
+    T val;
+    mutable TesterLock lock;
+    ServerSetting(const ServerSetting &);
+
+public:
+    ServerSetting(const T &_val) : val(_val) { }
+
+    ServerSetting &operator=(const T &_val)
+    {
+        lock.acquire();
+        val = _val;
+        lock.release();
+        return *this;
+    }
+
+    operator const T &() const
+    {
+        return val;
+    }
+
+    const T &operator->() const
+    {
+        return val;
+    }
+
+    const char *cstr() const
+    {
+        return val.cstr();
+    }
+
+    T get() const
+    {
+        lock.acquire();
+        T copy(val);
+        make_private(copy);
+        lock.release();
+        return copy;
+    }
+};
+
 class TestDBusServer
 {
 public:
@@ -50,11 +138,39 @@ public:
     TestDBusServer dbus_server;
     WvDBusConn vxserver_conn;
     WvString dbus_moniker;
-    Table *t;
-    WvString expected_query;
+    ServerSetting<Table *> t;
+    // How many copies of t's row to send back for expected_query
+    ServerSetting<int> num_rows;
+    ServerSetting<WvString> expected_query;
     int num_names_registered;
+    // Bumped by the server thread, so only ever with count_cancel()
+    volatile int num_cancels;
+    // A query the server sits on without answering until it's cancelled,
+    // and the message it's sitting on
+    ServerSetting<WvString> hang_query;
+    WvDBusMsg *hung_msg;
+    volatile bool hung;
+    WvString bulk_table;
+    // The column names the last BulkInsert sent, separated by commas
+    WvString bulk_columns;
+    WvString noresult_query;
+    ServerSetting<int> rows_affected;
+    volatile int bulk_rows;
     WvLog log;
 
+    // The fake server runs on its own thread, the way a real one would
+    // be in its own process; VxODBC only runs its own connections' streams.
+    // WvTest isn't thread-safe, so whatever goes wrong there is noted in
+    // server_failures, and checked once the server has stopped.
+    volatile bool server_running;
+    TesterLock failures_lock;
+    WvString server_failures;
+#ifdef WIN32
+    HANDLE server_thread;
+#else
+    pthread_t server_thread;
+#endif
+
     // Set always_create_server to true if you don't ever want to use the real
     // Versaplex server, regardless of what USE_REAL_VERSAPLEX says.
     VxOdbcTester(bool always_create_server = false);
@@ -62,6 +178,11 @@ public:
 
     bool name_request_cb(WvDBusMsg &msg); 
     bool msg_received(WvDBusMsg &msg);
+    void count_cancel();
+    void server_failed(WvStringParm what);
+    void run_server();
+    void start_server();
+    void stop_server();
 };
 
 #endif // VXODBCTESTER_H
@@ -1,39 +1,301 @@
 #include "vxhelpers.h"
+#include "catcache.h"
 #include "wvistreamlist.h"
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
+#ifndef WIN32
+#include <sys/select.h>
+#include <sys/socket.h>
+#endif
 
-static std::map<unsigned int, VxResultSet *> signal_returns;
+VxQueryTable::VxQueryTable(ConnectionClass *_owner)
+    : entries(16), num_entries(0), dbus(NULL), owner(_owner),
+      num_waiting(0), pending_wakes(0)
+{
+    VXLOCK_INIT(streams_lock);
+    VXLOCK_INIT(entries_lock);
+    VXLOCK_INIT(wake_lock);
+    VXLOCK_INIT(cancels_lock);
+}
+
+VxQueryTable::~VxQueryTable()
+{
+    if (dbus)
+    {
+	streams.unlink(dbus);
+	dbus->del_callback(this);
+    }
+    VXLOCK_DELETE(cancels_lock);
+    VXLOCK_DELETE(wake_lock);
+    VXLOCK_DELETE(entries_lock);
+    VXLOCK_DELETE(streams_lock);
+}
+
+// Start routing the signals arriving on conn.  Normally that's the same
+// connection every time, but after a reconnect it's a new one.
+void VxQueryTable::attach(WvDBusConn &conn)
+{
+    VXLOCK_ACQUIRE(streams_lock);
+    if (dbus != &conn)
+    {
+	if (dbus)
+	{
+	    streams.unlink(dbus);
+	    dbus->del_callback(this);
+	}
+	dbus = &conn;
+	conn.add_callback(WvDBusConn::PriNormal,
+			  wv::bind(&VxQueryTable::signal_sorter, this, _1),
+			  this);
+	streams.append(&conn, false, "vxodbc dbus");
+    }
+    release_streams();
+}
+
+// Run this connection's streams, and only this connection's: the plain
+// runonce() would run WvIStreamList::globallist too, which every other
+// thread in the process would then be fighting over.  The streams are
+// only locked while something that has already arrived is handled, so
+// waiting for the server doesn't hold up other statements' sends and
+// callbacks.
+void VxQueryTable::runonce(int msec_timeout)
+{
+    int fd;
+
+    if (run_ready(&fd) || msec_timeout == 0 || fd < 0)
+	return;
+    wait(fd, msec_timeout);
+    run_ready(&fd);
+}
+
+// Handle whatever is ready on the streams without waiting, and say
+// whether there was anything.  Also notes the fd to wait on for more.
+bool VxQueryTable::run_ready(int *fd)
+{
+    bool ran;
+
+    VXLOCK_ACQUIRE(streams_lock);
+    ran = streams.select(0, true, false);
+    if (ran)
+	streams.callback();
+    *fd = dbus && dbus->isok() ? dbus->getrfd() : -1;
+    release_streams();
+    if (ran)
+	wake_waiters();
+    return ran;
+}
+
+// Wait, unlocked, until fd has something to read, another thread
+// handles something, or msec_timeout runs out.  Anything the DBus
+// connection had already read in is handled by run_ready() first, so
+// fd is all there is left to wait for.
+void VxQueryTable::wait(int fd, int msec_timeout)
+{
+    int wakefd = wake.getrfd();
+    fd_set rfds;
+    struct timeval tv;
+    char c;
+
+    FD_ZERO(&rfds);
+    FD_SET(fd, &rfds);
+    FD_SET(wakefd, &rfds);
+    tv.tv_sec = msec_timeout / 1000;
+    tv.tv_usec = (msec_timeout % 1000) * 1000;
+
+    VXLOCK_ACQUIRE(wake_lock);
+    num_waiting++;
+    VXLOCK_RELEASE(wake_lock);
+
+    if (::select((fd > wakefd ? fd : wakefd) + 1, &rfds, NULL, NULL, &tv)
+	< 0)
+	FD_ZERO(&rfds);
+
+    VXLOCK_ACQUIRE(wake_lock);
+    num_waiting--;
+    if (FD_ISSET(wakefd, &rfds) && pending_wakes > 0)
+    {
+	::recv(wakefd, &c, 1, 0);
+	pending_wakes--;
+    }
+    VXLOCK_RELEASE(wake_lock);
+}
+
+// Wake everyone in wait(), once each
+void VxQueryTable::wake_waiters()
+{
+    VXLOCK_ACQUIRE(wake_lock);
+    for (; pending_wakes < num_waiting; pending_wakes++)
+	::send(wake.getwfd(), "", 1, 0);
+    VXLOCK_RELEASE(wake_lock);
+}
+
+// Deal with whatever has already arrived, without waiting for more.
+void VxQueryTable::flush()
+{
+    VXLOCK_ACQUIRE(streams_lock);
+    while (streams.select(0, true, false))
+	streams.callback();
+    release_streams();
+}
+
+// The slot serial is in, or the free slot where it would go.  There's
+// always a free slot, since the table is never more than half full.
+int VxQueryTable::slot_of(uint32_t serial) const
+{
+    unsigned mask = entries.size() - 1;
+    unsigned i = serial & mask;
+
+    while (entries[i].rs && entries[i].serial != serial)
+	i = (i + 1) & mask;
+    return (int)i;
+}
+
+void VxQueryTable::grow()
+{
+    std::vector<Slot> old(entries.size() * 2);
+
+    old.swap(entries);
+    for (unsigned i = 0; i < old.size(); i++)
+	if (old[i].rs)
+	    entries[slot_of(old[i].serial)] = old[i];
+}
+
+void VxQueryTable::add(uint32_t serial, VxResultSet *rs)
+{
+    VXLOCK_ACQUIRE(entries_lock);
+    if ((num_entries + 1) * 2 > entries.size())
+	grow();
+    Slot &slot = entries[slot_of(serial)];
+    if (!slot.rs)
+	num_entries++;
+    slot.serial = serial;
+    slot.rs = rs;
+    VXLOCK_RELEASE(entries_lock);
+}
+
+// Empty serial's slot, and move up anything after it that would
+// otherwise no longer be found from where its search starts.
+void VxQueryTable::remove(uint32_t serial)
+{
+    VXLOCK_ACQUIRE(entries_lock);
+    unsigned mask = entries.size() - 1;
+    unsigned hole = slot_of(serial), i = hole;
+
+    if (entries[hole].rs)
+    {
+	entries[hole].rs = NULL;
+	num_entries--;
+	while (i = (i + 1) & mask, entries[i].rs)
+	{
+	    unsigned home = entries[i].serial & mask;
+
+	    // Stays put if its home is cyclically in (hole, i]
+	    if (hole < i ? (home > hole && home <= i)
+		: (home > hole || home <= i))
+		continue;
+	    entries[hole] = entries[i];
+	    entries[i].rs = NULL;
+	    hole = i;
+	}
+    }
+    VXLOCK_RELEASE(entries_lock);
+}
+
+// Ask versaplexd to stop working on the call with this serial.  Whoever
+// is waiting for it gets an error back, which ends their wait.  This
+// never waits for the streams: if another thread has them, it sends the
+// cancel as it lets go.
+void VxQueryTable::cancel(uint32_t serial)
+{
+    VXLOCK_ACQUIRE(cancels_lock);
+    cancels.push_back(serial);
+    VXLOCK_RELEASE(cancels_lock);
+    if (VXLOCK_TRYACQUIRE(streams_lock))
+    {
+	send_cancels();
+	release_streams();
+    }
+}
 
-static void update_sigrets(unsigned int key, VxResultSet *value)
+// With the streams locked, send whatever cancel() has queued up
+void VxQueryTable::send_cancels()
 {
-    signal_returns[key] = value;
+    std::vector<uint32_t> serials;
+
+    VXLOCK_ACQUIRE(cancels_lock);
+    serials.swap(cancels);
+    VXLOCK_RELEASE(cancels_lock);
+    for (unsigned i = 0; i < serials.size(); i++)
+    {
+	if (!dbus || !dbus->isok())
+	    break;
+	WvDBusMsg msg("vx.versaplexd", "/db", "vx.db", "CancelQuery");
+	msg.append(serials[i]);
+	mylog("Cancelling query #%u\n", serials[i]);
+	dbus->send(msg, wv::bind(&VxQueryTable::reply_sorter, this, _1),
+		   50000);
+    }
 }
 
-static bool signal_sorter(WvDBusMsg &msg)
+// Let go of the streams.  A cancel() that came along while we had them
+// left its CancelQuery for us, so send it now, unless someone else has
+// taken the streams in the meantime and will do it when they let go.
+void VxQueryTable::release_streams()
+{
+    bool queued;
+
+    for (;;)
+    {
+	VXLOCK_RELEASE(streams_lock);
+	VXLOCK_ACQUIRE(cancels_lock);
+	queued = !cancels.empty();
+	VXLOCK_RELEASE(cancels_lock);
+	if (!queued || !VXLOCK_TRYACQUIRE(streams_lock))
+	    break;
+	send_cancels();
+    }
+}
+
+VxResultSet *VxQueryTable::find(uint32_t serial)
+{
+    VxResultSet *rs = NULL;
+
+    VXLOCK_ACQUIRE(entries_lock);
+    rs = entries[slot_of(serial)].rs;
+    VXLOCK_RELEASE(entries_lock);
+    return rs;
+}
+
+bool VxQueryTable::signal_sorter(WvDBusMsg &msg)
 {
     WvString member = msg.get_member();
     // We have a signal, and it's a signal carrying data we want!
     if (!!member && member == "ChunkRecordsetSig")
     {
     	WvDBusMsg::Iter top(msg);
-	unsigned int reply_serial =
-	    (unsigned int)top.getnext().getnext().getnext().getnext().get_int();
-	if (signal_returns[reply_serial])
-	{
-	    signal_returns[reply_serial]->process_msg(msg);
-	    return true;
-	}
+	uint32_t reply_serial =
+	    (uint32_t)top.getnext().getnext().getnext().getnext().get_int();
+	VxResultSet *rs = find(reply_serial);
+	// Chunks for a query we've given up on (closed or cancelled) are
+	// just dropped.
+	if (rs)
+	    rs->process_msg(msg);
+	return true;
     }
 
     return false;
 }
 
-static std::map<WvDBusConn *, bool> callbacked_conns;
-
-static void erase_conn(WvStream &s)
+bool VxQueryTable::reply_sorter(WvDBusMsg &msg)
 {
-    WvDBusConn *c = (WvDBusConn *)&s;
-    callbacked_conns.erase(c);
+    // If nobody is waiting for this any more (eg. the statement was closed
+    // before all its rows arrived), just throw it away.
+    VxResultSet *rs = find(msg.get_replyserial());
+    if (rs)
+	rs->process_reply(msg);
+    return true;
 }
 
 void VxResultSet::process_msg(WvDBusMsg &msg)
@@ -66,59 +328,475 @@ void VxResultSet::process_msg(WvDBusMsg &msg)
     	process_colinfo = false;
     }
     
-    for (data.rewind(); data.next(); )
+    // Every chunk says how many rows it has, so make room for all of them
+    // at once instead of growing the cache a row at a time.
+    int num_rows;
+    for (num_rows = 0; data.next(); ++num_rows) { }
+    data.rewind();
+
+    TupleField *first = NULL;
+    if (num_rows <= 0)
+	return;
+    if (typed)
+    {
+	if (!QR_reserve_columnar(res, num_rows))
+	{
+	    mylog("Couldn't make room for %d rows, dropping the chunk\n",
+		  num_rows);
+	    return;
+	}
+    }
+    else
     {
-	TupleField *tuple = QR_AddNew(res);
+	QR_reserve_arena(res, num_rows);
+	if (first = QR_AddNewRows(res, num_rows), !first)
+	{
+	    mylog("Couldn't add %d rows, dropping the chunk\n", num_rows);
+	    return;
+	}
+    }
 
+    // The nullity array has one array of bytes per row, with a 1 for each
+    // column that's NULL in that row.  The value sent for a NULL is just a
+    // placeholder, so we don't even look at it.
+    flags.rewind();
+    for (int row = 0; data.next(); row++)
+    {
 	WvDBusMsg::Iter cols(data.open());
-	for (int colnum = 0; cols.next() && colnum < numcols(); colnum++)
-	    set_tuplefield_string(&tuple[colnum], *cols);
+	bool have_nulls = flags.next();
+	WvDBusMsg::Iter nulls(have_nulls ? flags.open() : flags);
+
+	if (typed)
+	{
+	    if (QR_AddNewColumnar(res) < 0)
+	    {
+		mylog("Couldn't add a row, dropping the rest of the chunk\n");
+		break;
+	    }
+	    for (int colnum = 0; cols.next() && colnum < numcols(); colnum++)
+	    {
+		if (have_nulls && nulls.next() && nulls.get_int())
+		    CD_set_null(res->coldata, colnum);
+		else
+		    set_coldata(colnum, cols);
+	    }
+	}
+	else
+	{
+	    TupleField *tuple = first + row * QR_NumResultCols(res);
+
+	    for (int colnum = 0; cols.next() && colnum < numcols(); colnum++)
+	    {
+		if (have_nulls && nulls.next() && nulls.get_int())
+		{
+		    set_tuplefield_null(&tuple[colnum]);
+		    continue;
+		}
+		WvString str = cols.get_str();
+		QR_set_tuplefield_string(res, &tuple[colnum], str.cstr(),
+					 str.len());
+	    }
+	}
     }
 }
-    
-void VxResultSet::_runquery(WvDBusConn &conn, const char *func,
-			    const char *query)
+
+void VxResultSet::set_coldata(int col, WvDBusMsg::Iter &i)
 {
-    WvDBusMsg msg("vx.versaplexd", "/db", "vx.db", func);
-    msg.append(query);
-    if (!callbacked_conns[&conn])
+    ColumnDataClass *cd = res->coldata;
+
+    switch (CD_get_kind(cd, col))
+    {
+    case CD_TEXT:
     {
-        conn.add_callback(WvDBusConn::PriNormal, signal_sorter);
-	conn.setclosecallback(wv::bind(&erase_conn, wv::ref(conn)));
-	callbacked_conns[&conn] = true;
+	WvString str = i.get_str();
+	CD_set_blob(cd, col, str.cstr(), str.len());
+	break;
     }
-    process_colinfo = true;
-    while (WvIStreamList::globallist.select(0))
-	WvIStreamList::globallist.callback();
-    WvDBusMsg reply = conn.send_and_wait(msg, 50000,
-    			wv::bind(&update_sigrets, _1, this));
-
+    case CD_BINARY:
+    {
+	std::vector<unsigned char> bytes;
+	for (WvDBusMsg::Iter b(i.open()); b.next(); )
+	    bytes.push_back((unsigned char)b.get_int());
+	CD_set_blob(cd, col, bytes.empty() ? NULL : &bytes[0], bytes.size());
+	break;
+    }
+    case CD_DATETIME:
+    {
+	WvDBusMsg::Iter dt(i.open());
+	SQLBIGINT secs = dt.getnext().get_int();
+	Int4 usecs = dt.getnext().get_int();
+	CD_set_datetime(cd, col, secs, usecs);
+	break;
+    }
+    case CD_DECIMAL:
+    {
+	WvString str = i.get_str();
+	// One too big for a CD_Decimal turns the column into text; if even
+	// that can't be done, NULL is closer to the truth than a zero
+	if (!CD_set_decimal(cd, col, str.cstr()))
+	    CD_set_null(cd, col);
+	break;
+    }
+    case CD_DOUBLE:
+	CD_set_double(cd, col, i.get_double());
+	break;
+    default:
+	CD_set_integer(cd, col, i.get_int());
+	break;
+    }
+}
+    
+void VxResultSet::process_reply(WvDBusMsg &reply)
+{
     if (reply.iserror())
+    {
 	mylog("DBus error: '%s'\n", ((WvString)reply).cstr());
+	error = reply.get_argstr();
+    }
+    else if (scalar_reply)
+    {
+	WvDBusMsg::Iter top(reply);
+	scalar = top.getnext().get_int();
+    }
     else // Method return
 	process_msg(reply);
+    finish();
+}
 
-    uint32_t reply_serial = reply.get_replyserial();
-    if (signal_returns[reply_serial])
-	signal_returns.erase(reply_serial);
+void VxResultSet::finish()
+{
+    if (queries)
+	queries->remove(serial);
+    conn = NULL;
+    queries = NULL;
+    done = true;
+}
+
+// Ask versaplexd to stop working on our query, and forget about anything
+// more it sends us for it.
+void VxResultSet::cancel()
+{
+    if (!done && queries)
+	queries->cancel(serial);
+    finish();
+}
+
+VxResultSet *VxResultSet::detach()
+{
+    VxResultSet *rs = new VxResultSet(*this);
+    if (queries)
+	queries->add(serial, rs);
+    conn = NULL;
+    queries = NULL;
+    done = true;
+    return rs;
+}
+
+void VxResultSet::wait_for_rows(SQLLEN num_rows)
+{
+    while (!done && (num_rows < 0 || (SQLLEN)res->num_cached_rows < num_rows))
+    {
+	if (!conn->isok())
+	{
+	    mylog("DBus connection died with rows still outstanding\n");
+	    error = "The connection to versaplexd died";
+	    finish();
+	    break;
+	}
+	queries->runonce(1000);
+    }
+}
+    
+// Returns true once the first rows (or the end of the result) are in,
+// without waiting for them.
+bool VxResultSet::poll()
+{
+    if (!done && res->num_cached_rows < 1)
+    {
+	if (!conn->isok())
+	{
+	    mylog("DBus connection died before any rows arrived\n");
+	    finish();
+	}
+	else
+	    queries->runonce(0);
+    }
+    return done || res->num_cached_rows >= 1;
+}
+
+void VxResultSet::_sendquery(WvDBusConn &conn, VxQueryTable &queries,
+			     const char *func, const char *query)
+{
+    WvDBusMsg msg("vx.versaplexd", "/db", "vx.db", func);
+    msg.append(query);
+    _sendmsg(conn, queries, msg);
+}
+
+void VxResultSet::_sendmsg(WvDBusConn &conn, VxQueryTable &queries,
+			   WvDBusMsg &msg, bool _scalar_reply)
+{
+    queries.attach(conn);
+    finish();
+    process_colinfo = true;
+    scalar_reply = _scalar_reply;
+    scalar = 0;
+    error = WvString::null;
+    queries.flush();
+
+    // Nobody else can run the streams, and so get the answer, until
+    // it's in the table and we're waiting for it
+    queries.lock();
+    conn.send(msg, wv::bind(&VxQueryTable::reply_sorter, &queries, _1),
+	      50000);
+    this->conn = &conn;
+    this->queries = &queries;
+    serial = msg.get_serial();
+    done = false;
+    queries.add(serial, this);
+    queries.unlock();
+}
+
+void VxStatement::reconnect()
+{
+    ConnectionClass *conn = SC_get_conn(stmt);
+    ConnInfo *ci = &conn->connInfo;
+    mylog("DBus connection died!  Reconnecting to %s\n",
+	  ci->dbus_moniker);
+    conn->dbus = new WvDBusConn(ci->dbus_moniker);
 }
 
+// Wait for rs's answer, where SQLCancel on another thread (which can't
+// get at the statement while we're using it) can find the call to cancel.
+void VxStatement::wait(VxResultSet &rs, SQLLEN num_rows)
+{
+    CSTR func = "VxStatement::wait";
+    ConnectionClass *conn = SC_get_conn(stmt);
+    BOOL cancelled;
+
+    CONNLOCK_ACQUIRE(conn);
+    stmt->running_serial = rs.get_serial();
+    cancelled = stmt->cancelled;
+    CONNLOCK_RELEASE(conn);
+
+    // A cancel that came in while the query was being sent had nothing
+    // to aim at yet
+    if (!cancelled)
+	rs.wait_for_rows(num_rows);
+
+    CONNLOCK_ACQUIRE(conn);
+    stmt->running_serial = 0;
+    cancelled = stmt->cancelled;
+    stmt->cancelled = FALSE;
+    CONNLOCK_RELEASE(conn);
+
+    if (cancelled)
+    {
+	rs.cancel();
+	SC_set_error(stmt, STMT_OPERATION_CANCELLED, "Operation cancelled",
+		     func);
+	seterr();
+    }
+}
+
+// If 'stream' is set, returns as soon as the first chunk of rows is in;
+// the rest can be pulled in later with wait_for_rows().
 void VxStatement::runquery(VxResultSet &rs,
-			   const char *func, const char *query)
+			   const char *func, const char *query, bool stream)
 {
     if (dbus().isok())
-	rs._runquery(dbus(), func, query);
+    {
+	rs._sendquery(dbus(), queries(), func, query);
+	wait(rs, stream ? 1 : -1);
+    }
+    if (!dbus().isok())
+    {
+	reconnect();
+	rs._sendquery(dbus(), queries(), func, query);
+	wait(rs, stream ? 1 : -1);
+    }
+}
+
+void VxStatement::sendquery(VxResultSet &rs,
+			    const char *func, const char *query)
+{
     if (!dbus().isok())
+	reconnect();
+    rs._sendquery(dbus(), queries(), func, query);
+}
+
+// Send a call that answers with a single number, which ends up in
+// rs.scalar, without waiting for it.
+void VxStatement::sendscalar(VxResultSet &rs, WvDBusMsg &msg)
+{
+    if (!dbus().isok())
+	reconnect();
+    rs._sendmsg(dbus(), queries(), msg, true);
+}
+
+// Like sendscalar(), but waits for the answer.  msg gets its serial when
+// it's sent, so it can't just be tried again on a new connection the way
+// a query can.
+void VxStatement::runscalar(VxResultSet &rs, WvDBusMsg &msg)
+{
+    sendscalar(rs, msg);
+    wait(rs, -1);
+}
+
+// Like runquery(), for catalog queries whose answers hardly ever change:
+// if the connection asked the same thing recently, the rows come from its
+// catalog cache instead of versaplexd.
+void VxStatement::runcatalog(VxResultSet &rs, const char *query)
+{
+    ConnectionClass *conn = SC_get_conn(stmt);
+    CatalogEntry *ce = CC_get_catalog(conn, query);
+
+    if (ce)
+    {
+	mylog("Catalog result for '%s' came from the cache\n", query);
+	rs.load_catalog(ce);
+	CC_release_catalog(conn, ce);
+	return;
+    }
+    runquery(rs, "ExecChunkRecordset", query);
+    if (!rs.error && rs.isdone() && CC_catalog_ttl(conn) > 0)
+    {
+	if ((ce = CE_Constructor(query, rs.res)) != NULL)
+	    CC_put_catalog(conn, ce);
+    }
+}
+
+// With the PrefetchColumns option, the first SQLColumns asks for every
+// table's columns at once, and files them in the catalog cache under the
+// "LIST COLUMNS [t]" each table would have asked for on its own.  Tables
+// that aren't in the answer just get asked about the usual way.
+void VxStatement::prefetch_columns()
+{
+    ConnectionClass *conn = SC_get_conn(stmt);
+
+    if (!CC_start_prefetch(conn))
+	return;
+
+    VxResultSet rs;
+    runquery(rs, "ExecChunkRecordset", "exec sp_columns @table_name = N'%'");
+    if (rs.error || !rs.isdone())
+    {
+	mylog("Couldn't prefetch columns: %s\n",
+	      rs.error ? rs.error.cstr() : "the answer didn't all come");
+	CC_end_prefetch(conn, NULL, 0, TRUE);
+	return;
+    }
+
+    QResultClass *res = rs.res;
+    int num_fields = QR_NumResultCols(res), namecol;
+    for (namecol = 0; namecol < num_fields; namecol++)
+    {
+	const char *name = QR_get_fieldname(res, namecol);
+	if (name && !stricmp(name, "TABLE_NAME"))
+	    break;
+    }
+    if (namecol >= num_fields || res->coldata)
+    {
+	// Catalog entries only hold text, by TABLE_NAME
+	mylog("Can't file prefetched columns that %s\n",
+	      res->coldata ? "came typed" : "have no TABLE_NAME");
+	CC_end_prefetch(conn, NULL, 0, FALSE);
+	return;
+    }
+
+    // Each table's rows, in the order they came (by ORDINAL_POSITION)
+    std::map<std::string, std::vector<SQLLEN> > tables;
+    SQLLEN num_rows = QR_get_num_cached_tuples(res);
+    for (SQLLEN row = 0; row < num_rows; row++)
+    {
+	const char *name = QR_get_value_backend_text(res, row, namecol);
+	if (name)
+	    tables[name].push_back(row);
+    }
+
+    std::vector<CatalogEntry *> ces;
+    std::map<std::string, std::vector<SQLLEN> >::iterator it;
+    for (it = tables.begin(); it != tables.end(); ++it)
+    {
+	WvString query("LIST COLUMNS [%s]", it->first.c_str());
+	CatalogEntry *ce = CE_Constructor_rows(query, res, &it->second[0],
+					       it->second.size());
+	if (ce)
+	    ces.push_back(ce);
+    }
+    mylog("Prefetched the columns of %d tables\n", (int)ces.size());
+    CC_end_prefetch(conn, ces.empty() ? NULL : &ces[0], (int)ces.size(),
+		    TRUE);
+}
+
+
+void SC_abandon_async(StatementClass *stmt)
+{
+    VxResultSet *rs = stmt->pending;
+    QResultClass *res;
+
+    if (!rs)
+	return;
+    mylog("Abandoning an asynchronous query\n");
+    stmt->pending = NULL;
+    res = rs->res;
+    rs->cancel();
+    delete rs;
+    QR_Destructor(res);
+}
+
+
+// SQLCancel for a statement another thread is running, and so has locked:
+// tell versaplexd to give up on whatever that thread is waiting for, so
+// it gets its "operation cancelled" straight away.  If it isn't waiting
+// for anything yet, it finds out as soon as it is.
+BOOL SC_cancel_running(StatementClass *stmt)
+{
+    ConnectionClass *conn = SC_get_conn(stmt);
+    VxQueryTable *queries;
+    uint32_t serial;
+
+    CONNLOCK_ACQUIRE(conn);
+    stmt->cancelled = TRUE;
+    serial = stmt->running_serial;
+    queries = conn->queries;
+    CONNLOCK_RELEASE(conn);
+
+    if (!serial || !queries)
+	return FALSE;
+    queries->cancel(serial);
+    return TRUE;
+}
+
+
+void QR_fetch_more(QResultClass *self, SQLLEN num_rows)
+{
+    VxResultSet *rs = self->stream;
+
+    if (!rs)
+	return;
+    rs->wait_for_rows(num_rows);
+    if (rs->isdone())
     {
-	ConnectionClass *conn = SC_get_conn(stmt);
-	ConnInfo *ci = &conn->connInfo;
-	mylog("DBus connection died!  Reconnecting to %s\n",
-	      ci->dbus_moniker);
-	conn->dbus = new WvDBusConn(ci->dbus_moniker);
-	rs._runquery(dbus(), func, query);
+	mylog("All %d rows are in\n", self->num_cached_rows);
+	self->stream = NULL;
+	delete rs;
     }
 }
 
+
+void QR_close_stream(QResultClass *self)
+{
+    VxResultSet *rs = self->stream;
+
+    if (!rs)
+	return;
+    if (!rs->isdone())
+	mylog("Dropping the rest of a streamed result\n");
+    self->stream = NULL;
+    rs->cancel();
+    delete rs;
+}
+
 void VxResultSet::return_versaplex_db()
 {
     // Allocate space for the column info data... see below.
@@ -147,3 +825,36 @@ void VxResultSet::return_versaplex_db()
     //for (int i = 1; i < my_cols; ++i)
     //	set_tuplefield_string(&tuple[i], NULL);
 }
+
+// Fill in the result from a copy kept in the connection's catalog cache,
+// just as if versaplexd had sent it again.
+void VxResultSet::load_catalog(const CatalogEntry *ce)
+{
+    int num_fields = CE_get_num_fields(ce);
+    SQLLEN num_rows = CE_get_num_rows(ce);
+
+    QR_set_num_fields(res, num_fields);
+    maxcol = num_fields - 1;
+    for (int col = 0; col < num_fields; col++)
+	set_field_info(col, ce->fields[col].name, ce->fields[col].type,
+		       ce->fields[col].size);
+    process_colinfo = false;
+
+    if (num_rows <= 0)
+	return;
+    QR_reserve_arena(res, num_rows);
+    TupleField *tuple = QR_AddNewRows(res, num_rows);
+    if (!tuple)
+    {
+	mylog("Couldn't add %d cached catalog rows\n", (int)num_rows);
+	return;
+    }
+    for (SQLLEN row = 0; row < num_rows; row++)
+    {
+	for (int col = 0; col < num_fields; col++, tuple++)
+	{
+	    const char *val = CE_get_value(ce, row, col);
+	    QR_set_tuplefield_string(res, tuple, val, val ? strlen(val) : 0);
+	}
+    }
+}
@@ -4,7 +4,112 @@
 #include "statement.h"
 #include "qresult.h"
 #include <wvdbusconn.h>
+#include <wvistreamlist.h>
+#include <wvloopback.h>
 #include "pgtypes.h"
+#include <vector>
+
+class VxResultSet;
+
+// VxQueryTable's locks, which are made the same way as the connection's
+#if defined(WIN_MULTITHREAD_SUPPORT)
+typedef CRITICAL_SECTION VxLock;
+#define VXLOCK_INIT(x)		InitializeCriticalSection(&(x))
+#define VXLOCK_ACQUIRE(x)	EnterCriticalSection(&(x))
+#define VXLOCK_TRYACQUIRE(x)	(0 != TryEnterCriticalSection(&(x)))
+#define VXLOCK_RELEASE(x)	LeaveCriticalSection(&(x))
+#define VXLOCK_DELETE(x)	DeleteCriticalSection(&(x))
+#elif defined(POSIX_THREADMUTEX_SUPPORT)
+typedef pthread_mutex_t VxLock;
+#define VXLOCK_INIT(x)		pthread_mutex_init(&(x), NULL)
+#define VXLOCK_ACQUIRE(x)	pthread_mutex_lock(&(x))
+#define VXLOCK_TRYACQUIRE(x)	(0 == pthread_mutex_trylock(&(x)))
+#define VXLOCK_RELEASE(x)	pthread_mutex_unlock(&(x))
+#define VXLOCK_DELETE(x)	pthread_mutex_destroy(&(x))
+#else
+typedef int VxLock;
+#define VXLOCK_INIT(x)
+#define VXLOCK_ACQUIRE(x)
+#define VXLOCK_TRYACQUIRE(x)	TRUE
+#define VXLOCK_RELEASE(x)
+#define VXLOCK_DELETE(x)
+#endif /* WIN_MULTITHREAD_SUPPORT */
+
+// The ExecChunkRecordset calls a connection has outstanding, by serial,
+// so that their ChunkRecordsetSig signals and method returns can be
+// handed to the right VxResultSet.  Each ConnectionClass has its own, along
+// with its own list of streams to run, so that threads using different
+// connections never touch each other's streams (or the global list).
+class VxQueryTable
+{
+    // Every chunk that arrives is looked up here by its call's serial.
+    // A connection's serials count up, so the ones in flight at once
+    // mostly land in slots of their own at serial & (size - 1); the few
+    // that don't just go in the next free slot.
+    struct Slot
+    {
+	uint32_t serial;
+	VxResultSet *rs;	/* NULL if the slot is free */
+    };
+    std::vector<Slot> entries;
+    unsigned num_entries;
+    WvDBusConn *dbus;
+    ConnectionClass *owner;
+    WvIStreamList streams;
+
+    // streams_lock is held while anything runs or sends on streams, but
+    // never while waiting for something to arrive; entries_lock only
+    // while entries is looked at, which the callbacks run under
+    // streams_lock do too.  Never take them the other way round.
+    VxLock streams_lock;
+    VxLock entries_lock;
+
+    // The threads in wait(), and the bytes written to wake that they
+    // haven't read yet.  Whoever handles what arrived wakes the others,
+    // since it may have been what they were waiting for.
+    VxLock wake_lock;
+    int num_waiting;
+    int pending_wakes;
+    WvLoopback wake;
+
+    // Serials to send CancelQuery for, which cancel() leaves to whoever
+    // has the streams rather than wait for them
+    VxLock cancels_lock;
+    std::vector<uint32_t> cancels;
+
+public:
+    VxQueryTable(ConnectionClass *_owner);
+    ~VxQueryTable();
+
+    void attach(WvDBusConn &conn);
+    void runonce(int msec_timeout);
+    void flush();
+    void lock()
+    {
+	VXLOCK_ACQUIRE(streams_lock);
+    }
+    void unlock()
+    {
+	release_streams();
+    }
+    void add(uint32_t serial, VxResultSet *rs);
+    void remove(uint32_t serial);
+    void cancel(uint32_t serial);
+    VxResultSet *find(uint32_t serial);
+
+private:
+    void release_streams();
+    void send_cancels();
+    bool run_ready(int *fd);
+    void wait(int fd, int msec_timeout);
+    void wake_waiters();
+    int slot_of(uint32_t serial) const;
+    void grow();
+
+public:
+    bool signal_sorter(WvDBusMsg &msg);
+    bool reply_sorter(WvDBusMsg &msg);
+};
 
 
 class VxResultSet
@@ -15,6 +120,22 @@ class VxResultSet
     //message is important or not.
     bool process_colinfo;
 
+    // Keep the rows in res->coldata, in their native types, rather than
+    // as strings in backend_tuples.
+    bool typed;
+
+    // While an ExecChunkRecordset call is outstanding, the connection and
+    // serial its ChunkRecordsetSig signals and method return will carry,
+    // and the connection's table that routes them to us.
+    WvDBusConn *conn;
+    VxQueryTable *queries;
+    uint32_t serial;
+    bool done;
+
+    // Set for calls (like BulkInsert) that answer with a single number
+    // instead of a recordset.
+    bool scalar_reply;
+
     int vxtype_to_pgtype(WvStringParm vxtype)
     {
 	if (vxtype == "String")
@@ -43,14 +164,25 @@ class VxResultSet
 
 public:
     QResultClass *res;
+    SQLBIGINT scalar;
+    WvString error;	// what versaplexd said, if it answered with an error
     
-    VxResultSet() : process_colinfo(true)
+    VxResultSet(bool _typed = false)
+	: process_colinfo(true), typed(_typed),
+	  conn(NULL), queries(NULL), serial(0), done(true),
+	  scalar_reply(false), scalar(0)
     {
 	res = QR_Constructor();
 	maxcol = -1;
 	assert(res);
 	assert(*this == res);
     }
+
+    ~VxResultSet()
+    {
+	// Don't leave anyone routing chunks to us after we're gone
+	finish();
+    }
     
     void set_field_info(int col, const char *colname, OID type, int typesize)
     {
@@ -76,9 +208,32 @@ public:
 	return maxcol+1;
     }
 
-    void _runquery(WvDBusConn &conn, const char *func, const char *query);
+    bool isdone() const
+    {
+	return done;
+    }
+
+    // The serial of the call still outstanding, or 0 if there isn't one
+    uint32_t get_serial() const
+    {
+	return done ? 0 : serial;
+    }
+
+    // Just sends the query; poll() or wait_for_rows() for the answer.
+    void _sendquery(WvDBusConn &conn, VxQueryTable &queries,
+		    const char *func, const char *query);
+    void _sendmsg(WvDBusConn &conn, VxQueryTable &queries, WvDBusMsg &msg,
+		  bool _scalar_reply = false);
+    bool poll();
+    void wait_for_rows(SQLLEN num_rows);
+    VxResultSet *detach();
+    void cancel();
+    void finish();
     void return_versaplex_db();
+    void load_catalog(const CatalogEntry *ce);
     void process_msg(WvDBusMsg &msg);
+    void set_coldata(int col, WvDBusMsg::Iter &i);
+    void process_reply(WvDBusMsg &reply);
 };
 
 
@@ -113,11 +268,19 @@ public:
     void reinit()
     {
 	ret = SC_initialize_and_recycle(stmt);
+	CONNLOCK_ACQUIRE(SC_get_conn(stmt));
+	stmt->cancelled = FALSE;
+	CONNLOCK_RELEASE(SC_get_conn(stmt));
     }
     
     void set_result(VxResultSet &rs)
     {
 	SC_set_Result(stmt, rs);
+
+	// Any rows still on their way belong to the result from now on;
+	// SQLFetch will ask for them as it needs them.
+	if (!rs.isdone())
+	    rs.res->stream = rs.detach();
 	
 	/* the binding structure for a statement is not set up until
 	 * a statement is actually executed, so we'll have to do this
@@ -152,8 +315,26 @@ public:
 	assert(conn->dbus);
 	return *conn->dbus;
     }
+
+    VxQueryTable &queries()
+    {
+	ConnectionClass *conn = SC_get_conn(stmt);
+	CONNLOCK_ACQUIRE(conn);
+	if (!conn->queries)
+	    conn->queries = new VxQueryTable(conn);
+	CONNLOCK_RELEASE(conn);
+	return *conn->queries;
+    }
     
-    void runquery(VxResultSet &rs, const char *func, const char *query);
+    void reconnect();
+    void wait(VxResultSet &rs, SQLLEN num_rows);
+    void runquery(VxResultSet &rs, const char *func, const char *query,
+		  bool stream = false);
+    void sendquery(VxResultSet &rs, const char *func, const char *query);
+    void sendscalar(VxResultSet &rs, WvDBusMsg &msg);
+    void runscalar(VxResultSet &rs, WvDBusMsg &msg);
+    void runcatalog(VxResultSet &rs, const char *query);
+    void prefetch_columns();
 };
 
 #endif // __VXHELPERS_H
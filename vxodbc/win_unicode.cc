@@ -18,6 +18,16 @@
 #endif				/* WIN32 */
 #include <string.h>
 
+/*
+ * SSE2 is always there on x86-64 (and asked for on 32-bit MSVC with
+ * /arch:SSE2); anywhere else the ASCII runs are found a byte at a time.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define	USE_SSE2
+#include <emmintrin.h>
+#endif				/* __SSE2__ */
+
 #define	byte3check	0xfffff800
 #define	byte2_base	0x80c0
 #define	byte2_mask1	0x07c0
@@ -47,8 +57,74 @@ SQLULEN ucs2strlen(const SQLWCHAR * ucs2str)
 	;
     return len;
 }
-char *ucs2_to_utf8(const SQLWCHAR * ucs2str, SQLLEN ilen, SQLLEN * olen,
-		   BOOL lower_identifier)
+/*
+ *	How many of the n characters at wstr are plain ASCII, and can be
+ *	copied one byte each (lowercased if lower_identifier) into utf8str.
+ *	Stops at a NUL, like the caller does.
+ */
+static SQLLEN ucs2_ascii_run(const SQLWCHAR * wstr, SQLLEN n,
+			     char *utf8str, BOOL lower_identifier)
+{
+    SQLLEN i = 0;
+
+#ifdef USE_SSE2
+    if (sizeof(SQLWCHAR) == 2)
+    {
+	const __m128i nonascii = _mm_set1_epi16((short) 0xff80);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i before_A = _mm_set1_epi8('A' - 1);
+	const __m128i after_Z = _mm_set1_epi8('Z' + 1);
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+
+	for (; i + 16 <= n; i += 16)
+	{
+	    __m128i lo =
+		_mm_loadu_si128((const __m128i *) (wstr + i));
+	    __m128i hi =
+		_mm_loadu_si128((const __m128i *) (wstr + i + 8));
+	    __m128i bytes;
+
+	    /* Both halves below 0x80 and without a NUL in them */
+	    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128
+						  (_mm_or_si128(lo, hi),
+						   nonascii), zero)) != 0xffff)
+		break;
+	    bytes = _mm_packus_epi16(lo, hi);
+	    if (_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, zero)))
+		break;
+	    if (lower_identifier)
+		bytes = _mm_or_si128(bytes,
+				     _mm_and_si128(_mm_and_si128
+						   (_mm_cmpgt_epi8
+						    (bytes, before_A),
+						    _mm_cmplt_epi8(bytes,
+								   after_Z)),
+						   case_bit));
+	    _mm_storeu_si128((__m128i *) (utf8str + i), bytes);
+	}
+    }
+#endif				/* USE_SSE2 */
+    for (; i < n; i++)
+    {
+	if (!wstr[i] || 0 != (wstr[i] & 0xffffff80))
+	    break;
+	if (lower_identifier)
+	    utf8str[i] = (char) tolower(wstr[i]);
+	else
+	    utf8str[i] = (char) wstr[i];
+    }
+    return i;
+}
+
+/*
+ *	Convert to UTF-8 in buf if it's big enough for the worst case
+ *	(3 bytes a character, and the NUL), or a malloc()ed string if
+ *	not.  Either way the result is what's returned; free() it unless
+ *	it's buf.
+ */
+char *ucs2_to_utf8_buf(const SQLWCHAR * ucs2str, SQLLEN ilen,
+		       SQLLEN * olen, BOOL lower_identifier, char *buf,
+		       SQLLEN bufsize)
 {
     char *utf8str;
 /*mylog("ucs2_to_utf8 %p ilen=%d ", ucs2str, ilen);*/
@@ -61,10 +137,13 @@ char *ucs2_to_utf8(const SQLWCHAR * ucs2str, SQLLEN ilen, SQLLEN * olen,
     if (SQL_NTS == ilen)
 	ilen = ucs2strlen(ucs2str);
 /*mylog(" newlen=%d", ilen);*/
-    utf8str = (char *) malloc(ilen * 3 + 1);
+    if (buf && ilen * 3 + 1 <= bufsize)
+	utf8str = buf;
+    else
+	utf8str = (char *) malloc(ilen * 3 + 1);
     if (utf8str)
     {
-	int i, len = 0;
+	SQLLEN i, len = 0, run;
 	UInt2 byte2code;
 	Int4 byte4code;
 	const SQLWCHAR *wstr;
@@ -75,10 +154,11 @@ char *ucs2_to_utf8(const SQLWCHAR * ucs2str, SQLLEN ilen, SQLLEN * olen,
 		break;
 	    else if (0 == (*wstr & 0xffffff80))	/* ASCII */
 	    {
-		if (lower_identifier)
-		    utf8str[len++] = (char) tolower(*wstr);
-		else
-		    utf8str[len++] = (char) *wstr;
+		run = ucs2_ascii_run(wstr, ilen - i, utf8str + len,
+				     lower_identifier);
+		len += run;
+		i += run - 1;
+		wstr += run - 1;
 	    } else if ((*wstr & byte3check) == 0)
 	    {
 		byte2code = byte2_base |
@@ -105,6 +185,73 @@ char *ucs2_to_utf8(const SQLWCHAR * ucs2str, SQLLEN ilen, SQLLEN * olen,
     return utf8str;
 }
 
+char *ucs2_to_utf8(const SQLWCHAR * ucs2str, SQLLEN ilen, SQLLEN * olen,
+		   BOOL lower_identifier)
+{
+    return ucs2_to_utf8_buf(ucs2str, ilen, olen, lower_identifier, NULL,
+			    0);
+}
+
+/*
+ *	How many of the n bytes at str are ASCII that goes across as is:
+ *	not a NUL, and not a LF either if those are getting CRs put in.
+ */
+static SQLLEN utf8_ascii_run(const UCHAR * str, SQLLEN n, BOOL lfconv)
+{
+    SQLLEN i = 0;
+
+#ifdef USE_SSE2
+    {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lf = _mm_set1_epi8(lfconv ? PG_LINEFEED : 0);
+
+	for (; i + 16 <= n; i += 16)
+	{
+	    __m128i bytes = _mm_loadu_si128((const __m128i *) (str + i));
+
+	    if (_mm_movemask_epi8(_mm_or_si128(bytes,
+					       _mm_or_si128(_mm_cmpeq_epi8
+							    (bytes, zero),
+							    _mm_cmpeq_epi8
+							    (bytes, lf)))))
+		break;
+	}
+    }
+#endif				/* USE_SSE2 */
+    for (; i < n; i++)
+    {
+	if (!str[i] || !isascii(str[i])
+	    || (lfconv && PG_LINEFEED == str[i]))
+	    break;
+    }
+    return i;
+}
+
+/*	Widen n ASCII bytes at str into ucs2str */
+static void ascii_to_ucs2(const UCHAR * str, SQLLEN n, SQLWCHAR * ucs2str)
+{
+    SQLLEN i = 0;
+
+#ifdef USE_SSE2
+    if (sizeof(SQLWCHAR) == 2)
+    {
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; i + 16 <= n; i += 16)
+	{
+	    __m128i bytes = _mm_loadu_si128((const __m128i *) (str + i));
+
+	    _mm_storeu_si128((__m128i *) (ucs2str + i),
+			     _mm_unpacklo_epi8(bytes, zero));
+	    _mm_storeu_si128((__m128i *) (ucs2str + i + 8),
+			     _mm_unpackhi_epi8(bytes, zero));
+	}
+    }
+#endif				/* USE_SSE2 */
+    for (; i < n; i++)
+	ucs2str[i] = str[i];
+}
+
 #define	byte3_m1	0x0f
 #define	byte3_m2	0x3f
 #define	byte3_m3	0x3f
@@ -113,7 +260,7 @@ char *ucs2_to_utf8(const SQLWCHAR * ucs2str, SQLLEN ilen, SQLLEN * olen,
 SQLULEN utf8_to_ucs2_lf(const char *utf8str, SQLLEN ilen, BOOL lfconv,
 			SQLWCHAR * ucs2str, SQLULEN bufcount)
 {
-    int i;
+    SQLLEN i;
     SQLULEN ocount, wcode;
     const UCHAR *str;
 
@@ -132,6 +279,19 @@ SQLULEN utf8_to_ucs2_lf(const char *utf8str, SQLLEN ilen, BOOL lfconv,
 	/* if (iswascii(*str)) */
 	if (isascii(*str))
 	{
+	    SQLLEN run = utf8_ascii_run(str, ilen - i, lfconv);
+
+	    if (run > 0)
+	    {
+		if (ocount < bufcount)
+		    ascii_to_ucs2(str, ocount + run <= bufcount ?
+				  run : (SQLLEN) (bufcount - ocount),
+				  ucs2str + ocount);
+		ocount += run;
+		i += run;
+		str += run;
+		continue;
+	    }
 	    if (lfconv && PG_LINEFEED == *str &&
 		(i == 0 || PG_CARRIAGE_RETURN != str[-1]))
 	    {
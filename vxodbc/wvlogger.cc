@@ -11,9 +11,16 @@
 
 static WvLog *wvlog = NULL;
 static WvLogRcv *rcv = NULL;
+// The log's own streams, so that logging doesn't have to run (and fight
+// other threads' connections over) WvIStreamList::globallist.
+static WvIStreamList logstreams;
+static IWvStream *logstream = NULL;
 
 int log_level = 0;
 static WvString log_moniker;
+// How many of the Debug levels the log lets through; 0 means debug output
+// is thrown away, so there's no point producing it.
+static int debug_level = 0;
 
 WV_LINK_TO(WvConStream);
 WV_LINK_TO(WvTCPConn);
@@ -67,7 +74,10 @@ void wvlog_open()
 
 	IWvStream *s = wvcreate<IWvStream>(log_moniker);
 	assert(s);
+	logstreams.append(s, false, "vxodbc log");
+	logstream = s;
 	rcv = new WvLogStream(s, pri);
+	debug_level = (pri >= WvLog::Debug1) ? pri - WvLog::Debug1 + 1 : 0;
     	if (!wvlog)
 	    wvlog = new WvLog(getpid(), WvLog::Debug);
 
@@ -79,12 +89,18 @@ void wvlog_open()
 }
 
 
+int wvlog_debug_level()
+{
+    return wvlog ? debug_level : 0;
+}
+
+
 void wvlog_print(const char *file, int line, const char *s)
 {
     if (!wvlog)
 	return;
-    while (WvIStreamList::globallist.select(0))
-	WvIStreamList::globallist.callback();
+    while (logstreams.select(0, true, false))
+	logstreams.callback();
     WvString ss("%s:%s: %s", file, line, s);
     wvlog->print(ss);
 }
@@ -94,7 +110,10 @@ void wvlog_close()
 {
     if (wvlog) (*wvlog)(WvLog::Info, "Log closing.\n");
     if (wvlog) delete wvlog;
+    if (logstream) logstreams.unlink(logstream);
+    logstream = NULL;
     if (rcv) delete rcv;
     wvlog = NULL;
     rcv = NULL;
+    debug_level = 0;
 }
@@ -17,6 +17,7 @@ struct pstring
 struct pstring wvlog_get_moniker();
 int wvlog_isset();
 void wvlog_open();
+int wvlog_debug_level();
 void wvlog_print(const char *file, int line, const char *s);
 void wvlog_close();
     
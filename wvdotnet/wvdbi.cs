@@ -99,6 +99,14 @@ namespace Wv
 	
 	public abstract WvSqlRows select(string sql, params object[] args);
 	public abstract int execute(string sql, params object[] args);
+	
+	// Insert all of 'rows' into 'table', matching columns by name.
+	// Only databases with a real bulk copy interface support this.
+	public virtual int bulk_insert(string table, DataTable rows)
+	{
+	    throw new NotSupportedException(
+		wv.fmt("{0} can't bulk insert", GetType().Name));
+	}
 	    	
 	public WvSqlRow select_onerow(string sql, params object[] args)
 	{
@@ -377,6 +385,18 @@ namespace Wv
 	    
 	    return cmd;
 	}
+	
+	public override int bulk_insert(string table, DataTable rows)
+	{
+	    using (var bulk = new SqlBulkCopy((SqlConnection)db))
+	    {
+		bulk.DestinationTableName = table;
+		foreach (DataColumn c in rows.Columns)
+		    bulk.ColumnMappings.Add(c.ColumnName, c.ColumnName);
+		bulk.WriteToServer(rows);
+	    }
+	    return rows.Rows.Count;
+	}
     }
 }
 